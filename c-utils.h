@@ -14,11 +14,37 @@ extern "C" {
 #include "utils-configs.h"
 
 #ifdef USE_COMMON
-#include "common/inc/common.h" /* 引用通用功能模块 */
+#include "common/inc/arena.h"        /* 引用区域分配器模块 */
+#include "common/inc/common.h"       /* 引用通用功能模块 */
+#include "common/inc/cpu_features.h" /* 引用 CPU 特性检测模块 */
+#include "common/inc/fast_hash.h"    /* 引用非加密哈希模块 */
+#include "common/inc/mem_pages.h"    /* 引用页内存及 NUMA 绑定模块 */
+#include "common/inc/mem_stats.h"    /* 引用内存分配统计模块 */
+#include "common/inc/metrics.h"      /* 引用指标统计模块 */
+#include "common/inc/obj_pool.h"     /* 引用对象池模块 */
+#include "common/inc/tc_alloc.h"     /* 引用线程缓存分配器模块 */
 #endif
 
 #ifdef USE_LIST
-#include "list/inc/list.h" /* 引用链表数据结构模块 */
+#include "list/inc/ilist.h"      /* 引用侵入式链表模块 */
+#include "list/inc/list.h"       /* 引用链表数据结构模块 */
+#include "list/inc/mpsc_queue.h" /* 引用无锁多生产者单消费者队列模块 */
+#endif
+
+#ifdef USE_UNROLLED_LIST
+#include "unrolled_list/inc/unrolled_list.h" /* 引用展开链表模块 */
+#endif
+
+#ifdef USE_HASH_MAP
+#include "hash_map/inc/hash_map.h" /* 引用哈希表模块 */
+#endif
+
+#ifdef USE_RING_BUFFER
+#include "ring_buffer/inc/ring_buffer.h" /* 引用环形缓冲区模块 */
+#endif
+
+#ifdef USE_IOBUF
+#include "iobuf/inc/iobuf.h" /* 引用链式字节缓冲区模块 */
 #endif
 
 #ifdef USE_LOG_MSG
@@ -37,6 +63,10 @@ extern "C" {
 #include "process/inc/process_operations.h" /* 引用进程管理者模块 */
 #endif
 
+#ifdef USE_THREAD_POOL
+#include "thread_pool/inc/thread_pool.h" /* 引用线程池模块 */
+#endif
+
 #ifdef USE_SOCKET
 #include "socket/inc/socket_operator.h" /* 引用进程管理者模块 */
 #endif
@@ -0,0 +1,131 @@
+/**
+ * @file arena.h
+ * @brief 区域（arena）分配器头文件，按请求生命周期批量申请并一次释放内存
+ * @author moecly
+ */
+
+#ifndef __ARENA_H_
+#define __ARENA_H_
+
+#include "common.h"
+#include <stddef.h>
+
+#ifndef ARENA_DEFAULT_CHUNK_SIZE
+#define ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+#endif // !ARENA_DEFAULT_CHUNK_SIZE
+
+#ifndef ARENA_DEFAULT_ALIGN
+#define ARENA_DEFAULT_ALIGN 16
+#endif // !ARENA_DEFAULT_ALIGN
+
+/**
+ * @brief arena 内存块结构，按申请顺序串联
+ */
+typedef struct arena_chunk {
+  struct arena_chunk *next; /* 下一个内存块 */
+  size_t size;              /* 数据区大小 */
+  size_t used;              /* 数据区已使用的字节数 */
+  char data[];              /* 数据区 */
+} arena_chunk;
+
+/**
+ * @brief arena 分配器结构
+ *
+ * cur 之前（含 cur）的内存块正在使用，cur 之后的内存块为重置或回滚后保留的
+ * 空闲内存块，后续申请时按顺序复用。
+ */
+typedef struct {
+  arena_chunk *first;       /* 第一个内存块 */
+  arena_chunk *cur;         /* 当前切分的内存块 */
+  void *last;               /* 最近一次申请的内存，用于原地扩容 */
+  size_t chunk_size;        /* 新内存块的默认数据区大小 */
+  mem_allocator *backing;   /* 申请内存块的底层分配器 */
+  mem_allocator allocator;  /* 以 arena 为上下文的分配器接口 */
+} arena;
+
+/**
+ * @brief arena 保存点，用于回滚到保存时的状态
+ */
+typedef struct {
+  arena_chunk *chunk; /* 保存时的当前内存块 */
+  size_t used;        /* 保存时当前内存块已使用的字节数 */
+} arena_savepoint;
+
+/**
+ * @brief 初始化 arena 分配器，首次申请内存时才申请内存块
+ * @param a arena 指针
+ * @param chunk_size 内存块数据区大小，为 0 时使用 ARENA_DEFAULT_CHUNK_SIZE
+ * @param backing 底层分配器，为 NULL 时使用默认分配器
+ */
+void arena_init(arena *a, size_t chunk_size, mem_allocator *backing);
+
+/**
+ * @brief 释放 arena 的全部内存块
+ * @param a arena 指针
+ */
+void arena_destroy(arena *a);
+
+/**
+ * @brief 从 arena 申请内存，按 ARENA_DEFAULT_ALIGN 对齐
+ * @param a arena 指针
+ * @param size 字节数
+ * @return 返回内存指针，失败返回 NULL
+ */
+void *arena_alloc(arena *a, size_t size);
+
+/**
+ * @brief 从 arena 按对齐要求申请内存
+ * @param a arena 指针
+ * @param align 对齐字节数，需为 2 的幂
+ * @param size 字节数
+ * @return 返回内存指针，失败返回 NULL
+ */
+void *arena_aligned_alloc(arena *a, size_t align, size_t size);
+
+/**
+ * @brief 调整 arena 中内存的大小，最近一次申请的内存在空间足够时原地扩展
+ * @param a arena 指针
+ * @param ptr 原内存指针，可为 NULL
+ * @param size 新的字节数
+ * @return 返回新的内存指针，失败返回 NULL 且原内存不变
+ */
+void *arena_realloc(arena *a, void *ptr, size_t size);
+
+/**
+ * @brief 记录 arena 当前状态
+ * @param a arena 指针
+ * @return 返回保存点
+ */
+arena_savepoint arena_save(arena *a);
+
+/**
+ * @brief 回滚到保存点，释放保存点之后申请的全部内存，内存块保留复用
+ * @param a arena 指针
+ * @param sp 保存点，需晚于最近一次重置
+ */
+void arena_rollback(arena *a, arena_savepoint sp);
+
+/**
+ * @brief 以 O(1) 时间释放 arena 中申请的全部内存，内存块保留复用
+ * @param a arena 指针
+ */
+void arena_reset(arena *a);
+
+/**
+ * @brief 释放 arena 中当前未使用的内存块
+ * @param a arena 指针
+ */
+void arena_trim(arena *a);
+
+/**
+ * @brief 获取 arena 的分配器接口，可传给各模块的 *_with_allocator 函数
+ *
+ * 通过该接口释放内存为空操作，内存随 arena_reset() 或 arena_destroy() 一起
+ * 释放。
+ *
+ * @param a arena 指针
+ * @return 返回分配器指针，生命周期与 arena 相同
+ */
+mem_allocator *arena_get_allocator(arena *a);
+
+#endif // !__ARENA_H_
@@ -7,20 +7,76 @@
 #ifndef __COMMON_H_
 #define __COMMON_H_
 
+#include <stddef.h>
+
 #ifndef NULL
 #define NULL (void *)0
 #endif // !NULL
 
+/**
+ * @brief 内存统计的调用处信息，由 MEM_STATS_SITE() 在每个调用处静态定义
+ */
+typedef struct mem_stats_site {
+  const char *file; /* 调用处所在文件 */
+  int line;         /* 调用处所在行 */
+  unsigned int id;  /* 注册后的编号，为 0 表示尚未注册 */
+} mem_stats_site;
+
+/* 编译时定义 USE_TC_ALLOC 后，内存分配宏改用线程缓存分配器（tc_alloc.h） */
+#ifdef USE_TC_ALLOC
+void *tc_malloc(size_t size);
+void tc_free(void *ptr);
+#endif // USE_TC_ALLOC
+
+/* 编译时定义 USE_MEM_STATS 后，内存分配宏按调用处统计（mem_stats.h） */
+#ifdef USE_MEM_STATS
+void *mem_stats_alloc(size_t size, mem_stats_site *site);
+void mem_stats_free(void *ptr);
+#define MEM_STATS_SITE()                                                       \
+  __extension__({                                                              \
+    static mem_stats_site mem_stats_site_ = {__FILE__, __LINE__, 0};           \
+    &mem_stats_site_;                                                          \
+  })
+#define MALLOC_FUNC(property)                                                  \
+  (property *)mem_stats_alloc(sizeof(property), MEM_STATS_SITE())
+#define MALLOC_ARRAY_FUNC(property, n)                                         \
+  (property *)mem_stats_alloc(sizeof(property) * (n), MEM_STATS_SITE())
+#define FREE_FUNC mem_stats_free
+#elif defined(USE_TC_ALLOC)
+#define MALLOC_FUNC(property) (property *)tc_malloc(sizeof(property))
+#define MALLOC_ARRAY_FUNC(property, n)                                         \
+  (property *)tc_malloc(sizeof(property) * (n))
+#define FREE_FUNC tc_free
+#endif // USE_MEM_STATS
+
 /* 定义一个宏，用于根据属性类型分配内存并返回指针 */
 #ifndef MALLOC_FUNC
 #define MALLOC_FUNC(property) (property *)malloc(sizeof(property))
 #endif // !MALLOC_FUNC
 
+/* 定义一个宏，用于根据属性类型分配数组内存并返回指针 */
+#ifndef MALLOC_ARRAY_FUNC
+#define MALLOC_ARRAY_FUNC(property, n)                                         \
+  (property *)malloc(sizeof(property) * (n))
+#endif // !MALLOC_ARRAY_FUNC
+
 /* 定义一个宏，用于释放内存 */
 #ifndef FREE_FUNC
 #define FREE_FUNC free
 #endif // !FREE_FUNC
 
+/* 定义一个宏，用于通过分配器根据属性类型分配内存并返回指针 */
+#ifndef MEM_ALLOC_FUNC
+#define MEM_ALLOC_FUNC(allocator, property)                                    \
+  (property *)mem_alloc(allocator, sizeof(property))
+#endif // !MEM_ALLOC_FUNC
+
+/* 定义一个宏，用于通过分配器根据属性类型分配数组内存并返回指针 */
+#ifndef MEM_ALLOC_ARRAY_FUNC
+#define MEM_ALLOC_ARRAY_FUNC(allocator, property, n)                           \
+  (property *)mem_alloc(allocator, sizeof(property) * (n))
+#endif // !MEM_ALLOC_ARRAY_FUNC
+
 /* 定义一个宏，用于标记未使用的变量，防止编译器警告 */
 #ifndef UNUSED
 #define UNUSED(x) (void)(x)
@@ -36,6 +92,12 @@
 #define ARRAY_LEN(x) (sizeof(x) / sizeof(x[0]))
 #endif // !ARRAY_LEN
 
+/* 定义一个宏，用于通过成员指针获取其所在结构体的指针 */
+#ifndef container_of
+#define container_of(ptr, type, member)                                        \
+  ((type *)((char *)(ptr)-offsetof(type, member)))
+#endif // !container_of
+
 /* 定义一个宏，用于遍历链表结构 */
 #define each_node_for_linked(node, linked, property)                           \
   for (node = linked; node != NULL; node = node->property)
@@ -52,6 +114,18 @@ typedef enum {
   ret_null_pointer,
 } ret_val;
 
+/**
+ * @brief 内存分配器，各模块在初始化时传入，为 NULL 时使用默认分配器。
+ */
+typedef struct mem_allocator {
+  void *(*alloc)(void *ctx, size_t size); /* 申请内存 */
+  void *(*realloc)(void *ctx, void *ptr, size_t size); /* 调整内存大小 */
+  void (*free)(void *ctx, void *ptr);                  /* 释放内存 */
+  void *(*aligned_alloc)(void *ctx, size_t align,
+                         size_t size); /* 按对齐要求申请内存 */
+  void *ctx;                           /* 分配器上下文 */
+} mem_allocator;
+
 /**
  * @brief 验证指针是否有效。
  * @param ptr 待验证的指针。
@@ -59,4 +133,60 @@ typedef enum {
  */
 ret_val validate_pointer(void *ptr);
 
+/**
+ * @brief 获取默认分配器，基于 MALLOC_ARRAY_FUNC 和 FREE_FUNC 宏。
+ * @return 返回默认分配器指针。
+ */
+mem_allocator *mem_allocator_default(void);
+
+/**
+ * @brief 通过分配器申请内存。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+void *mem_alloc(mem_allocator *allocator, size_t size);
+
+/**
+ * @brief 通过分配器调整内存大小。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param ptr 原内存指针，可为 NULL。
+ * @param size 新的字节数。
+ * @return 返回新的内存指针，失败返回 NULL 且原内存不变。
+ */
+void *mem_realloc(mem_allocator *allocator, void *ptr, size_t size);
+
+/**
+ * @brief 通过分配器释放内存。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param ptr 内存指针，可为 NULL。
+ */
+void mem_free(mem_allocator *allocator, void *ptr);
+
+/**
+ * @brief 通过分配器按对齐要求申请内存，可用 mem_free() 释放。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param align 对齐字节数，需为 2 的幂。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+void *mem_aligned_alloc(mem_allocator *allocator, size_t align, size_t size);
+
+#ifdef USE_MEM_STATS
+void *mem_alloc_site(mem_allocator *allocator, size_t size,
+                     mem_stats_site *site);
+void *mem_realloc_site(mem_allocator *allocator, void *ptr, size_t size,
+                       mem_stats_site *site);
+void *mem_aligned_alloc_site(mem_allocator *allocator, size_t align,
+                             size_t size, mem_stats_site *site);
+
+/* 通过默认分配器申请的内存同样按调用处统计 */
+#define mem_alloc(allocator, size)                                             \
+  mem_alloc_site(allocator, size, MEM_STATS_SITE())
+#define mem_realloc(allocator, ptr, size)                                      \
+  mem_realloc_site(allocator, ptr, size, MEM_STATS_SITE())
+#define mem_aligned_alloc(allocator, align, size)                              \
+  mem_aligned_alloc_site(allocator, align, size, MEM_STATS_SITE())
+#endif // USE_MEM_STATS
+
 #endif // !__COMMON_H_
@@ -0,0 +1,127 @@
+/**
+ * @file cpu_features.h
+ * @brief CPU 指令集特性检测及运行时分派头文件
+ *
+ * x86 通过 CPUID 检测，需要操作系统保存寄存器状态的特性（AVX、AVX-512）
+ * 同时检查 XGETBV；ARM 通过 getauxval() 读取内核提供的 hwcap。
+ *
+ * 需要按指令集选择实现的模块将各实现放入函数表，再按优先级列出
+ * cpu_dispatch_entry，首次调用时由 cpu_dispatch_resolve() 选出 CPU 支持的
+ * 第一项并缓存，之后只需一次原子读取。
+ *
+ * @author moecly
+ */
+
+#ifndef __CPU_FEATURES_H_
+#define __CPU_FEATURES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* x86 特性 */
+#define CPU_FEATURE_SSE2 (UINT64_C(1) << 0)
+#define CPU_FEATURE_SSE3 (UINT64_C(1) << 1)
+#define CPU_FEATURE_SSSE3 (UINT64_C(1) << 2)
+#define CPU_FEATURE_SSE41 (UINT64_C(1) << 3)
+#define CPU_FEATURE_SSE42 (UINT64_C(1) << 4)
+#define CPU_FEATURE_POPCNT (UINT64_C(1) << 5)
+#define CPU_FEATURE_PCLMUL (UINT64_C(1) << 6)
+#define CPU_FEATURE_AESNI (UINT64_C(1) << 7)
+#define CPU_FEATURE_AVX (UINT64_C(1) << 8)
+#define CPU_FEATURE_FMA (UINT64_C(1) << 9)
+#define CPU_FEATURE_AVX2 (UINT64_C(1) << 10)
+#define CPU_FEATURE_BMI1 (UINT64_C(1) << 11)
+#define CPU_FEATURE_BMI2 (UINT64_C(1) << 12)
+#define CPU_FEATURE_ERMS (UINT64_C(1) << 13)
+#define CPU_FEATURE_SHA (UINT64_C(1) << 14)
+#define CPU_FEATURE_AVX512F (UINT64_C(1) << 15)
+#define CPU_FEATURE_AVX512DQ (UINT64_C(1) << 16)
+#define CPU_FEATURE_AVX512CD (UINT64_C(1) << 17)
+#define CPU_FEATURE_AVX512BW (UINT64_C(1) << 18)
+#define CPU_FEATURE_AVX512VL (UINT64_C(1) << 19)
+#define CPU_FEATURE_AVX512VBMI (UINT64_C(1) << 20)
+
+/* ARM 特性 */
+#define CPU_FEATURE_NEON (UINT64_C(1) << 32)
+#define CPU_FEATURE_ARM_AES (UINT64_C(1) << 33)
+#define CPU_FEATURE_ARM_PMULL (UINT64_C(1) << 34)
+#define CPU_FEATURE_ARM_SHA1 (UINT64_C(1) << 35)
+#define CPU_FEATURE_ARM_SHA2 (UINT64_C(1) << 36)
+#define CPU_FEATURE_ARM_CRC32 (UINT64_C(1) << 37)
+#define CPU_FEATURE_SVE (UINT64_C(1) << 38)
+#define CPU_FEATURE_SVE2 (UINT64_C(1) << 39)
+
+/* 常用的特性组合 */
+#define CPU_FEATURE_X86_V2                                                     \
+  (CPU_FEATURE_SSE2 | CPU_FEATURE_SSE3 | CPU_FEATURE_SSSE3 |                   \
+   CPU_FEATURE_SSE41 | CPU_FEATURE_SSE42 | CPU_FEATURE_POPCNT)
+#define CPU_FEATURE_X86_V3                                                     \
+  (CPU_FEATURE_X86_V2 | CPU_FEATURE_AVX | CPU_FEATURE_AVX2 |                   \
+   CPU_FEATURE_BMI1 | CPU_FEATURE_BMI2 | CPU_FEATURE_FMA)
+#define CPU_FEATURE_X86_V4                                                     \
+  (CPU_FEATURE_X86_V3 | CPU_FEATURE_AVX512F | CPU_FEATURE_AVX512BW |           \
+   CPU_FEATURE_AVX512CD | CPU_FEATURE_AVX512DQ | CPU_FEATURE_AVX512VL)
+
+/**
+ * @brief 分派表项
+ */
+typedef struct {
+  uint64_t required; /* 需要的特性组合，为 0 表示任何 CPU 均可使用 */
+  const void *impl;  /* 实现，通常为函数表指针 */
+} cpu_dispatch_entry;
+
+/**
+ * @brief 获取当前 CPU 支持的特性，首次调用时检测
+ * @return 返回 CPU_FEATURE_* 的组合，已去除 cpu_features_disable() 屏蔽的特性
+ */
+uint64_t cpu_features_get(void);
+
+/**
+ * @brief 判断当前 CPU 是否支持全部指定特性
+ * @param features CPU_FEATURE_* 的组合
+ * @return 全部支持返回 1，否则返回 0
+ */
+int cpu_features_has(uint64_t features);
+
+/**
+ * @brief 屏蔽指定特性，用于测试较低指令集的实现或绕过有问题的硬件
+ *
+ * 只影响之后的检测结果，已缓存的分派结果不变，应在程序启动时调用。
+ *
+ * @param features 需要屏蔽的 CPU_FEATURE_* 组合
+ */
+void cpu_features_disable(uint64_t features);
+
+/**
+ * @brief 按顺序选出第一个 CPU 支持的实现
+ * @param entries 分派表，按优先级从高到低排列，最后一项通常为通用实现
+ * @param n 表项数
+ * @return 返回选中的实现，均不支持返回 NULL
+ */
+const void *cpu_dispatch_select(const cpu_dispatch_entry *entries, size_t n);
+
+/**
+ * @brief 从缓存中获取实现，缓存为空时调用 cpu_dispatch_select() 并保存
+ *
+ * 多个线程同时首次调用时可能各自选择一次，结果相同。
+ *
+ * @param cache 缓存位置，初始为 NULL
+ * @param entries 分派表
+ * @param n 表项数
+ * @return 返回选中的实现，均不支持返回 NULL
+ */
+const void *cpu_dispatch_resolve(const void **cache,
+                                 const cpu_dispatch_entry *entries, size_t n);
+
+/* 定义一个宏，用于获取 entries 数组对应的实现，cache 为该实现类型的静态指针 */
+#define CPU_DISPATCH(cache, entries)                                           \
+  ({                                                                           \
+    __typeof__(cache) __impl = __atomic_load_n(&(cache), __ATOMIC_ACQUIRE);    \
+    if (__builtin_expect(__impl == NULL, 0))                                   \
+      __impl = (__typeof__(cache))cpu_dispatch_resolve(                        \
+          (const void **)&(cache), (entries),                                  \
+          sizeof(entries) / sizeof((entries)[0]));                             \
+    __impl;                                                                    \
+  })
+
+#endif // !__CPU_FEATURES_H_
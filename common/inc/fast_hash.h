@@ -0,0 +1,109 @@
+/**
+ * @file fast_hash.h
+ * @brief 非加密哈希头文件
+ *
+ * 算法与 XXH3（xxHash 0.8）的 64 位和 128 位输出一致，可与其他语言的实现
+ * 互通。长输入的累加循环在运行时按 CPU 支持的指令集选择 AVX-512、AVX2、
+ * SSE2 或标量实现，结果相同。带种子的版本可用于抵御哈希洪泛，不能用于
+ * 校验数据来源或签名。
+ *
+ * @author moecly
+ */
+
+#ifndef __FAST_HASH_H_
+#define __FAST_HASH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* 内部密钥字节数 */
+#define FAST_HASH_SECRET_SIZE 192
+
+/* 流式接口的缓冲区字节数 */
+#define FAST_HASH_BUFFER_SIZE 256
+
+/**
+ * @brief 128 位哈希值
+ */
+typedef struct {
+  uint64_t low;  /* 低 64 位 */
+  uint64_t high; /* 高 64 位 */
+} fast_hash128_val;
+
+/**
+ * @brief 流式哈希状态，可在栈上定义
+ */
+typedef struct {
+  uint64_t acc[8] __attribute__((aligned(64))); /* 累加器 */
+  unsigned char secret[FAST_HASH_SECRET_SIZE];  /* 由种子派生的密钥 */
+  unsigned char buffer[FAST_HASH_BUFFER_SIZE];  /* 未处理的输入 */
+  size_t buffered;                              /* 缓冲的字节数 */
+  size_t stripes;                               /* 当前块已处理的条带数 */
+  uint64_t total_len;                           /* 输入总字节数 */
+  uint64_t seed;                                /* 种子 */
+} fast_hash_state;
+
+/**
+ * @brief 计算 64 位哈希值
+ * @param data 数据指针，len 为 0 时可为 NULL
+ * @param len 字节数
+ * @return 返回哈希值
+ */
+uint64_t fast_hash64(const void *data, size_t len);
+
+/**
+ * @brief 使用种子计算 64 位哈希值
+ * @param data 数据指针，len 为 0 时可为 NULL
+ * @param len 字节数
+ * @param seed 种子，为 0 时与 fast_hash64() 相同
+ * @return 返回哈希值
+ */
+uint64_t fast_hash64_seed(const void *data, size_t len, uint64_t seed);
+
+/**
+ * @brief 计算 128 位哈希值
+ * @param data 数据指针，len 为 0 时可为 NULL
+ * @param len 字节数
+ * @return 返回哈希值
+ */
+fast_hash128_val fast_hash128(const void *data, size_t len);
+
+/**
+ * @brief 使用种子计算 128 位哈希值
+ * @param data 数据指针，len 为 0 时可为 NULL
+ * @param len 字节数
+ * @param seed 种子，为 0 时与 fast_hash128() 相同
+ * @return 返回哈希值
+ */
+fast_hash128_val fast_hash128_seed(const void *data, size_t len, uint64_t seed);
+
+/**
+ * @brief 初始化流式哈希状态
+ * @param state 状态指针
+ * @param seed 种子
+ */
+void fast_hash_init(fast_hash_state *state, uint64_t seed);
+
+/**
+ * @brief 输入数据
+ * @param state 状态指针
+ * @param data 数据指针，len 为 0 时可为 NULL
+ * @param len 字节数
+ */
+void fast_hash_update(fast_hash_state *state, const void *data, size_t len);
+
+/**
+ * @brief 获取当前输入的 64 位哈希值，不影响之后继续输入
+ * @param state 状态指针
+ * @return 返回与一次性计算相同的哈希值
+ */
+uint64_t fast_hash_digest64(const fast_hash_state *state);
+
+/**
+ * @brief 获取当前输入的 128 位哈希值，不影响之后继续输入
+ * @param state 状态指针
+ * @return 返回与一次性计算相同的哈希值
+ */
+fast_hash128_val fast_hash_digest128(const fast_hash_state *state);
+
+#endif // !__FAST_HASH_H_
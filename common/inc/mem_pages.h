@@ -0,0 +1,127 @@
+/**
+ * @file mem_pages.h
+ * @brief 缓存行/页对齐、大页及 NUMA 绑定的内存申请头文件
+ *
+ * 适用于环形缓冲区、哈希表存储等较大且长期存在的内存。容器可通过
+ * mem_page_allocator_init() 得到的分配器接口使用这些内存。
+ *
+ * @author moecly
+ */
+
+#ifndef __MEM_PAGES_H_
+#define __MEM_PAGES_H_
+
+#include "common.h"
+#include <stddef.h>
+
+/* 缓存行大小 */
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif // !CACHE_LINE_SIZE
+
+/* 大页大小，使用大页时映射大小按此向上取整 */
+#ifndef MEM_HUGE_PAGE_SIZE
+#define MEM_HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+#endif // !MEM_HUGE_PAGE_SIZE
+
+/* 支持的最大 NUMA 节点数 */
+#ifndef MEM_NUMA_MAX_NODES
+#define MEM_NUMA_MAX_NODES 1024
+#endif // !MEM_NUMA_MAX_NODES
+
+/* 不绑定 NUMA 节点 */
+#define MEM_NUMA_NODE_ANY (-1)
+
+/* 定义一个宏，用于将变量或结构体按缓存行对齐 */
+#ifndef CACHE_LINE_ALIGNED
+#define CACHE_LINE_ALIGNED __attribute__((aligned(CACHE_LINE_SIZE)))
+#endif // !CACHE_LINE_ALIGNED
+
+/* 定义一个宏，用于在结构体中填充到下一个缓存行，used 为前面已占用的字节数，
+ * 恰好占满整行时填充 0 字节 */
+#ifndef CACHE_LINE_PAD
+#define CACHE_LINE_PAD(name, used)                                             \
+  char name[(CACHE_LINE_SIZE - ((used) % CACHE_LINE_SIZE)) % CACHE_LINE_SIZE]
+#endif // !CACHE_LINE_PAD
+
+/**
+ * @brief 页内存申请标志
+ */
+typedef enum {
+  mem_page_flag_none = 0,          /* 使用普通页 */
+  mem_page_flag_huge = 1 << 0,     /* 优先使用大页，失败时退化为透明大页 */
+  mem_page_flag_populate = 1 << 1, /* 申请后立即按绑定的节点分配物理页 */
+} mem_page_flag;
+
+/**
+ * @brief 以页为单位申请内存的分配器，每次申请独立映射，适合大块内存
+ */
+typedef struct {
+  mem_allocator allocator; /* 分配器接口 */
+  int flags;               /* mem_page_flag 的组合 */
+  int node;                /* 绑定的 NUMA 节点，MEM_NUMA_NODE_ANY 表示不绑定 */
+} mem_page_allocator;
+
+/**
+ * @brief 按缓存行对齐申请内存，字节数向上取整为缓存行的整数倍
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器
+ * @param size 字节数
+ * @return 返回内存指针，失败返回 NULL，使用 mem_free() 释放
+ */
+void *mem_cache_aligned_alloc(mem_allocator *allocator, size_t size);
+
+/**
+ * @brief 按页映射内存，可选大页和 NUMA 节点绑定
+ *
+ * 使用大页时先尝试 MAP_HUGETLB，没有预留大页时改用普通映射并通过
+ * madvise(MADV_HUGEPAGE) 建议内核使用透明大页。NUMA 绑定在首次访问前
+ * 完成，内核不支持时忽略。
+ *
+ * @param size 字节数
+ * @param flags mem_page_flag 的组合
+ * @param node 绑定的 NUMA 节点，MEM_NUMA_NODE_ANY 表示不绑定
+ * @param map_size 保存实际映射的字节数，释放时传入
+ * @return 返回页对齐的内存指针，失败返回 NULL
+ */
+void *mem_pages_alloc(size_t size, int flags, int node, size_t *map_size);
+
+/**
+ * @brief 释放 mem_pages_alloc() 映射的内存
+ * @param addr 内存指针
+ * @param map_size mem_pages_alloc() 返回的映射字节数
+ */
+void mem_pages_free(void *addr, size_t map_size);
+
+/**
+ * @brief 将内存区域绑定到 NUMA 节点，需在首次访问前调用
+ * @param addr 页对齐的内存指针
+ * @param len 字节数
+ * @param node NUMA 节点
+ * @return 成功返回 ret_ok，失败返回 ret_err
+ */
+ret_val mem_numa_bind(void *addr, size_t len, int node);
+
+/**
+ * @brief 设置当前线程之后申请内存时优先使用的 NUMA 节点
+ * @param node NUMA 节点，MEM_NUMA_NODE_ANY 表示恢复默认策略
+ * @return 成功返回 ret_ok，失败返回 ret_err
+ */
+ret_val mem_numa_set_preferred(int node);
+
+/**
+ * @brief 获取当前线程所在 CPU 的 NUMA 节点
+ * @return 返回节点编号，失败返回 MEM_NUMA_NODE_ANY
+ */
+int mem_numa_current_node(void);
+
+/**
+ * @brief 初始化页分配器
+ * @param pa 页分配器指针
+ * @param flags mem_page_flag 的组合
+ * @param node 绑定的 NUMA 节点，MEM_NUMA_NODE_ANY 表示不绑定
+ * @return 返回分配器接口指针，生命周期与 pa 相同
+ */
+mem_allocator *mem_page_allocator_init(mem_page_allocator *pa, int flags,
+                                       int node);
+
+#endif // !__MEM_PAGES_H_
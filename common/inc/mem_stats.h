@@ -0,0 +1,87 @@
+/**
+ * @file mem_stats.h
+ * @brief 内存分配统计头文件
+ *
+ * 编译时定义 USE_MEM_STATS 后，MALLOC_FUNC、MALLOC_ARRAY_FUNC、FREE_FUNC 及
+ * 默认分配器按调用处记录申请次数、释放次数、存量字节数和峰值字节数。计数
+ * 写入线程私有的分片，读取快照时再合并。未定义时分配宏保持原样，快照为空。
+ *
+ * @author moecly
+ */
+
+#ifndef __MEM_STATS_H_
+#define __MEM_STATS_H_
+
+#include "common.h"
+#include <stdint.h>
+
+/* 可区分的调用处数量上限，超出的调用处合并到编号为 0 的条目 */
+#ifndef MEM_STATS_MAX_SITES
+#define MEM_STATS_MAX_SITES 512
+#endif // !MEM_STATS_MAX_SITES
+
+/**
+ * @brief 单个调用处或模块的统计信息
+ */
+typedef struct {
+  const char *file;   /* 调用处所在文件，模块汇总时为 NULL */
+  int line;           /* 调用处所在行，模块汇总时为 0 */
+  const char *module; /* 所属模块，取文件路径中 src 或 inc 的上一级目录名 */
+  uint64_t allocs;    /* 申请次数 */
+  uint64_t frees;     /* 释放次数 */
+  int64_t live_bytes; /* 存量字节数 */
+  int64_t peak_bytes; /* 峰值字节数，取各分片及历次快照观测到的最大值 */
+} mem_stats_entry;
+
+/**
+ * @brief 统计快照
+ */
+typedef struct {
+  mem_stats_entry *entries; /* 各调用处的统计信息 */
+  uint32_t count;           /* 条目数 */
+} mem_stats_snapshot;
+
+#ifdef USE_MEM_STATS
+/**
+ * @brief 按调用处统计并调整内存大小
+ * @param ptr 原内存指针，可为 NULL
+ * @param size 新的字节数
+ * @param site 调用处信息
+ * @return 返回新的内存指针，失败返回 NULL 且原内存不变
+ */
+void *mem_stats_realloc(void *ptr, size_t size, mem_stats_site *site);
+
+/**
+ * @brief 按调用处统计并按对齐要求申请内存，可用 FREE_FUNC 释放
+ * @param align 对齐字节数，需为 2 的幂
+ * @param size 字节数
+ * @param site 调用处信息
+ * @return 返回内存指针，失败返回 NULL
+ */
+void *mem_stats_aligned_alloc(size_t align, size_t size, mem_stats_site *site);
+#endif // USE_MEM_STATS
+
+/**
+ * @brief 合并各线程分片，生成各调用处的统计快照
+ * @param snap 快照指针，使用后调用 mem_stats_snapshot_free() 释放
+ * @return 成功返回 ret_ok，内存不足返回 ret_err
+ */
+ret_val mem_stats_snapshot_take(mem_stats_snapshot *snap);
+
+/**
+ * @brief 将快照按模块汇总
+ * @param snap 快照指针
+ * @param out 存储汇总结果的数组
+ * @param max 数组长度
+ * @return 返回写入的模块数，超过 max 的模块被忽略
+ */
+uint32_t mem_stats_snapshot_by_module(const mem_stats_snapshot *snap,
+                                      mem_stats_entry *out, uint32_t max);
+
+/**
+ * @brief 释放快照
+ * @param snap 快照指针
+ */
+void mem_stats_snapshot_free(mem_stats_snapshot *snap);
+
+#endif // !__MEM_STATS_H_
@@ -0,0 +1,198 @@
+/**
+ * @file metrics.h
+ * @brief 指标注册及 Prometheus 文本导出头文件
+ *
+ * 支持计数器、仪表和对数线性直方图。计数器和直方图写入线程私有的分片，
+ * 热路径上只有普通的加法和一次线程局部变量读取，导出时再合并各分片；
+ * 仪表需要支持直接设置，使用全局原子变量。
+ *
+ * 指标按名称注册，句柄在进程内保持不变，重复注册同名同类型指标返回相同
+ * 句柄。编译时定义 USE_METRICS 后，库内各模块通过 METRICS_COUNT 等宏
+ * 记录内部指标，未定义时这些宏为空。
+ *
+ * @author moecly
+ */
+
+#ifndef __METRICS_H_
+#define __METRICS_H_
+
+#include "common.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* 可注册的指标数量上限 */
+#ifndef METRICS_MAX_METRICS
+#define METRICS_MAX_METRICS 256
+#endif // !METRICS_MAX_METRICS
+
+/* 每个线程分片的计数槽数量，每个计数器占一个，每个直方图占桶数加一个 */
+#ifndef METRICS_MAX_SLOTS
+#define METRICS_MAX_SLOTS 4096
+#endif // !METRICS_MAX_SLOTS
+
+/* 指标名称的最大长度 */
+#define METRICS_NAME_LEN 128
+
+/* 直方图每个 2 的幂区间内的线性子桶数为 2^METRICS_HIST_SUB_BITS */
+#define METRICS_HIST_SUB_BITS 2
+
+/* 无效句柄，注册失败时返回，对其操作无效果 */
+#define METRICS_INVALID_HANDLE 0
+
+/**
+ * @brief 指标句柄
+ */
+typedef uint32_t metrics_handle;
+
+/**
+ * @brief 指标类型
+ */
+typedef enum {
+  metrics_type_counter,   /* 只增计数器 */
+  metrics_type_gauge,     /* 可增减或直接设置的仪表 */
+  metrics_type_histogram, /* 对数线性直方图 */
+} metrics_type;
+
+/**
+ * @brief 注册计数器
+ * @param name 指标名称，需符合 Prometheus 命名规则，通常以 _total 结尾
+ * @param help 说明文字，可为 NULL
+ * @return 返回句柄，名称无效、已注册为其他类型或空间不足返回
+ * METRICS_INVALID_HANDLE
+ */
+metrics_handle metrics_counter_register(const char *name, const char *help);
+
+/**
+ * @brief 注册仪表
+ * @param name 指标名称
+ * @param help 说明文字，可为 NULL
+ * @return 返回句柄，失败返回 METRICS_INVALID_HANDLE
+ */
+metrics_handle metrics_gauge_register(const char *name, const char *help);
+
+/**
+ * @brief 注册直方图
+ *
+ * 小于 2^METRICS_HIST_SUB_BITS 的值各占一个桶，更大的值按 2 的幂分段，每段
+ * 再线性分为 2^METRICS_HIST_SUB_BITS 个桶，桶上界的相对误差不超过 25%。
+ * 超过 max 的值计入 +Inf 桶。
+ *
+ * @param name 指标名称
+ * @param help 说明文字，可为 NULL
+ * @param max 需要区分的最大值，决定桶的数量
+ * @return 返回句柄，失败返回 METRICS_INVALID_HANDLE
+ */
+metrics_handle metrics_histogram_register(const char *name, const char *help,
+                                          uint64_t max);
+
+/**
+ * @brief 增加计数器的值
+ * @param handle 计数器句柄
+ * @param n 增加的值
+ */
+void metrics_counter_add(metrics_handle handle, uint64_t n);
+
+/**
+ * @brief 设置仪表的值
+ * @param handle 仪表句柄
+ * @param val 新的值
+ */
+void metrics_gauge_set(metrics_handle handle, int64_t val);
+
+/**
+ * @brief 增加仪表的值
+ * @param handle 仪表句柄
+ * @param n 增加的值，可为负数
+ */
+void metrics_gauge_add(metrics_handle handle, int64_t n);
+
+/**
+ * @brief 向直方图记录一个值
+ * @param handle 直方图句柄
+ * @param val 记录的值
+ */
+void metrics_histogram_observe(metrics_handle handle, uint64_t val);
+
+/**
+ * @brief 合并各线程分片，获取计数器的值
+ * @param handle 计数器句柄
+ * @return 返回计数器的值，句柄无效返回 0
+ */
+uint64_t metrics_counter_get(metrics_handle handle);
+
+/**
+ * @brief 获取仪表的值
+ * @param handle 仪表句柄
+ * @return 返回仪表的值，句柄无效返回 0
+ */
+int64_t metrics_gauge_get(metrics_handle handle);
+
+/**
+ * @brief 合并各线程分片，获取直方图的记录次数和总和
+ * @param handle 直方图句柄
+ * @param count 保存记录次数，可为 NULL
+ * @param sum 保存记录值的总和，可为 NULL
+ */
+void metrics_histogram_get(metrics_handle handle, uint64_t *count,
+                           uint64_t *sum);
+
+/**
+ * @brief 估算直方图的分位数
+ * @param handle 直方图句柄
+ * @param q 分位，取值 0 到 1
+ * @return 返回分位数所在桶的上界，没有记录时返回 0，落在 +Inf 桶时返回
+ * UINT64_MAX
+ */
+uint64_t metrics_histogram_percentile(metrics_handle handle, double q);
+
+/**
+ * @brief 以 Prometheus 文本格式导出全部指标到缓冲区
+ * @param buf 缓冲区，size 为 0 时可为 NULL
+ * @param size 缓冲区字节数，内容超出时截断，size 不为 0 时总以 '\0' 结尾
+ * @return 返回完整内容的字节数，不含结尾的 '\0'，大于等于 size 表示已截断
+ */
+size_t metrics_export(char *buf, size_t size);
+
+/**
+ * @brief 以 Prometheus 文本格式导出全部指标到文件描述符
+ * @param fd 文件描述符
+ * @return 成功返回 ret_ok，写入失败返回 ret_err
+ */
+ret_val metrics_export_fd(int fd);
+
+#ifdef USE_METRICS
+/* 定义一个宏，用于在调用处首次执行时注册计数器并增加其值 */
+#define METRICS_COUNT(name, help, n)                                           \
+  do {                                                                         \
+    static metrics_handle __metrics_handle;                                    \
+    metrics_handle __h =                                                       \
+        __atomic_load_n(&__metrics_handle, __ATOMIC_ACQUIRE);                  \
+    if (__builtin_expect(__h == METRICS_INVALID_HANDLE, 0)) {                  \
+      __h = metrics_counter_register(name, help);                              \
+      __atomic_store_n(&__metrics_handle, __h, __ATOMIC_RELEASE);              \
+    }                                                                          \
+    metrics_counter_add(__h, n);                                               \
+  } while (0)
+
+/* 定义一个宏，用于在调用处首次执行时注册直方图并记录一个值 */
+#define METRICS_OBSERVE(name, help, max, val)                                  \
+  do {                                                                         \
+    static metrics_handle __metrics_handle;                                    \
+    metrics_handle __h =                                                       \
+        __atomic_load_n(&__metrics_handle, __ATOMIC_ACQUIRE);                  \
+    if (__builtin_expect(__h == METRICS_INVALID_HANDLE, 0)) {                  \
+      __h = metrics_histogram_register(name, help, max);                       \
+      __atomic_store_n(&__metrics_handle, __h, __ATOMIC_RELEASE);              \
+    }                                                                          \
+    metrics_histogram_observe(__h, val);                                       \
+  } while (0)
+#else
+#define METRICS_COUNT(name, help, n)                                           \
+  do {                                                                         \
+  } while (0)
+#define METRICS_OBSERVE(name, help, max, val)                                  \
+  do {                                                                         \
+  } while (0)
+#endif // USE_METRICS
+
+#endif // !__METRICS_H_
@@ -0,0 +1,137 @@
+/**
+ * @file obj_pool.h
+ * @brief 按类型生成的对象池头文件
+ *
+ * DEFINE_POOL(type) 生成 type##_pool_get() 和 type##_pool_put()。每个线程
+ * 持有两个弹匣（当前弹匣和备用弹匣），满弹匣通过带版本号的无锁栈在线程
+ * 间流转，仓库为空时才加锁从内存块中切分新对象。线程退出时弹匣中的对象
+ * 归还到仓库。对象所在内存在程序运行期间不释放。
+ *
+ * @author moecly
+ */
+
+#ifndef __OBJ_POOL_H_
+#define __OBJ_POOL_H_
+
+#include "common.h"
+#include <pthread.h>
+#include <stdint.h>
+
+/* 每个弹匣的对象数 */
+#ifndef OBJ_POOL_MAGAZINE_SIZE
+#define OBJ_POOL_MAGAZINE_SIZE 32
+#endif // !OBJ_POOL_MAGAZINE_SIZE
+
+/* 每次切分的内存块包含的弹匣数 */
+#ifndef OBJ_POOL_CHUNK_MAGAZINES
+#define OBJ_POOL_CHUNK_MAGAZINES 4
+#endif // !OBJ_POOL_CHUNK_MAGAZINES
+
+/* 对象槽位大小，空闲对象需容纳三个字的链表信息，按 16 字节对齐 */
+#define OBJ_POOL_SLOT_SIZE(size)                                               \
+  ((((size) > 3 * sizeof(void *) ? (size) : 3 * sizeof(void *)) + 15) &        \
+   ~(size_t)15)
+
+/**
+ * @brief 对象构造或析构函数
+ */
+typedef void (*obj_pool_hook)(void *obj);
+
+/**
+ * @brief 线程私有的弹匣
+ */
+typedef struct obj_pool_magazine {
+  void *cur;                      /* 当前弹匣的对象链表 */
+  uint32_t cur_count;             /* 当前弹匣的对象数 */
+  void *spare;                    /* 备用弹匣，非空时总是满的 */
+  struct obj_pool *pool;          /* 所属对象池，为 NULL 表示尚未注册 */
+  struct obj_pool_magazine *next; /* 同一线程注册的下一个弹匣 */
+} obj_pool_magazine;
+
+/**
+ * @brief 对象池
+ */
+typedef struct obj_pool {
+  uint64_t depot;       /* 满弹匣栈，低 48 位为指针，高 16 位为版本号 */
+  size_t slot_size;     /* 对象槽位大小 */
+  obj_pool_hook ctor;   /* 取出对象后调用，可为 NULL */
+  obj_pool_hook dtor;   /* 归还对象前调用，可为 NULL */
+  pthread_mutex_t lock; /* 保护内存块链表的互斥锁 */
+  void *chunks;         /* 已申请的内存块链表 */
+  size_t chunk_bytes;   /* 已申请的内存块总字节数 */
+} obj_pool;
+
+/* 定义一个宏，用于静态初始化对象池 */
+#define OBJ_POOL_INITIALIZER(type, ctor_func, dtor_func)                       \
+  {                                                                            \
+    .depot = 0, .slot_size = OBJ_POOL_SLOT_SIZE(sizeof(type)),                 \
+    .ctor = (ctor_func), .dtor = (dtor_func),                                  \
+    .lock = PTHREAD_MUTEX_INITIALIZER, .chunks = NULL, .chunk_bytes = 0,       \
+  }
+
+/* 定义一个宏，用于在头文件中声明对象池的存取函数 */
+#define DECLARE_POOL(type)                                                     \
+  type *type##_pool_get(void);                                                 \
+  void type##_pool_put(type *obj);
+
+/* 定义一个宏，用于生成带构造和析构函数的对象池，ctor 和 dtor 可为 NULL */
+#define DEFINE_POOL_WITH_HOOKS(type, ctor_func, dtor_func)                     \
+  static obj_pool type##_pool =                                                \
+      OBJ_POOL_INITIALIZER(type, ctor_func, dtor_func);                        \
+  static __thread obj_pool_magazine type##_pool_magazine;                      \
+                                                                               \
+  type *type##_pool_get(void) {                                                \
+    obj_pool_magazine *mag = &type##_pool_magazine;                            \
+    void *obj = mag->cur;                                                      \
+                                                                               \
+    if (obj) {                                                                 \
+      mag->cur = *(void **)obj;                                                \
+      mag->cur_count--;                                                        \
+    } else {                                                                   \
+      obj = obj_pool_get_slow(&type##_pool, mag);                              \
+      if (!obj)                                                                \
+        return NULL;                                                           \
+    }                                                                          \
+    if (type##_pool.ctor)                                                      \
+      type##_pool.ctor(obj);                                                   \
+    return (type *)obj;                                                        \
+  }                                                                            \
+                                                                               \
+  void type##_pool_put(type *obj) {                                            \
+    obj_pool_magazine *mag = &type##_pool_magazine;                            \
+                                                                               \
+    if (!obj)                                                                  \
+      return;                                                                  \
+    if (type##_pool.dtor)                                                      \
+      type##_pool.dtor(obj);                                                   \
+    if (!mag->pool || mag->cur_count >= OBJ_POOL_MAGAZINE_SIZE)                \
+      obj_pool_put_slow(&type##_pool, mag);                                    \
+    *(void **)obj = mag->cur;                                                  \
+    mag->cur = obj;                                                            \
+    mag->cur_count++;                                                          \
+  }
+
+/* 定义一个宏，用于生成不带构造和析构函数的对象池 */
+#define DEFINE_POOL(type) DEFINE_POOL_WITH_HOOKS(type, NULL, NULL)
+
+/**
+ * @brief 当前弹匣为空时取出一个对象，由 DEFINE_POOL 生成的函数调用
+ * @param pool 对象池指针
+ * @param mag 当前线程的弹匣
+ * @return 返回对象指针，内存不足返回 NULL
+ */
+void *obj_pool_get_slow(obj_pool *pool, obj_pool_magazine *mag);
+
+/**
+ * @brief 弹匣未注册或当前弹匣已满时腾出空间，由 DEFINE_POOL 生成的函数调用
+ * @param pool 对象池指针
+ * @param mag 当前线程的弹匣，返回后当前弹匣可再放入一个对象
+ */
+void obj_pool_put_slow(obj_pool *pool, obj_pool_magazine *mag);
+
+/**
+ * @brief 将当前线程所有弹匣中的对象归还到各自的仓库
+ */
+void obj_pool_thread_flush(void);
+
+#endif // !__OBJ_POOL_H_
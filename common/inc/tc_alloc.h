@@ -0,0 +1,99 @@
+/**
+ * @file tc_alloc.h
+ * @brief 线程缓存的小对象分配器头文件
+ *
+ * 小对象按尺寸类从 64 KB 对齐的 span 中切分，每个线程缓存若干空闲对象，
+ * 与中心仓库之间按批次交换，常见路径无需加锁。超过 TC_ALLOC_MAX_SIZE 的
+ * 对象直接通过 mmap 申请。
+ *
+ * 编译时定义 USE_TC_ALLOC 后，MALLOC_FUNC、MALLOC_ARRAY_FUNC、FREE_FUNC
+ * 及默认分配器均使用本分配器。
+ *
+ * @author moecly
+ */
+
+#ifndef __TC_ALLOC_H_
+#define __TC_ALLOC_H_
+
+#include "common.h"
+#include <stddef.h>
+
+#ifndef TC_ALLOC_SPAN_SIZE
+#define TC_ALLOC_SPAN_SIZE (64 * 1024)
+#endif // !TC_ALLOC_SPAN_SIZE
+
+/* span 头部预留的字节数，对象从该偏移处开始切分 */
+#define TC_ALLOC_SPAN_HEADER 64
+
+/* 小对象的最大字节数 */
+#define TC_ALLOC_MAX_SIZE 2048
+
+/* 尺寸类数量：16 字节步长到 256，之后每个 2 的幂区间 4 个尺寸类 */
+#define TC_ALLOC_CLASSES 28
+
+/**
+ * @brief 分配器统计信息
+ */
+typedef struct {
+  size_t span_bytes;   /* 小对象 span 占用的字节数 */
+  size_t spans;        /* 小对象 span 数量 */
+  size_t large_bytes;  /* 大对象占用的字节数 */
+  size_t large_objs;   /* 大对象数量 */
+  size_t depot_bytes;  /* 中心仓库中空闲对象的字节数 */
+  size_t thread_bytes; /* 当前线程缓存中空闲对象的字节数 */
+} tc_alloc_stats;
+
+/**
+ * @brief 申请内存，按 16 字节对齐
+ * @param size 字节数
+ * @return 返回内存指针，失败返回 NULL
+ */
+void *tc_malloc(size_t size);
+
+/**
+ * @brief 释放 tc_malloc() 系列函数申请的内存
+ * @param ptr 内存指针，可为 NULL
+ */
+void tc_free(void *ptr);
+
+/**
+ * @brief 调整内存大小，新大小仍属于同一尺寸类时原地返回
+ * @param ptr 原内存指针，可为 NULL
+ * @param size 新的字节数
+ * @return 返回新的内存指针，失败返回 NULL 且原内存不变
+ */
+void *tc_realloc(void *ptr, size_t size);
+
+/**
+ * @brief 按对齐要求申请内存，可用 tc_free() 释放
+ * @param align 对齐字节数，需为 2 的幂且不超过 TC_ALLOC_SPAN_SIZE / 2
+ * @param size 字节数
+ * @return 返回内存指针，失败返回 NULL
+ */
+void *tc_aligned_alloc(size_t align, size_t size);
+
+/**
+ * @brief 将当前线程缓存的空闲对象全部归还中心仓库，线程空闲前调用
+ *
+ * 线程退出时会自动归还。
+ */
+void tc_alloc_thread_trim(void);
+
+/**
+ * @brief 归还当前线程缓存，并将中心仓库中完全空闲的 span 释放给系统
+ */
+void tc_alloc_trim(void);
+
+/**
+ * @brief 获取分配器统计信息
+ * @param stats 存储统计信息的结构体指针
+ */
+void tc_alloc_get_stats(tc_alloc_stats *stats);
+
+/**
+ * @brief 获取以本分配器实现的分配器接口
+ * @return 返回分配器指针
+ */
+mem_allocator *tc_alloc_get_allocator(void);
+
+#endif // !__TC_ALLOC_H_
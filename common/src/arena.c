@@ -0,0 +1,290 @@
+/**
+ * @file arena.c
+ * @brief 区域（arena）分配器实现文件
+ * @author moecly
+ */
+
+#include "../inc/arena.h"
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief 在内存块中按对齐要求切分内存。
+ * @param chunk 内存块指针。
+ * @param align 对齐字节数。
+ * @param size 字节数。
+ * @return 返回内存指针，剩余空间不足返回 NULL。
+ */
+static void *arena_chunk_carve(arena_chunk *chunk, size_t align, size_t size) {
+  uintptr_t base = (uintptr_t)chunk->data;
+  uintptr_t ptr = base + chunk->used;
+  size_t offset;
+
+  ptr = (ptr + align - 1) & ~(uintptr_t)(align - 1);
+  offset = ptr - base;
+  if (offset > chunk->size || size > chunk->size - offset)
+    return NULL;
+
+  chunk->used = offset + size;
+  return (void *)ptr;
+}
+
+/**
+ * @brief 申请新的内存块并插入到当前内存块之后。
+ * @param a arena 指针。
+ * @param align 对齐字节数。
+ * @param size 需要容纳的字节数。
+ * @return 返回内存块指针，失败返回 NULL。
+ */
+static arena_chunk *arena_chunk_new(arena *a, size_t align, size_t size) {
+  arena_chunk *chunk;
+  size_t data_size = a->chunk_size;
+
+  if (size > SIZE_MAX - sizeof(arena_chunk) - align)
+    return NULL;
+  if (data_size < size + align)
+    data_size = size + align;
+
+  chunk = (arena_chunk *)mem_alloc(a->backing, sizeof(arena_chunk) + data_size);
+  if (!chunk)
+    return NULL;
+
+  chunk->size = data_size;
+  chunk->used = 0;
+  if (a->cur) {
+    chunk->next = a->cur->next;
+    a->cur->next = chunk;
+  } else {
+    chunk->next = a->first;
+    a->first = chunk;
+  }
+  return chunk;
+}
+
+/**
+ * @brief 分配器接口的申请函数。
+ * @param ctx arena 指针。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+static void *arena_allocator_alloc(void *ctx, size_t size) {
+  return arena_alloc((arena *)ctx, size);
+}
+
+/**
+ * @brief 分配器接口的调整大小函数。
+ * @param ctx arena 指针。
+ * @param ptr 原内存指针。
+ * @param size 新的字节数。
+ * @return 返回新的内存指针，失败返回 NULL。
+ */
+static void *arena_allocator_realloc(void *ctx, void *ptr, size_t size) {
+  return arena_realloc((arena *)ctx, ptr, size);
+}
+
+/**
+ * @brief 分配器接口的释放函数，arena 中的内存只能整体释放，故为空操作。
+ * @param ctx arena 指针。
+ * @param ptr 内存指针。
+ */
+static void arena_allocator_free(void *ctx, void *ptr) {
+  UNUSED(ctx);
+  UNUSED(ptr);
+}
+
+/**
+ * @brief 分配器接口的对齐申请函数。
+ * @param ctx arena 指针。
+ * @param align 对齐字节数。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+static void *arena_allocator_aligned_alloc(void *ctx, size_t align,
+                                           size_t size) {
+  return arena_aligned_alloc((arena *)ctx, align, size);
+}
+
+/**
+ * @brief 初始化 arena 分配器，首次申请内存时才申请内存块。
+ * @param a arena 指针。
+ * @param chunk_size 内存块数据区大小，为 0 时使用 ARENA_DEFAULT_CHUNK_SIZE。
+ * @param backing 底层分配器，为 NULL 时使用默认分配器。
+ */
+void arena_init(arena *a, size_t chunk_size, mem_allocator *backing) {
+  a->first = NULL;
+  a->cur = NULL;
+  a->last = NULL;
+  a->chunk_size = chunk_size ? chunk_size : ARENA_DEFAULT_CHUNK_SIZE;
+  a->backing = backing;
+  a->allocator.alloc = arena_allocator_alloc;
+  a->allocator.realloc = arena_allocator_realloc;
+  a->allocator.free = arena_allocator_free;
+  a->allocator.aligned_alloc = arena_allocator_aligned_alloc;
+  a->allocator.ctx = a;
+}
+
+/**
+ * @brief 释放 arena 的全部内存块。
+ * @param a arena 指针。
+ */
+void arena_destroy(arena *a) {
+  a->cur = NULL;
+  arena_trim(a);
+}
+
+/**
+ * @brief 从 arena 申请内存，按 ARENA_DEFAULT_ALIGN 对齐。
+ * @param a arena 指针。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+void *arena_alloc(arena *a, size_t size) {
+  return arena_aligned_alloc(a, ARENA_DEFAULT_ALIGN, size);
+}
+
+/**
+ * @brief 从 arena 按对齐要求申请内存。
+ * @param a arena 指针。
+ * @param align 对齐字节数，需为 2 的幂。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+void *arena_aligned_alloc(arena *a, size_t align, size_t size) {
+  arena_chunk *next;
+  void *ptr = NULL;
+
+  if (a->cur)
+    ptr = arena_chunk_carve(a->cur, align, size);
+
+  /* 当前内存块不足时先尝试复用下一个保留的内存块 */
+  if (!ptr) {
+    next = a->cur ? a->cur->next : a->first;
+    if (next) {
+      next->used = 0;
+      ptr = arena_chunk_carve(next, align, size);
+      if (ptr)
+        a->cur = next;
+    }
+  }
+
+  /* 保留的内存块放不下时申请新内存块，原有内存块留待之后复用 */
+  if (!ptr) {
+    next = arena_chunk_new(a, align, size);
+    if (!next)
+      return NULL;
+    a->cur = next;
+    ptr = arena_chunk_carve(next, align, size);
+  }
+
+  a->last = ptr;
+  return ptr;
+}
+
+/**
+ * @brief 调整 arena 中内存的大小，最近一次申请的内存在空间足够时原地扩展。
+ * @param a arena 指针。
+ * @param ptr 原内存指针，可为 NULL。
+ * @param size 新的字节数。
+ * @return 返回新的内存指针，失败返回 NULL 且原内存不变。
+ */
+void *arena_realloc(arena *a, void *ptr, size_t size) {
+  arena_chunk *chunk;
+  size_t offset;
+  size_t old_size = 0;
+  void *new_ptr;
+
+  if (!ptr)
+    return arena_alloc(a, size);
+
+  /* 最近一次申请的内存位于当前内存块末尾，可直接移动切分位置 */
+  if (ptr == a->last) {
+    offset = (size_t)((char *)ptr - a->cur->data);
+    if (size <= a->cur->size - offset) {
+      a->cur->used = offset + size;
+      return ptr;
+    }
+    old_size = a->cur->used - offset;
+  } else {
+    /* 原大小未知，以所在内存块已使用区域的末尾为上界 */
+    for (chunk = a->first; chunk; chunk = chunk->next) {
+      if ((char *)ptr >= chunk->data &&
+          (char *)ptr < chunk->data + chunk->used) {
+        old_size = chunk->used - (size_t)((char *)ptr - chunk->data);
+        break;
+      }
+      if (chunk == a->cur)
+        break;
+    }
+  }
+
+  new_ptr = arena_alloc(a, size);
+  if (!new_ptr)
+    return NULL;
+  memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+  return new_ptr;
+}
+
+/**
+ * @brief 记录 arena 当前状态。
+ * @param a arena 指针。
+ * @return 返回保存点。
+ */
+arena_savepoint arena_save(arena *a) {
+  arena_savepoint sp;
+
+  sp.chunk = a->cur;
+  sp.used = a->cur ? a->cur->used : 0;
+  return sp;
+}
+
+/**
+ * @brief 回滚到保存点，释放保存点之后申请的全部内存，内存块保留复用。
+ * @param a arena 指针。
+ * @param sp 保存点，需晚于最近一次重置。
+ */
+void arena_rollback(arena *a, arena_savepoint sp) {
+  a->cur = sp.chunk;
+  if (a->cur)
+    a->cur->used = sp.used;
+  a->last = NULL;
+}
+
+/**
+ * @brief 以 O(1) 时间释放 arena 中申请的全部内存，内存块保留复用。
+ * @param a arena 指针。
+ */
+void arena_reset(arena *a) {
+  a->cur = NULL;
+  a->last = NULL;
+}
+
+/**
+ * @brief 释放 arena 中当前未使用的内存块。
+ * @param a arena 指针。
+ */
+void arena_trim(arena *a) {
+  arena_chunk *chunk;
+  arena_chunk *tmp;
+
+  if (a->cur) {
+    chunk = a->cur->next;
+    a->cur->next = NULL;
+  } else {
+    chunk = a->first;
+    a->first = NULL;
+    a->last = NULL;
+  }
+
+  while (chunk) {
+    tmp = chunk->next;
+    mem_free(a->backing, chunk);
+    chunk = tmp;
+  }
+}
+
+/**
+ * @brief 获取 arena 的分配器接口，可传给各模块的 *_with_allocator 函数。
+ * @param a arena 指针。
+ * @return 返回分配器指针，生命周期与 arena 相同。
+ */
+mem_allocator *arena_get_allocator(arena *a) { return &a->allocator; }
@@ -5,6 +5,88 @@
  */
 
 #include "../inc/common.h"
+#include <stdlib.h>
+
+#ifdef USE_TC_ALLOC
+#include "../inc/tc_alloc.h"
+#endif
+
+#ifdef USE_MEM_STATS
+#include "../inc/mem_stats.h"
+/* 本文件提供同名函数，供未开启统计的代码链接 */
+#undef mem_alloc
+#undef mem_realloc
+#undef mem_aligned_alloc
+#endif
+
+/**
+ * @brief 默认分配器的申请函数。
+ * @param ctx 分配器上下文，未使用。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+static void *default_alloc(void *ctx, size_t size) {
+  UNUSED(ctx);
+  return MALLOC_ARRAY_FUNC(char, size);
+}
+
+/**
+ * @brief 默认分配器的调整大小函数。
+ * @param ctx 分配器上下文，未使用。
+ * @param ptr 原内存指针。
+ * @param size 新的字节数。
+ * @return 返回新的内存指针，失败返回 NULL。
+ */
+static void *default_realloc(void *ctx, void *ptr, size_t size) {
+  UNUSED(ctx);
+#if defined(USE_MEM_STATS)
+  return mem_stats_realloc(ptr, size, MEM_STATS_SITE());
+#elif defined(USE_TC_ALLOC)
+  return tc_realloc(ptr, size);
+#else
+  return realloc(ptr, size);
+#endif
+}
+
+/**
+ * @brief 默认分配器的释放函数。
+ * @param ctx 分配器上下文，未使用。
+ * @param ptr 内存指针。
+ */
+static void default_free(void *ctx, void *ptr) {
+  UNUSED(ctx);
+  FREE_FUNC(ptr);
+}
+
+/**
+ * @brief 默认分配器的对齐申请函数。
+ * @param ctx 分配器上下文，未使用。
+ * @param align 对齐字节数。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+static void *default_aligned_alloc(void *ctx, size_t align, size_t size) {
+  void *ptr;
+
+  UNUSED(ctx);
+#if defined(USE_MEM_STATS)
+  UNUSED(ptr);
+  return mem_stats_aligned_alloc(align, size, MEM_STATS_SITE());
+#elif defined(USE_TC_ALLOC)
+  UNUSED(ptr);
+  return tc_aligned_alloc(align, size);
+#else
+  if (align < sizeof(void *))
+    align = sizeof(void *);
+  if (posix_memalign(&ptr, align, size))
+    return NULL;
+  return ptr;
+#endif
+}
+
+static mem_allocator default_allocator = {
+    default_alloc, default_realloc, default_free, default_aligned_alloc, NULL,
+};
 
 /**
  * @brief 验证指针是否有效。
@@ -16,3 +98,106 @@ ret_val validate_pointer(void *ptr) {
     return ret_null_pointer;
   return ret_ok;
 }
+
+/**
+ * @brief 获取默认分配器，基于 MALLOC_ARRAY_FUNC 和 FREE_FUNC 宏。
+ * @return 返回默认分配器指针。
+ */
+mem_allocator *mem_allocator_default(void) { return &default_allocator; }
+
+/**
+ * @brief 通过分配器申请内存。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+void *mem_alloc(mem_allocator *allocator, size_t size) {
+  if (!allocator)
+    allocator = &default_allocator;
+  return allocator->alloc(allocator->ctx, size);
+}
+
+/**
+ * @brief 通过分配器调整内存大小。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param ptr 原内存指针，可为 NULL。
+ * @param size 新的字节数。
+ * @return 返回新的内存指针，失败返回 NULL 且原内存不变。
+ */
+void *mem_realloc(mem_allocator *allocator, void *ptr, size_t size) {
+  if (!allocator)
+    allocator = &default_allocator;
+  return allocator->realloc(allocator->ctx, ptr, size);
+}
+
+/**
+ * @brief 通过分配器释放内存。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param ptr 内存指针，可为 NULL。
+ */
+void mem_free(mem_allocator *allocator, void *ptr) {
+  if (!ptr)
+    return;
+  if (!allocator)
+    allocator = &default_allocator;
+  allocator->free(allocator->ctx, ptr);
+}
+
+/**
+ * @brief 通过分配器按对齐要求申请内存，可用 mem_free() 释放。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param align 对齐字节数，需为 2 的幂。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+void *mem_aligned_alloc(mem_allocator *allocator, size_t align, size_t size) {
+  if (!allocator)
+    allocator = &default_allocator;
+  return allocator->aligned_alloc(allocator->ctx, align, size);
+}
+
+#ifdef USE_MEM_STATS
+/**
+ * @brief 通过分配器申请内存，使用默认分配器时按调用处统计。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param size 字节数。
+ * @param site 调用处信息。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+void *mem_alloc_site(mem_allocator *allocator, size_t size,
+                     mem_stats_site *site) {
+  if (!allocator)
+    return mem_stats_alloc(size, site);
+  return allocator->alloc(allocator->ctx, size);
+}
+
+/**
+ * @brief 通过分配器调整内存大小，使用默认分配器时按调用处统计。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param ptr 原内存指针，可为 NULL。
+ * @param size 新的字节数。
+ * @param site 调用处信息。
+ * @return 返回新的内存指针，失败返回 NULL 且原内存不变。
+ */
+void *mem_realloc_site(mem_allocator *allocator, void *ptr, size_t size,
+                       mem_stats_site *site) {
+  if (!allocator)
+    return mem_stats_realloc(ptr, size, site);
+  return allocator->realloc(allocator->ctx, ptr, size);
+}
+
+/**
+ * @brief 通过分配器按对齐要求申请内存，使用默认分配器时按调用处统计。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param align 对齐字节数，需为 2 的幂。
+ * @param size 字节数。
+ * @param site 调用处信息。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+void *mem_aligned_alloc_site(mem_allocator *allocator, size_t align,
+                             size_t size, mem_stats_site *site) {
+  if (!allocator)
+    return mem_stats_aligned_alloc(align, size, site);
+  return allocator->aligned_alloc(allocator->ctx, align, size);
+}
+#endif // USE_MEM_STATS
@@ -0,0 +1,245 @@
+/**
+ * @file cpu_features.c
+ * @brief CPU 指令集特性检测及运行时分派实现文件
+ * @author moecly
+ */
+
+#include "../inc/cpu_features.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define CPU_FEATURES_X86
+#elif defined(__aarch64__) || defined(__arm__)
+#include <sys/auxv.h>
+#define CPU_FEATURES_ARM
+#endif
+
+/* 检测结果中表示已完成检测的位 */
+#define CPU_FEATURES_DETECTED (UINT64_C(1) << 63)
+
+static uint64_t detected_features;
+static uint64_t disabled_features;
+
+#ifdef CPU_FEATURES_X86
+/* XCR0 中 SSE、AVX 及 AVX-512 寄存器状态位 */
+#define CPU_XCR0_SSE (1U << 1)
+#define CPU_XCR0_AVX (1U << 2)
+#define CPU_XCR0_AVX512 (7U << 5)
+
+/* 较旧的 cpuid.h 未定义该位 */
+#ifndef bit_ERMS
+#define bit_ERMS (1 << 9)
+#endif // !bit_ERMS
+
+/**
+ * @brief 读取 XCR0，判断操作系统是否保存扩展寄存器状态。
+ * @return 返回 XCR0 的低 32 位。
+ */
+static uint32_t cpu_read_xcr0(void) {
+  uint32_t eax;
+  uint32_t edx;
+
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return eax;
+}
+
+/**
+ * @brief 通过 CPUID 检测 x86 特性。
+ * @return 返回 CPU_FEATURE_* 的组合。
+ */
+static uint64_t cpu_detect(void) {
+  uint64_t f = 0;
+  uint32_t eax, ebx, ecx, edx;
+  uint32_t max_leaf;
+  uint32_t xcr0 = 0;
+  int os_avx;
+  int os_avx512;
+
+  max_leaf = __get_cpuid_max(0, NULL);
+  if (max_leaf < 1)
+    return 0;
+
+  __cpuid(1, eax, ebx, ecx, edx);
+  if (edx & bit_SSE2)
+    f |= CPU_FEATURE_SSE2;
+  if (ecx & bit_SSE3)
+    f |= CPU_FEATURE_SSE3;
+  if (ecx & bit_SSSE3)
+    f |= CPU_FEATURE_SSSE3;
+  if (ecx & bit_SSE4_1)
+    f |= CPU_FEATURE_SSE41;
+  if (ecx & bit_SSE4_2)
+    f |= CPU_FEATURE_SSE42;
+  if (ecx & bit_POPCNT)
+    f |= CPU_FEATURE_POPCNT;
+  if (ecx & bit_PCLMUL)
+    f |= CPU_FEATURE_PCLMUL;
+  if (ecx & bit_AES)
+    f |= CPU_FEATURE_AESNI;
+
+  /* CPU 支持 AVX 但操作系统未开启 YMM 状态保存时不能使用 */
+  if (ecx & bit_OSXSAVE)
+    xcr0 = cpu_read_xcr0();
+  os_avx = (xcr0 & (CPU_XCR0_SSE | CPU_XCR0_AVX)) ==
+           (CPU_XCR0_SSE | CPU_XCR0_AVX);
+  os_avx512 = os_avx && (xcr0 & CPU_XCR0_AVX512) == CPU_XCR0_AVX512;
+
+  if (os_avx && (ecx & bit_AVX)) {
+    f |= CPU_FEATURE_AVX;
+    if (ecx & bit_FMA)
+      f |= CPU_FEATURE_FMA;
+  }
+
+  if (max_leaf < 7)
+    return f;
+
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  if (ebx & bit_BMI)
+    f |= CPU_FEATURE_BMI1;
+  if (ebx & bit_BMI2)
+    f |= CPU_FEATURE_BMI2;
+  if (ebx & bit_ERMS)
+    f |= CPU_FEATURE_ERMS;
+  if (ebx & bit_SHA)
+    f |= CPU_FEATURE_SHA;
+  if (os_avx && (ebx & bit_AVX2))
+    f |= CPU_FEATURE_AVX2;
+  if (os_avx512 && (ebx & bit_AVX512F)) {
+    f |= CPU_FEATURE_AVX512F;
+    if (ebx & bit_AVX512DQ)
+      f |= CPU_FEATURE_AVX512DQ;
+    if (ebx & bit_AVX512CD)
+      f |= CPU_FEATURE_AVX512CD;
+    if (ebx & bit_AVX512BW)
+      f |= CPU_FEATURE_AVX512BW;
+    if (ebx & bit_AVX512VL)
+      f |= CPU_FEATURE_AVX512VL;
+    if (ecx & bit_AVX512VBMI)
+      f |= CPU_FEATURE_AVX512VBMI;
+  }
+  return f;
+}
+#elif defined(CPU_FEATURES_ARM)
+/**
+ * @brief 通过内核提供的 hwcap 检测 ARM 特性。
+ * @return 返回 CPU_FEATURE_* 的组合。
+ */
+static uint64_t cpu_detect(void) {
+  uint64_t f = 0;
+  unsigned long hwcap = getauxval(AT_HWCAP);
+
+#ifdef __aarch64__
+  unsigned long hwcap2 = getauxval(AT_HWCAP2);
+
+  /* 位定义见内核 arch/arm64/include/uapi/asm/hwcap.h */
+  if (hwcap & (1UL << 1))
+    f |= CPU_FEATURE_NEON;
+  if (hwcap & (1UL << 3))
+    f |= CPU_FEATURE_ARM_AES;
+  if (hwcap & (1UL << 4))
+    f |= CPU_FEATURE_ARM_PMULL;
+  if (hwcap & (1UL << 5))
+    f |= CPU_FEATURE_ARM_SHA1;
+  if (hwcap & (1UL << 6))
+    f |= CPU_FEATURE_ARM_SHA2;
+  if (hwcap & (1UL << 7))
+    f |= CPU_FEATURE_ARM_CRC32;
+  if (hwcap & (1UL << 22))
+    f |= CPU_FEATURE_SVE;
+  if (hwcap2 & (1UL << 1))
+    f |= CPU_FEATURE_SVE2;
+#else
+  unsigned long hwcap2 = getauxval(AT_HWCAP2);
+
+  /* 位定义见内核 arch/arm/include/uapi/asm/hwcap.h */
+  if (hwcap & (1UL << 12))
+    f |= CPU_FEATURE_NEON;
+  if (hwcap2 & (1UL << 0))
+    f |= CPU_FEATURE_ARM_AES;
+  if (hwcap2 & (1UL << 1))
+    f |= CPU_FEATURE_ARM_PMULL;
+  if (hwcap2 & (1UL << 2))
+    f |= CPU_FEATURE_ARM_SHA1;
+  if (hwcap2 & (1UL << 3))
+    f |= CPU_FEATURE_ARM_SHA2;
+  if (hwcap2 & (1UL << 4))
+    f |= CPU_FEATURE_ARM_CRC32;
+#endif
+  return f;
+}
+#else
+/**
+ * @brief 未支持的架构不报告任何特性，只使用通用实现。
+ * @return 返回 0。
+ */
+static uint64_t cpu_detect(void) { return 0; }
+#endif
+
+/**
+ * @brief 获取当前 CPU 支持的特性，首次调用时检测。
+ * @return 返回 CPU_FEATURE_* 的组合，已去除 cpu_features_disable() 屏蔽的特性。
+ */
+uint64_t cpu_features_get(void) {
+  uint64_t f = __atomic_load_n(&detected_features, __ATOMIC_RELAXED);
+
+  if (!f) {
+    f = cpu_detect() | CPU_FEATURES_DETECTED;
+    __atomic_store_n(&detected_features, f, __ATOMIC_RELAXED);
+  }
+  return f & ~CPU_FEATURES_DETECTED &
+         ~__atomic_load_n(&disabled_features, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 判断当前 CPU 是否支持全部指定特性。
+ * @param features CPU_FEATURE_* 的组合。
+ * @return 全部支持返回 1，否则返回 0。
+ */
+int cpu_features_has(uint64_t features) {
+  return (cpu_features_get() & features) == features;
+}
+
+/**
+ * @brief 屏蔽指定特性。
+ * @param features 需要屏蔽的 CPU_FEATURE_* 组合。
+ */
+void cpu_features_disable(uint64_t features) {
+  __atomic_or_fetch(&disabled_features, features, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 按顺序选出第一个 CPU 支持的实现。
+ * @param entries 分派表，按优先级从高到低排列。
+ * @param n 表项数。
+ * @return 返回选中的实现，均不支持返回 NULL。
+ */
+const void *cpu_dispatch_select(const cpu_dispatch_entry *entries, size_t n) {
+  uint64_t f = cpu_features_get();
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    if ((f & entries[i].required) == entries[i].required)
+      return entries[i].impl;
+  }
+  return NULL;
+}
+
+/**
+ * @brief 从缓存中获取实现，缓存为空时选择并保存。
+ * @param cache 缓存位置。
+ * @param entries 分派表。
+ * @param n 表项数。
+ * @return 返回选中的实现，均不支持返回 NULL。
+ */
+const void *cpu_dispatch_resolve(const void **cache,
+                                 const cpu_dispatch_entry *entries, size_t n) {
+  const void *impl = __atomic_load_n(cache, __ATOMIC_ACQUIRE);
+
+  if (impl)
+    return impl;
+
+  impl = cpu_dispatch_select(entries, n);
+  if (impl)
+    __atomic_store_n(cache, impl, __ATOMIC_RELEASE);
+  return impl;
+}
@@ -0,0 +1,1023 @@
+/**
+ * @file fast_hash.c
+ * @brief 非加密哈希实现文件
+ * @author moecly
+ */
+
+#include "../inc/fast_hash.h"
+#include "../inc/common.h"
+#include "../inc/cpu_features.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FAST_HASH_X86
+#endif
+
+#define FAST_HASH_PRIME32_1 0x9E3779B1U
+#define FAST_HASH_PRIME32_2 0x85EBCA77U
+#define FAST_HASH_PRIME32_3 0xC2B2AE3DU
+#define FAST_HASH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define FAST_HASH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define FAST_HASH_PRIME64_3 0x165667B19E3779F9ULL
+#define FAST_HASH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define FAST_HASH_PRIME64_5 0x27D4EB2F165667C5ULL
+#define FAST_HASH_PRIME_MX1 0x165667919E3779F9ULL
+#define FAST_HASH_PRIME_MX2 0x9FB21C651E98DF25ULL
+
+/* 每个条带的字节数，以及每个条带消耗的密钥字节数 */
+#define FAST_HASH_STRIPE_LEN 64
+#define FAST_HASH_SECRET_CONSUME 8
+
+/* 每块的条带数，每块结束时打乱一次累加器 */
+#define FAST_HASH_SECRET_LIMIT (FAST_HASH_SECRET_SIZE - FAST_HASH_STRIPE_LEN)
+#define FAST_HASH_BLOCK_STRIPES                                                \
+  (FAST_HASH_SECRET_LIMIT / FAST_HASH_SECRET_CONSUME)
+
+/* 不超过该长度的输入不使用累加器 */
+#define FAST_HASH_MIDSIZE_MAX 240
+#define FAST_HASH_SECRET_SIZE_MIN 136
+
+/* 各阶段读取密钥的起始偏移 */
+#define FAST_HASH_MIDSIZE_STARTOFFSET 3
+#define FAST_HASH_MIDSIZE_LASTOFFSET 17
+#define FAST_HASH_LASTACC_START 7
+#define FAST_HASH_MERGEACCS_START 11
+
+/**
+ * @brief 长输入的累加函数，处理 stripes 个连续条带
+ */
+typedef void (*fast_hash_acc_func)(uint64_t *acc, const unsigned char *input,
+                                   const unsigned char *secret, size_t stripes);
+
+/**
+ * @brief 长输入的打乱函数，每块结束时调用
+ */
+typedef void (*fast_hash_scramble_func)(uint64_t *acc,
+                                        const unsigned char *secret);
+
+/**
+ * @brief 按指令集实现的长输入函数表
+ */
+typedef struct {
+  fast_hash_acc_func accumulate;    /* 累加 */
+  fast_hash_scramble_func scramble; /* 打乱 */
+} fast_hash_kernels;
+
+/* 默认密钥 */
+static const unsigned char fast_hash_secret[FAST_HASH_SECRET_SIZE]
+    __attribute__((aligned(64))) = {
+        0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c,
+        0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+        0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e,
+        0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+        0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6,
+        0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+        0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+        0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+        0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7,
+        0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+        0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83,
+        0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+        0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26,
+        0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+        0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f,
+        0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+/**
+ * @brief 按小端序读取 64 位整数。
+ */
+static inline uint64_t fast_hash_read64(const unsigned char *p) {
+  uint64_t v;
+
+  memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  return v;
+}
+
+/**
+ * @brief 按小端序读取 32 位整数。
+ */
+static inline uint32_t fast_hash_read32(const unsigned char *p) {
+  uint32_t v;
+
+  memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap32(v);
+#endif
+  return v;
+}
+
+/**
+ * @brief 按小端序写入 64 位整数。
+ */
+static inline void fast_hash_write64(unsigned char *p, uint64_t v) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  memcpy(p, &v, sizeof(v));
+}
+
+/**
+ * @brief 64 位乘法，返回 128 位结果。
+ */
+static inline fast_hash128_val fast_hash_mul128(uint64_t a, uint64_t b) {
+  fast_hash128_val r;
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 p = (unsigned __int128)a * b;
+
+  r.low = (uint64_t)p;
+  r.high = (uint64_t)(p >> 64);
+#else
+  uint64_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+  uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+  uint64_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+  uint64_t hi_hi = (a >> 32) * (b >> 32);
+  uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+
+  r.high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  r.low = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+#endif
+  return r;
+}
+
+/**
+ * @brief 64 位乘法，返回 128 位结果的高低两半异或。
+ */
+static inline uint64_t fast_hash_mul_fold64(uint64_t a, uint64_t b) {
+  fast_hash128_val r = fast_hash_mul128(a, b);
+  return r.low ^ r.high;
+}
+
+static inline uint64_t fast_hash_xorshift64(uint64_t v, int shift) {
+  return v ^ (v >> shift);
+}
+
+static inline uint64_t fast_hash_rotl64(uint64_t v, int r) {
+  return (v << r) | (v >> (64 - r));
+}
+
+static inline uint32_t fast_hash_rotl32(uint32_t v, int r) {
+  return (v << r) | (v >> (32 - r));
+}
+
+/**
+ * @brief 短输入和累加器合并后的最终混合。
+ */
+static uint64_t fast_hash_avalanche(uint64_t h) {
+  h = fast_hash_xorshift64(h, 37);
+  h *= FAST_HASH_PRIME_MX1;
+  return fast_hash_xorshift64(h, 32);
+}
+
+/**
+ * @brief 极短输入使用的强混合。
+ */
+static uint64_t fast_hash_avalanche_strong(uint64_t h) {
+  h ^= h >> 33;
+  h *= FAST_HASH_PRIME64_2;
+  h ^= h >> 29;
+  h *= FAST_HASH_PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+/**
+ * @brief 4 到 8 字节输入使用的混合。
+ */
+static uint64_t fast_hash_rrmxmx(uint64_t h, uint64_t len) {
+  h ^= fast_hash_rotl64(h, 49) ^ fast_hash_rotl64(h, 24);
+  h *= FAST_HASH_PRIME_MX2;
+  h ^= (h >> 35) + len;
+  h *= FAST_HASH_PRIME_MX2;
+  return fast_hash_xorshift64(h, 28);
+}
+
+/**
+ * @brief 混合 16 字节输入。
+ */
+static inline uint64_t fast_hash_mix16(const unsigned char *in,
+                                       const unsigned char *secret,
+                                       uint64_t seed) {
+  return fast_hash_mul_fold64(
+      fast_hash_read64(in) ^ (fast_hash_read64(secret) + seed),
+      fast_hash_read64(in + 8) ^ (fast_hash_read64(secret + 8) - seed));
+}
+
+/**
+ * @brief 计算不超过 16 字节输入的 64 位哈希值。
+ */
+static uint64_t fast_hash_len_0to16_64(const unsigned char *in, size_t len,
+                                       const unsigned char *secret,
+                                       uint64_t seed) {
+  if (len > 8) {
+    uint64_t flip1 =
+        (fast_hash_read64(secret + 24) ^ fast_hash_read64(secret + 32)) + seed;
+    uint64_t flip2 =
+        (fast_hash_read64(secret + 40) ^ fast_hash_read64(secret + 48)) - seed;
+    uint64_t lo = fast_hash_read64(in) ^ flip1;
+    uint64_t hi = fast_hash_read64(in + len - 8) ^ flip2;
+
+    return fast_hash_avalanche(len + __builtin_bswap64(lo) + hi +
+                               fast_hash_mul_fold64(lo, hi));
+  }
+
+  if (len >= 4) {
+    uint64_t s = seed ^ ((uint64_t)__builtin_bswap32((uint32_t)seed) << 32);
+    uint64_t flip =
+        (fast_hash_read64(secret + 8) ^ fast_hash_read64(secret + 16)) - s;
+    uint64_t in64 = fast_hash_read32(in + len - 4) +
+                    ((uint64_t)fast_hash_read32(in) << 32);
+
+    return fast_hash_rrmxmx(in64 ^ flip, len);
+  }
+
+  if (len) {
+    uint32_t combined = ((uint32_t)in[0] << 16) |
+                        ((uint32_t)in[len >> 1] << 24) |
+                        ((uint32_t)in[len - 1]) | ((uint32_t)len << 8);
+    uint64_t flip =
+        (fast_hash_read32(secret) ^ fast_hash_read32(secret + 4)) + seed;
+
+    return fast_hash_avalanche_strong((uint64_t)combined ^ flip);
+  }
+
+  return fast_hash_avalanche_strong(
+      seed ^ (fast_hash_read64(secret + 56) ^ fast_hash_read64(secret + 64)));
+}
+
+/**
+ * @brief 计算 17 到 128 字节输入的 64 位哈希值。
+ */
+static uint64_t fast_hash_len_17to128_64(const unsigned char *in, size_t len,
+                                         const unsigned char *secret,
+                                         uint64_t seed) {
+  uint64_t acc = len * FAST_HASH_PRIME64_1;
+
+  if (len > 32) {
+    if (len > 64) {
+      if (len > 96) {
+        acc += fast_hash_mix16(in + 48, secret + 96, seed);
+        acc += fast_hash_mix16(in + len - 64, secret + 112, seed);
+      }
+      acc += fast_hash_mix16(in + 32, secret + 64, seed);
+      acc += fast_hash_mix16(in + len - 48, secret + 80, seed);
+    }
+    acc += fast_hash_mix16(in + 16, secret + 32, seed);
+    acc += fast_hash_mix16(in + len - 32, secret + 48, seed);
+  }
+  acc += fast_hash_mix16(in, secret, seed);
+  acc += fast_hash_mix16(in + len - 16, secret + 16, seed);
+  return fast_hash_avalanche(acc);
+}
+
+/**
+ * @brief 计算 129 到 240 字节输入的 64 位哈希值。
+ */
+static uint64_t fast_hash_len_129to240_64(const unsigned char *in, size_t len,
+                                          const unsigned char *secret,
+                                          uint64_t seed) {
+  uint64_t acc = len * FAST_HASH_PRIME64_1;
+  uint64_t acc_end;
+  unsigned int rounds = (unsigned int)len / 16;
+  unsigned int i;
+
+  for (i = 0; i < 8; i++)
+    acc += fast_hash_mix16(in + 16 * i, secret + 16 * i, seed);
+  acc_end = fast_hash_mix16(in + len - 16,
+                            secret + FAST_HASH_SECRET_SIZE_MIN -
+                                FAST_HASH_MIDSIZE_LASTOFFSET,
+                            seed);
+  acc = fast_hash_avalanche(acc);
+  for (i = 8; i < rounds; i++)
+    acc_end += fast_hash_mix16(in + 16 * i,
+                               secret + 16 * (i - 8) +
+                                   FAST_HASH_MIDSIZE_STARTOFFSET,
+                               seed);
+  return fast_hash_avalanche(acc + acc_end);
+}
+
+/**
+ * @brief 标量累加实现。
+ */
+static void fast_hash_accumulate_scalar(uint64_t *acc,
+                                        const unsigned char *input,
+                                        const unsigned char *secret,
+                                        size_t stripes) {
+  const unsigned char *in;
+  const unsigned char *sec;
+  uint64_t data;
+  uint64_t key;
+  size_t n;
+  int i;
+
+  for (n = 0; n < stripes; n++) {
+    in = input + n * FAST_HASH_STRIPE_LEN;
+    sec = secret + n * FAST_HASH_SECRET_CONSUME;
+    for (i = 0; i < 8; i++) {
+      data = fast_hash_read64(in + 8 * i);
+      key = data ^ fast_hash_read64(sec + 8 * i);
+      acc[i ^ 1] += data;
+      acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+    }
+  }
+}
+
+/**
+ * @brief 标量打乱实现。
+ */
+static void fast_hash_scramble_scalar(uint64_t *acc,
+                                      const unsigned char *secret) {
+  int i;
+
+  for (i = 0; i < 8; i++) {
+    acc[i] = fast_hash_xorshift64(acc[i], 47) ^ fast_hash_read64(secret + 8 * i);
+    acc[i] *= FAST_HASH_PRIME32_1;
+  }
+}
+
+#ifdef FAST_HASH_X86
+/**
+ * @brief SSE2 累加实现。
+ */
+__attribute__((target("sse2"))) static void
+fast_hash_accumulate_sse2(uint64_t *acc, const unsigned char *input,
+                          const unsigned char *secret, size_t stripes) {
+  __m128i a[4];
+  __m128i data;
+  __m128i key;
+  size_t n;
+  int i;
+
+  for (i = 0; i < 4; i++)
+    a[i] = _mm_loadu_si128((const __m128i *)(acc + 2 * i));
+
+  for (n = 0; n < stripes; n++) {
+    for (i = 0; i < 4; i++) {
+      data = _mm_loadu_si128(
+          (const __m128i *)(input + n * FAST_HASH_STRIPE_LEN + 16 * i));
+      key = _mm_xor_si128(
+          data, _mm_loadu_si128((const __m128i *)(secret +
+                                                  n * FAST_HASH_SECRET_CONSUME +
+                                                  16 * i)));
+      a[i] = _mm_add_epi64(
+          a[i], _mm_add_epi64(
+                    _mm_mul_epu32(key, _mm_srli_epi64(key, 32)),
+                    _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+  }
+
+  for (i = 0; i < 4; i++)
+    _mm_storeu_si128((__m128i *)(acc + 2 * i), a[i]);
+}
+
+/**
+ * @brief SSE2 打乱实现。
+ */
+__attribute__((target("sse2"))) static void
+fast_hash_scramble_sse2(uint64_t *acc, const unsigned char *secret) {
+  const __m128i prime = _mm_set1_epi32((int)FAST_HASH_PRIME32_1);
+  __m128i a;
+  __m128i key;
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    a = _mm_loadu_si128((const __m128i *)(acc + 2 * i));
+    a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+    key = _mm_xor_si128(
+        a, _mm_loadu_si128((const __m128i *)(secret + 16 * i)));
+    a = _mm_add_epi64(
+        _mm_mul_epu32(key, prime),
+        _mm_slli_epi64(
+            _mm_mul_epu32(_mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)),
+                          prime),
+            32));
+    _mm_storeu_si128((__m128i *)(acc + 2 * i), a);
+  }
+}
+
+/**
+ * @brief AVX2 累加实现。
+ */
+__attribute__((target("avx2"))) static void
+fast_hash_accumulate_avx2(uint64_t *acc, const unsigned char *input,
+                          const unsigned char *secret, size_t stripes) {
+  __m256i a[2];
+  __m256i data;
+  __m256i key;
+  size_t n;
+  int i;
+
+  for (i = 0; i < 2; i++)
+    a[i] = _mm256_loadu_si256((const __m256i *)(acc + 4 * i));
+
+  for (n = 0; n < stripes; n++) {
+    for (i = 0; i < 2; i++) {
+      data = _mm256_loadu_si256(
+          (const __m256i *)(input + n * FAST_HASH_STRIPE_LEN + 32 * i));
+      key = _mm256_xor_si256(
+          data,
+          _mm256_loadu_si256((const __m256i *)(secret +
+                                               n * FAST_HASH_SECRET_CONSUME +
+                                               32 * i)));
+      a[i] = _mm256_add_epi64(
+          a[i],
+          _mm256_add_epi64(
+              _mm256_mul_epu32(key, _mm256_srli_epi64(key, 32)),
+              _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+  }
+
+  for (i = 0; i < 2; i++)
+    _mm256_storeu_si256((__m256i *)(acc + 4 * i), a[i]);
+}
+
+/**
+ * @brief AVX2 打乱实现。
+ */
+__attribute__((target("avx2"))) static void
+fast_hash_scramble_avx2(uint64_t *acc, const unsigned char *secret) {
+  const __m256i prime = _mm256_set1_epi32((int)FAST_HASH_PRIME32_1);
+  __m256i a;
+  __m256i key;
+  int i;
+
+  for (i = 0; i < 2; i++) {
+    a = _mm256_loadu_si256((const __m256i *)(acc + 4 * i));
+    a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+    key = _mm256_xor_si256(
+        a, _mm256_loadu_si256((const __m256i *)(secret + 32 * i)));
+    a = _mm256_add_epi64(
+        _mm256_mul_epu32(key, prime),
+        _mm256_slli_epi64(
+            _mm256_mul_epu32(_mm256_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)),
+                             prime),
+            32));
+    _mm256_storeu_si256((__m256i *)(acc + 4 * i), a);
+  }
+}
+
+/**
+ * @brief AVX-512 累加实现。
+ */
+__attribute__((target("avx512f"))) static void
+fast_hash_accumulate_avx512(uint64_t *acc, const unsigned char *input,
+                            const unsigned char *secret, size_t stripes) {
+  __m512i a = _mm512_loadu_si512(acc);
+  __m512i data;
+  __m512i key;
+  size_t n;
+
+  for (n = 0; n < stripes; n++) {
+    data = _mm512_loadu_si512(input + n * FAST_HASH_STRIPE_LEN);
+    key = _mm512_xor_si512(
+        data, _mm512_loadu_si512(secret + n * FAST_HASH_SECRET_CONSUME));
+    a = _mm512_add_epi64(
+        a, _mm512_add_epi64(
+               _mm512_mul_epu32(key, _mm512_srli_epi64(key, 32)),
+               _mm512_shuffle_epi32(data,
+                                    (_MM_PERM_ENUM)_MM_SHUFFLE(1, 0, 3, 2))));
+  }
+  _mm512_storeu_si512(acc, a);
+}
+
+/**
+ * @brief AVX-512 打乱实现。
+ */
+__attribute__((target("avx512f"))) static void
+fast_hash_scramble_avx512(uint64_t *acc, const unsigned char *secret) {
+  const __m512i prime = _mm512_set1_epi32((int)FAST_HASH_PRIME32_1);
+  __m512i a = _mm512_loadu_si512(acc);
+  __m512i key;
+
+  a = _mm512_xor_si512(a, _mm512_srli_epi64(a, 47));
+  key = _mm512_xor_si512(a, _mm512_loadu_si512(secret));
+  a = _mm512_add_epi64(
+      _mm512_mul_epu32(key, prime),
+      _mm512_slli_epi64(
+          _mm512_mul_epu32(
+              _mm512_shuffle_epi32(key, (_MM_PERM_ENUM)_MM_SHUFFLE(0, 3, 0, 1)),
+              prime),
+          32));
+  _mm512_storeu_si512(acc, a);
+}
+#endif // FAST_HASH_X86
+
+static const fast_hash_kernels fast_hash_kernels_scalar = {
+    fast_hash_accumulate_scalar, fast_hash_scramble_scalar};
+
+#ifdef FAST_HASH_X86
+static const fast_hash_kernels fast_hash_kernels_sse2 = {
+    fast_hash_accumulate_sse2, fast_hash_scramble_sse2};
+static const fast_hash_kernels fast_hash_kernels_avx2 = {
+    fast_hash_accumulate_avx2, fast_hash_scramble_avx2};
+static const fast_hash_kernels fast_hash_kernels_avx512 = {
+    fast_hash_accumulate_avx512, fast_hash_scramble_avx512};
+#endif // FAST_HASH_X86
+
+/* 按优先级排列的长输入函数表 */
+static const cpu_dispatch_entry fast_hash_dispatch[] = {
+#ifdef FAST_HASH_X86
+    {CPU_FEATURE_AVX512F, &fast_hash_kernels_avx512},
+    {CPU_FEATURE_AVX2, &fast_hash_kernels_avx2},
+    {CPU_FEATURE_SSE2, &fast_hash_kernels_sse2},
+#endif
+    {0, &fast_hash_kernels_scalar},
+};
+
+static const fast_hash_kernels *kernels = NULL;
+
+/**
+ * @brief 按 CPU 支持的指令集选择长输入函数表，首次调用时确定。
+ * @return 返回函数表指针。
+ */
+static inline const fast_hash_kernels *fast_hash_get_kernels(void) {
+  return CPU_DISPATCH(kernels, fast_hash_dispatch);
+}
+
+/**
+ * @brief 由种子派生密钥，种子为 0 时与默认密钥相同。
+ * @param secret 保存派生密钥。
+ * @param seed 种子。
+ */
+static void fast_hash_init_secret(unsigned char *secret, uint64_t seed) {
+  int i;
+
+  for (i = 0; i < FAST_HASH_SECRET_SIZE / 16; i++) {
+    fast_hash_write64(secret + 16 * i,
+                      fast_hash_read64(fast_hash_secret + 16 * i) + seed);
+    fast_hash_write64(secret + 16 * i + 8,
+                      fast_hash_read64(fast_hash_secret + 16 * i + 8) - seed);
+  }
+}
+
+/**
+ * @brief 初始化累加器。
+ * @param acc 累加器。
+ */
+static void fast_hash_init_acc(uint64_t *acc) {
+  acc[0] = FAST_HASH_PRIME32_3;
+  acc[1] = FAST_HASH_PRIME64_1;
+  acc[2] = FAST_HASH_PRIME64_2;
+  acc[3] = FAST_HASH_PRIME64_3;
+  acc[4] = FAST_HASH_PRIME64_4;
+  acc[5] = FAST_HASH_PRIME32_2;
+  acc[6] = FAST_HASH_PRIME64_5;
+  acc[7] = FAST_HASH_PRIME32_1;
+}
+
+/**
+ * @brief 用累加器处理超过 240 字节的输入，包括最后一个条带。
+ * @param acc 累加器。
+ * @param in 输入。
+ * @param len 字节数。
+ * @param secret 密钥。
+ */
+static void fast_hash_long_loop(uint64_t *acc, const unsigned char *in,
+                                size_t len, const unsigned char *secret) {
+  const fast_hash_kernels *k = fast_hash_get_kernels();
+  size_t block_len = FAST_HASH_STRIPE_LEN * FAST_HASH_BLOCK_STRIPES;
+  size_t blocks = (len - 1) / block_len;
+  size_t n;
+
+  for (n = 0; n < blocks; n++) {
+    k->accumulate(acc, in + n * block_len, secret, FAST_HASH_BLOCK_STRIPES);
+    k->scramble(acc, secret + FAST_HASH_SECRET_LIMIT);
+  }
+
+  k->accumulate(acc, in + blocks * block_len, secret,
+                ((len - 1) - block_len * blocks) / FAST_HASH_STRIPE_LEN);
+  k->accumulate(acc, in + len - FAST_HASH_STRIPE_LEN,
+                secret + FAST_HASH_SECRET_LIMIT - FAST_HASH_LASTACC_START, 1);
+}
+
+/**
+ * @brief 合并累加器。
+ * @param acc 累加器。
+ * @param secret 密钥中合并使用的部分。
+ * @param start 初始值。
+ * @return 返回 64 位结果。
+ */
+static uint64_t fast_hash_merge_accs(const uint64_t *acc,
+                                     const unsigned char *secret,
+                                     uint64_t start) {
+  uint64_t result = start;
+  int i;
+
+  for (i = 0; i < 4; i++)
+    result += fast_hash_mul_fold64(
+        acc[2 * i] ^ fast_hash_read64(secret + 16 * i),
+        acc[2 * i + 1] ^ fast_hash_read64(secret + 16 * i + 8));
+  return fast_hash_avalanche(result);
+}
+
+/**
+ * @brief 由累加器得到 128 位结果。
+ */
+static fast_hash128_val fast_hash_merge_accs128(const uint64_t *acc,
+                                                const unsigned char *secret,
+                                                uint64_t len) {
+  fast_hash128_val h;
+
+  h.low = fast_hash_merge_accs(acc, secret + FAST_HASH_MERGEACCS_START,
+                               len * FAST_HASH_PRIME64_1);
+  h.high = fast_hash_merge_accs(acc,
+                                secret + FAST_HASH_SECRET_SIZE -
+                                    8 * sizeof(uint64_t) -
+                                    FAST_HASH_MERGEACCS_START,
+                                ~(len * FAST_HASH_PRIME64_2));
+  return h;
+}
+
+/**
+ * @brief 计算 64 位哈希值。
+ * @param data 数据指针，len 为 0 时可为 NULL。
+ * @param len 字节数。
+ * @return 返回哈希值。
+ */
+uint64_t fast_hash64(const void *data, size_t len) {
+  return fast_hash64_seed(data, len, 0);
+}
+
+/**
+ * @brief 使用种子计算 64 位哈希值。
+ * @param data 数据指针，len 为 0 时可为 NULL。
+ * @param len 字节数。
+ * @param seed 种子，为 0 时与 fast_hash64() 相同。
+ * @return 返回哈希值。
+ */
+uint64_t fast_hash64_seed(const void *data, size_t len, uint64_t seed) {
+  const unsigned char *in = (const unsigned char *)data;
+  unsigned char secret[FAST_HASH_SECRET_SIZE] __attribute__((aligned(64)));
+  const unsigned char *sec = fast_hash_secret;
+  uint64_t acc[8] __attribute__((aligned(64)));
+
+  if (len <= 16)
+    return fast_hash_len_0to16_64(in, len, fast_hash_secret, seed);
+  if (len <= 128)
+    return fast_hash_len_17to128_64(in, len, fast_hash_secret, seed);
+  if (len <= FAST_HASH_MIDSIZE_MAX)
+    return fast_hash_len_129to240_64(in, len, fast_hash_secret, seed);
+
+  if (seed) {
+    fast_hash_init_secret(secret, seed);
+    sec = secret;
+  }
+  fast_hash_init_acc(acc);
+  fast_hash_long_loop(acc, in, len, sec);
+  return fast_hash_merge_accs(acc, sec + FAST_HASH_MERGEACCS_START,
+                              (uint64_t)len * FAST_HASH_PRIME64_1);
+}
+
+/**
+ * @brief 计算不超过 16 字节输入的 128 位哈希值。
+ */
+static fast_hash128_val fast_hash_len_0to16_128(const unsigned char *in,
+                                                size_t len,
+                                                const unsigned char *secret,
+                                                uint64_t seed) {
+  fast_hash128_val h;
+
+  if (len > 8) {
+    uint64_t flip_lo =
+        (fast_hash_read64(secret + 32) ^ fast_hash_read64(secret + 40)) - seed;
+    uint64_t flip_hi =
+        (fast_hash_read64(secret + 48) ^ fast_hash_read64(secret + 56)) + seed;
+    uint64_t in_lo = fast_hash_read64(in);
+    uint64_t in_hi = fast_hash_read64(in + len - 8);
+    fast_hash128_val m =
+        fast_hash_mul128(in_lo ^ in_hi ^ flip_lo, FAST_HASH_PRIME64_1);
+
+    m.low += (uint64_t)(len - 1) << 54;
+    in_hi ^= flip_hi;
+    m.high += in_hi + (uint64_t)(uint32_t)in_hi * (FAST_HASH_PRIME32_2 - 1);
+    m.low ^= __builtin_bswap64(m.high);
+
+    h = fast_hash_mul128(m.low, FAST_HASH_PRIME64_2);
+    h.high += m.high * FAST_HASH_PRIME64_2;
+    h.low = fast_hash_avalanche(h.low);
+    h.high = fast_hash_avalanche(h.high);
+    return h;
+  }
+
+  if (len >= 4) {
+    uint64_t s = seed ^ ((uint64_t)__builtin_bswap32((uint32_t)seed) << 32);
+    uint64_t in64 = fast_hash_read32(in) +
+                    ((uint64_t)fast_hash_read32(in + len - 4) << 32);
+    uint64_t flip =
+        (fast_hash_read64(secret + 16) ^ fast_hash_read64(secret + 24)) + s;
+
+    /* 长度左移保证乘数为偶数倍以外的奇数 */
+    h = fast_hash_mul128(in64 ^ flip, FAST_HASH_PRIME64_1 + (len << 2));
+    h.high += h.low << 1;
+    h.low ^= h.high >> 3;
+    h.low = fast_hash_xorshift64(h.low, 35);
+    h.low *= FAST_HASH_PRIME_MX2;
+    h.low = fast_hash_xorshift64(h.low, 28);
+    h.high = fast_hash_avalanche(h.high);
+    return h;
+  }
+
+  if (len) {
+    uint32_t combined_lo = ((uint32_t)in[0] << 16) |
+                           ((uint32_t)in[len >> 1] << 24) |
+                           ((uint32_t)in[len - 1]) | ((uint32_t)len << 8);
+    uint32_t combined_hi =
+        fast_hash_rotl32(__builtin_bswap32(combined_lo), 13);
+    uint64_t flip_lo =
+        (fast_hash_read32(secret) ^ fast_hash_read32(secret + 4)) + seed;
+    uint64_t flip_hi =
+        (fast_hash_read32(secret + 8) ^ fast_hash_read32(secret + 12)) - seed;
+
+    h.low = fast_hash_avalanche_strong((uint64_t)combined_lo ^ flip_lo);
+    h.high = fast_hash_avalanche_strong((uint64_t)combined_hi ^ flip_hi);
+    return h;
+  }
+
+  h.low = fast_hash_avalanche_strong(seed ^ (fast_hash_read64(secret + 64) ^
+                                             fast_hash_read64(secret + 72)));
+  h.high = fast_hash_avalanche_strong(seed ^ (fast_hash_read64(secret + 80) ^
+                                              fast_hash_read64(secret + 88)));
+  return h;
+}
+
+/**
+ * @brief 混合 32 字节输入到 128 位累加值。
+ */
+static inline fast_hash128_val
+fast_hash_mix32(fast_hash128_val acc, const unsigned char *in1,
+                const unsigned char *in2, const unsigned char *secret,
+                uint64_t seed) {
+  acc.low += fast_hash_mix16(in1, secret, seed);
+  acc.low ^= fast_hash_read64(in2) + fast_hash_read64(in2 + 8);
+  acc.high += fast_hash_mix16(in2, secret + 16, seed);
+  acc.high ^= fast_hash_read64(in1) + fast_hash_read64(in1 + 8);
+  return acc;
+}
+
+/**
+ * @brief 中等长度输入的 128 位最终混合。
+ */
+static fast_hash128_val fast_hash_finish_mid128(fast_hash128_val acc,
+                                                size_t len, uint64_t seed) {
+  fast_hash128_val h;
+
+  h.low = acc.low + acc.high;
+  h.high = acc.low * FAST_HASH_PRIME64_1 + acc.high * FAST_HASH_PRIME64_4 +
+           (len - seed) * FAST_HASH_PRIME64_2;
+  h.low = fast_hash_avalanche(h.low);
+  h.high = (uint64_t)0 - fast_hash_avalanche(h.high);
+  return h;
+}
+
+/**
+ * @brief 计算 17 到 128 字节输入的 128 位哈希值。
+ */
+static fast_hash128_val fast_hash_len_17to128_128(const unsigned char *in,
+                                                  size_t len,
+                                                  const unsigned char *secret,
+                                                  uint64_t seed) {
+  fast_hash128_val acc;
+
+  acc.low = len * FAST_HASH_PRIME64_1;
+  acc.high = 0;
+  if (len > 32) {
+    if (len > 64) {
+      if (len > 96)
+        acc = fast_hash_mix32(acc, in + 48, in + len - 64, secret + 96, seed);
+      acc = fast_hash_mix32(acc, in + 32, in + len - 48, secret + 64, seed);
+    }
+    acc = fast_hash_mix32(acc, in + 16, in + len - 32, secret + 32, seed);
+  }
+  acc = fast_hash_mix32(acc, in, in + len - 16, secret, seed);
+  return fast_hash_finish_mid128(acc, len, seed);
+}
+
+/**
+ * @brief 计算 129 到 240 字节输入的 128 位哈希值。
+ */
+static fast_hash128_val fast_hash_len_129to240_128(const unsigned char *in,
+                                                   size_t len,
+                                                   const unsigned char *secret,
+                                                   uint64_t seed) {
+  fast_hash128_val acc;
+  size_t i;
+
+  acc.low = len * FAST_HASH_PRIME64_1;
+  acc.high = 0;
+  for (i = 32; i < 160; i += 32)
+    acc = fast_hash_mix32(acc, in + i - 32, in + i - 16, secret + i - 32, seed);
+  acc.low = fast_hash_avalanche(acc.low);
+  acc.high = fast_hash_avalanche(acc.high);
+  for (i = 160; i <= len; i += 32)
+    acc = fast_hash_mix32(acc, in + i - 32, in + i - 16,
+                          secret + FAST_HASH_MIDSIZE_STARTOFFSET + i - 160,
+                          seed);
+  acc = fast_hash_mix32(acc, in + len - 16, in + len - 32,
+                        secret + FAST_HASH_SECRET_SIZE_MIN -
+                            FAST_HASH_MIDSIZE_LASTOFFSET - 16,
+                        (uint64_t)0 - seed);
+  return fast_hash_finish_mid128(acc, len, seed);
+}
+
+/**
+ * @brief 计算 128 位哈希值。
+ * @param data 数据指针，len 为 0 时可为 NULL。
+ * @param len 字节数。
+ * @return 返回哈希值。
+ */
+fast_hash128_val fast_hash128(const void *data, size_t len) {
+  return fast_hash128_seed(data, len, 0);
+}
+
+/**
+ * @brief 使用种子计算 128 位哈希值。
+ * @param data 数据指针，len 为 0 时可为 NULL。
+ * @param len 字节数。
+ * @param seed 种子，为 0 时与 fast_hash128() 相同。
+ * @return 返回哈希值。
+ */
+fast_hash128_val fast_hash128_seed(const void *data, size_t len,
+                                   uint64_t seed) {
+  const unsigned char *in = (const unsigned char *)data;
+  unsigned char secret[FAST_HASH_SECRET_SIZE] __attribute__((aligned(64)));
+  const unsigned char *sec = fast_hash_secret;
+  uint64_t acc[8] __attribute__((aligned(64)));
+
+  if (len <= 16)
+    return fast_hash_len_0to16_128(in, len, fast_hash_secret, seed);
+  if (len <= 128)
+    return fast_hash_len_17to128_128(in, len, fast_hash_secret, seed);
+  if (len <= FAST_HASH_MIDSIZE_MAX)
+    return fast_hash_len_129to240_128(in, len, fast_hash_secret, seed);
+
+  if (seed) {
+    fast_hash_init_secret(secret, seed);
+    sec = secret;
+  }
+  fast_hash_init_acc(acc);
+  fast_hash_long_loop(acc, in, len, sec);
+  return fast_hash_merge_accs128(acc, sec, len);
+}
+
+/**
+ * @brief 初始化流式哈希状态。
+ * @param state 状态指针。
+ * @param seed 种子。
+ */
+void fast_hash_init(fast_hash_state *state, uint64_t seed) {
+  fast_hash_init_acc(state->acc);
+  fast_hash_init_secret(state->secret, seed);
+  state->buffered = 0;
+  state->stripes = 0;
+  state->total_len = 0;
+  state->seed = seed;
+}
+
+/**
+ * @brief 处理若干条带，跨越块边界时打乱累加器。
+ * @param acc 累加器。
+ * @param stripes 当前块已处理的条带数，返回时更新。
+ * @param in 输入。
+ * @param n 条带数。
+ * @param secret 密钥。
+ * @return 返回处理后的输入位置。
+ */
+static const unsigned char *fast_hash_consume(uint64_t *acc, size_t *stripes,
+                                              const unsigned char *in,
+                                              size_t n,
+                                              const unsigned char *secret) {
+  const fast_hash_kernels *k = fast_hash_get_kernels();
+  const unsigned char *sec = secret + *stripes * FAST_HASH_SECRET_CONSUME;
+  size_t this_iter;
+
+  if (n >= FAST_HASH_BLOCK_STRIPES - *stripes) {
+    this_iter = FAST_HASH_BLOCK_STRIPES - *stripes;
+    do {
+      k->accumulate(acc, in, sec, this_iter);
+      k->scramble(acc, secret + FAST_HASH_SECRET_LIMIT);
+      in += this_iter * FAST_HASH_STRIPE_LEN;
+      n -= this_iter;
+      this_iter = FAST_HASH_BLOCK_STRIPES;
+      sec = secret;
+    } while (n >= FAST_HASH_BLOCK_STRIPES);
+    *stripes = 0;
+  }
+
+  if (n) {
+    k->accumulate(acc, in, sec, n);
+    in += n * FAST_HASH_STRIPE_LEN;
+    *stripes += n;
+  }
+  return in;
+}
+
+/**
+ * @brief 输入数据。
+ * @param state 状态指针。
+ * @param data 数据指针，len 为 0 时可为 NULL。
+ * @param len 字节数。
+ */
+void fast_hash_update(fast_hash_state *state, const void *data, size_t len) {
+  const unsigned char *in = (const unsigned char *)data;
+  const unsigned char *end = in + len;
+  size_t load;
+
+  state->total_len += len;
+  if (len <= FAST_HASH_BUFFER_SIZE - state->buffered) {
+    if (len)
+      memcpy(state->buffer + state->buffered, in, len);
+    state->buffered += len;
+    return;
+  }
+
+  /* 总是保留至少一个字节在缓冲区中，最后一个条带在计算结果时处理 */
+  if (state->buffered) {
+    load = FAST_HASH_BUFFER_SIZE - state->buffered;
+    memcpy(state->buffer + state->buffered, in, load);
+    in += load;
+    fast_hash_consume(state->acc, &state->stripes, state->buffer,
+                      FAST_HASH_BUFFER_SIZE / FAST_HASH_STRIPE_LEN,
+                      state->secret);
+    state->buffered = 0;
+  }
+
+  if ((size_t)(end - in) > FAST_HASH_BUFFER_SIZE) {
+    in = fast_hash_consume(state->acc, &state->stripes, in,
+                           (size_t)(end - 1 - in) / FAST_HASH_STRIPE_LEN,
+                           state->secret);
+    /* 保存最后一个完整条带，剩余不足一个条带时计算结果需要用到 */
+    memcpy(state->buffer + FAST_HASH_BUFFER_SIZE - FAST_HASH_STRIPE_LEN,
+           in - FAST_HASH_STRIPE_LEN, FAST_HASH_STRIPE_LEN);
+  }
+
+  memcpy(state->buffer, in, (size_t)(end - in));
+  state->buffered = (size_t)(end - in);
+}
+
+/**
+ * @brief 对长输入的副本累加器处理剩余数据。
+ * @param state 状态指针。
+ * @param acc 保存累加器。
+ */
+static void fast_hash_digest_long(const fast_hash_state *state,
+                                  uint64_t *acc) {
+  const fast_hash_kernels *k = fast_hash_get_kernels();
+  unsigned char last[FAST_HASH_STRIPE_LEN];
+  const unsigned char *last_ptr;
+  size_t stripes = state->stripes;
+  size_t catchup;
+
+  memcpy(acc, state->acc, sizeof(state->acc));
+  if (state->buffered >= FAST_HASH_STRIPE_LEN) {
+    fast_hash_consume(acc, &stripes, state->buffer,
+                      (state->buffered - 1) / FAST_HASH_STRIPE_LEN,
+                      state->secret);
+    last_ptr = state->buffer + state->buffered - FAST_HASH_STRIPE_LEN;
+  } else {
+    catchup = FAST_HASH_STRIPE_LEN - state->buffered;
+    memcpy(last, state->buffer + FAST_HASH_BUFFER_SIZE - catchup, catchup);
+    memcpy(last + catchup, state->buffer, state->buffered);
+    last_ptr = last;
+  }
+  k->accumulate(acc, last_ptr,
+                state->secret + FAST_HASH_SECRET_LIMIT -
+                    FAST_HASH_LASTACC_START,
+                1);
+}
+
+/**
+ * @brief 获取当前输入的 64 位哈希值，不影响之后继续输入。
+ * @param state 状态指针。
+ * @return 返回与一次性计算相同的哈希值。
+ */
+uint64_t fast_hash_digest64(const fast_hash_state *state) {
+  uint64_t acc[8] __attribute__((aligned(64)));
+
+  if (state->total_len <= FAST_HASH_MIDSIZE_MAX)
+    return fast_hash64_seed(state->buffer, (size_t)state->total_len,
+                            state->seed);
+
+  fast_hash_digest_long(state, acc);
+  return fast_hash_merge_accs(acc, state->secret + FAST_HASH_MERGEACCS_START,
+                              state->total_len * FAST_HASH_PRIME64_1);
+}
+
+/**
+ * @brief 获取当前输入的 128 位哈希值，不影响之后继续输入。
+ * @param state 状态指针。
+ * @return 返回与一次性计算相同的哈希值。
+ */
+fast_hash128_val fast_hash_digest128(const fast_hash_state *state) {
+  uint64_t acc[8] __attribute__((aligned(64)));
+
+  if (state->total_len <= FAST_HASH_MIDSIZE_MAX)
+    return fast_hash128_seed(state->buffer, (size_t)state->total_len,
+                             state->seed);
+
+  fast_hash_digest_long(state, acc);
+  return fast_hash_merge_accs128(acc, state->secret, state->total_len);
+}
@@ -0,0 +1,274 @@
+/**
+ * @file mem_pages.c
+ * @brief 缓存行/页对齐、大页及 NUMA 绑定的内存申请实现文件
+ * @author moecly
+ */
+
+#include "../inc/mem_pages.h"
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* 内存策略，与 linux/mempolicy.h 一致，避免依赖 libnuma */
+#define MEM_MPOL_DEFAULT 0
+#define MEM_MPOL_PREFERRED 1
+#define MEM_MPOL_BIND 2
+
+/* 页分配器放在用户指针之前的头部大小 */
+#define MEM_PAGE_HEADER CACHE_LINE_SIZE
+
+/* 每个字的位数 */
+#define MEM_NUMA_WORD_BITS (8 * sizeof(unsigned long))
+
+/**
+ * @brief 页分配器的头部，位于用户指针之前
+ */
+typedef struct {
+  void *base;      /* 映射起始地址 */
+  size_t map_size; /* 映射字节数 */
+} mem_page_header;
+
+/**
+ * @brief 按缓存行对齐申请内存，字节数向上取整为缓存行的整数倍。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL，使用 mem_free() 释放。
+ */
+void *mem_cache_aligned_alloc(mem_allocator *allocator, size_t size) {
+  size = (size + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+  return mem_aligned_alloc(allocator, CACHE_LINE_SIZE, size);
+}
+
+/**
+ * @brief 以普通页映射匿名内存。
+ * @param len 字节数。
+ * @return 返回内存指针，失败返回 MAP_FAILED。
+ */
+static void *mem_pages_map(size_t len) {
+  return mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+              -1, 0);
+}
+
+/**
+ * @brief 按页映射内存，可选大页和 NUMA 节点绑定。
+ * @param size 字节数。
+ * @param flags mem_page_flag 的组合。
+ * @param node 绑定的 NUMA 节点，MEM_NUMA_NODE_ANY 表示不绑定。
+ * @param map_size 保存实际映射的字节数，释放时传入。
+ * @return 返回页对齐的内存指针，失败返回 NULL。
+ */
+void *mem_pages_alloc(size_t size, int flags, int node, size_t *map_size) {
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  void *addr = MAP_FAILED;
+  size_t len;
+  size_t i;
+
+  if (flags & mem_page_flag_huge)
+    page = MEM_HUGE_PAGE_SIZE;
+  if (!size || size > SIZE_MAX - page)
+    return NULL;
+  len = (size + page - 1) & ~(page - 1);
+
+  if (flags & mem_page_flag_huge) {
+#ifdef MAP_HUGETLB
+    addr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    /* 没有预留大页时使用普通映射，并建议内核使用透明大页 */
+    if (addr == MAP_FAILED) {
+      addr = mem_pages_map(len);
+#ifdef MADV_HUGEPAGE
+      if (addr != MAP_FAILED)
+        madvise(addr, len, MADV_HUGEPAGE);
+#endif
+    }
+  } else {
+    addr = mem_pages_map(len);
+  }
+  if (addr == MAP_FAILED)
+    return NULL;
+
+  /* 绑定须在首次访问前完成，内核不支持 NUMA 时按默认策略分配 */
+  if (node != MEM_NUMA_NODE_ANY)
+    mem_numa_bind(addr, len, node);
+
+  if (flags & mem_page_flag_populate) {
+    page = (size_t)sysconf(_SC_PAGESIZE);
+    for (i = 0; i < len; i += page)
+      ((volatile char *)addr)[i] = 0;
+  }
+
+  *map_size = len;
+  return addr;
+}
+
+/**
+ * @brief 释放 mem_pages_alloc() 映射的内存。
+ * @param addr 内存指针。
+ * @param map_size mem_pages_alloc() 返回的映射字节数。
+ */
+void mem_pages_free(void *addr, size_t map_size) {
+  if (addr)
+    munmap(addr, map_size);
+}
+
+/**
+ * @brief 将内存区域绑定到 NUMA 节点，需在首次访问前调用。
+ * @param addr 页对齐的内存指针。
+ * @param len 字节数。
+ * @param node NUMA 节点。
+ * @return 成功返回 ret_ok，失败返回 ret_err。
+ */
+ret_val mem_numa_bind(void *addr, size_t len, int node) {
+  unsigned long mask[MEM_NUMA_MAX_NODES / MEM_NUMA_WORD_BITS];
+
+  if (node < 0 || node >= MEM_NUMA_MAX_NODES)
+    return ret_err;
+
+  memset(mask, 0, sizeof(mask));
+  mask[node / MEM_NUMA_WORD_BITS] |= 1UL << (node % MEM_NUMA_WORD_BITS);
+  if (syscall(SYS_mbind, addr, len, MEM_MPOL_BIND, mask,
+              MEM_NUMA_MAX_NODES + 1, 0))
+    return ret_err;
+  return ret_ok;
+}
+
+/**
+ * @brief 设置当前线程之后申请内存时优先使用的 NUMA 节点。
+ * @param node NUMA 节点，MEM_NUMA_NODE_ANY 表示恢复默认策略。
+ * @return 成功返回 ret_ok，失败返回 ret_err。
+ */
+ret_val mem_numa_set_preferred(int node) {
+  unsigned long mask[MEM_NUMA_MAX_NODES / MEM_NUMA_WORD_BITS];
+  long ret;
+
+  if (node == MEM_NUMA_NODE_ANY) {
+    ret = syscall(SYS_set_mempolicy, MEM_MPOL_DEFAULT, NULL, 0);
+  } else {
+    if (node < 0 || node >= MEM_NUMA_MAX_NODES)
+      return ret_err;
+    memset(mask, 0, sizeof(mask));
+    mask[node / MEM_NUMA_WORD_BITS] |= 1UL << (node % MEM_NUMA_WORD_BITS);
+    ret = syscall(SYS_set_mempolicy, MEM_MPOL_PREFERRED, mask,
+                  MEM_NUMA_MAX_NODES + 1);
+  }
+  return ret ? ret_err : ret_ok;
+}
+
+/**
+ * @brief 获取当前线程所在 CPU 的 NUMA 节点。
+ * @return 返回节点编号，失败返回 MEM_NUMA_NODE_ANY。
+ */
+int mem_numa_current_node(void) {
+  unsigned int cpu;
+  unsigned int node;
+
+  if (syscall(SYS_getcpu, &cpu, &node, NULL))
+    return MEM_NUMA_NODE_ANY;
+  return (int)node;
+}
+
+/**
+ * @brief 页分配器的对齐申请函数。
+ * @param ctx 页分配器指针。
+ * @param align 对齐字节数，需为 2 的幂。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+static void *mem_page_allocator_aligned_alloc(void *ctx, size_t align,
+                                              size_t size) {
+  mem_page_allocator *pa = (mem_page_allocator *)ctx;
+  mem_page_header *hdr;
+  size_t map_size;
+  uintptr_t ptr;
+  char *base;
+
+  if (align < CACHE_LINE_SIZE)
+    align = CACHE_LINE_SIZE;
+  if (size > SIZE_MAX - MEM_PAGE_HEADER - align)
+    return NULL;
+
+  base = (char *)mem_pages_alloc(size + MEM_PAGE_HEADER + align, pa->flags,
+                                 pa->node, &map_size);
+  if (!base)
+    return NULL;
+
+  /* 头部占用用户指针之前的一个缓存行 */
+  ptr = ((uintptr_t)base + MEM_PAGE_HEADER + align - 1) &
+        ~(uintptr_t)(align - 1);
+  hdr = (mem_page_header *)(ptr - MEM_PAGE_HEADER);
+  hdr->base = base;
+  hdr->map_size = map_size;
+  return (void *)ptr;
+}
+
+/**
+ * @brief 页分配器的申请函数，按缓存行对齐。
+ * @param ctx 页分配器指针。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+static void *mem_page_allocator_alloc(void *ctx, size_t size) {
+  return mem_page_allocator_aligned_alloc(ctx, CACHE_LINE_SIZE, size);
+}
+
+/**
+ * @brief 页分配器的释放函数。
+ * @param ctx 页分配器指针。
+ * @param ptr 内存指针。
+ */
+static void mem_page_allocator_free(void *ctx, void *ptr) {
+  mem_page_header *hdr = (mem_page_header *)((char *)ptr - MEM_PAGE_HEADER);
+
+  UNUSED(ctx);
+  mem_pages_free(hdr->base, hdr->map_size);
+}
+
+/**
+ * @brief 页分配器的调整大小函数，申请新映射后复制。
+ * @param ctx 页分配器指针。
+ * @param ptr 原内存指针。
+ * @param size 新的字节数。
+ * @return 返回新的内存指针，失败返回 NULL。
+ */
+static void *mem_page_allocator_realloc(void *ctx, void *ptr, size_t size) {
+  mem_page_header *hdr;
+  size_t old_size;
+  void *new_ptr;
+
+  if (!ptr)
+    return mem_page_allocator_alloc(ctx, size);
+
+  hdr = (mem_page_header *)((char *)ptr - MEM_PAGE_HEADER);
+  old_size = hdr->map_size - (size_t)((char *)ptr - (char *)hdr->base);
+  if (size <= old_size)
+    return ptr;
+
+  new_ptr = mem_page_allocator_alloc(ctx, size);
+  if (!new_ptr)
+    return NULL;
+  memcpy(new_ptr, ptr, old_size);
+  mem_page_allocator_free(ctx, ptr);
+  return new_ptr;
+}
+
+/**
+ * @brief 初始化页分配器。
+ * @param pa 页分配器指针。
+ * @param flags mem_page_flag 的组合。
+ * @param node 绑定的 NUMA 节点，MEM_NUMA_NODE_ANY 表示不绑定。
+ * @return 返回分配器接口指针，生命周期与 pa 相同。
+ */
+mem_allocator *mem_page_allocator_init(mem_page_allocator *pa, int flags,
+                                       int node) {
+  pa->flags = flags;
+  pa->node = node;
+  pa->allocator.alloc = mem_page_allocator_alloc;
+  pa->allocator.realloc = mem_page_allocator_realloc;
+  pa->allocator.free = mem_page_allocator_free;
+  pa->allocator.aligned_alloc = mem_page_allocator_aligned_alloc;
+  pa->allocator.ctx = pa;
+  return &pa->allocator;
+}
@@ -0,0 +1,459 @@
+/**
+ * @file mem_stats.c
+ * @brief 内存分配统计实现文件
+ * @author moecly
+ */
+
+#include "../inc/mem_stats.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef USE_MEM_STATS
+
+#ifdef USE_TC_ALLOC
+#include "../inc/tc_alloc.h"
+#define MEM_STATS_RAW_ALLOC(size) tc_malloc(size)
+#define MEM_STATS_RAW_REALLOC(ptr, size) tc_realloc(ptr, size)
+#define MEM_STATS_RAW_FREE(ptr) tc_free(ptr)
+#else
+#define MEM_STATS_RAW_ALLOC(size) malloc(size)
+#define MEM_STATS_RAW_REALLOC(ptr, size) realloc(ptr, size)
+#define MEM_STATS_RAW_FREE(ptr) free(ptr)
+#endif // USE_TC_ALLOC
+
+/* 模块名的最大长度 */
+#define MEM_STATS_MODULE_LEN 32
+
+/**
+ * @brief 每块内存之前的头部，记录字节数和所属调用处
+ */
+typedef struct {
+  size_t size;     /* 用户申请的字节数 */
+  uint32_t slot;   /* 调用处编号 */
+  uint32_t offset; /* 用户指针相对底层内存起始的偏移 */
+} mem_stats_header;
+
+/**
+ * @brief 单个调用处的计数
+ */
+typedef struct {
+  uint64_t allocs;    /* 申请次数 */
+  uint64_t frees;     /* 释放次数 */
+  int64_t live_bytes; /* 存量字节数，跨线程释放时单个分片可能为负 */
+  int64_t peak_bytes; /* 分片内观测到的峰值字节数 */
+} mem_stats_counter;
+
+/**
+ * @brief 线程私有的计数分片，只由所属线程写入
+ */
+typedef struct mem_stats_shard {
+  struct mem_stats_shard *prev;                  /* 上一个分片 */
+  struct mem_stats_shard *next;                  /* 下一个分片 */
+  mem_stats_counter counters[MEM_STATS_MAX_SITES]; /* 各调用处的计数 */
+} mem_stats_shard;
+
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t shard_once = PTHREAD_ONCE_INIT;
+static pthread_key_t shard_key;
+static __thread mem_stats_shard *thread_shard;
+
+static mem_stats_shard *shards;
+static mem_stats_counter retired[MEM_STATS_MAX_SITES];
+static int64_t snapshot_peak[MEM_STATS_MAX_SITES];
+static const char *site_files[MEM_STATS_MAX_SITES];
+static int site_lines[MEM_STATS_MAX_SITES];
+static char site_modules[MEM_STATS_MAX_SITES][MEM_STATS_MODULE_LEN];
+static uint32_t site_count = 1;
+
+/**
+ * @brief 由文件路径推断模块名，取 src 或 inc 的上一级目录名，否则取文件名。
+ * @param file 文件路径。
+ * @param module 存储模块名的缓冲区，长度为 MEM_STATS_MODULE_LEN。
+ */
+static void mem_stats_module_name(const char *file, char *module) {
+  const char *end = NULL;
+  const char *begin;
+  const char *p;
+  size_t len;
+
+  for (p = file; *p; p++)
+    if (!strncmp(p, "/src/", 5) || !strncmp(p, "/inc/", 5))
+      end = p;
+
+  if (!end) {
+    begin = strrchr(file, '/');
+    begin = begin ? begin + 1 : file;
+    end = strchr(begin, '.');
+    if (!end)
+      end = begin + strlen(begin);
+  } else {
+    begin = end;
+    while (begin > file && begin[-1] != '/')
+      begin--;
+  }
+
+  len = (size_t)(end - begin);
+  if (len >= MEM_STATS_MODULE_LEN)
+    len = MEM_STATS_MODULE_LEN - 1;
+  memcpy(module, begin, len);
+  module[len] = '\0';
+}
+
+/**
+ * @brief 为调用处分配编号，编号用尽后合并到编号 0。
+ * @param site 调用处信息。
+ * @return 返回调用处编号。
+ */
+static uint32_t mem_stats_register(mem_stats_site *site) {
+  uint32_t id;
+
+  pthread_mutex_lock(&stats_lock);
+  id = site->id;
+  if (!id) {
+    if (site_count < MEM_STATS_MAX_SITES) {
+      site_files[site_count] = site->file;
+      site_lines[site_count] = site->line;
+      mem_stats_module_name(site->file, site_modules[site_count]);
+      id = ++site_count;
+    } else {
+      id = 1;
+    }
+    __atomic_store_n(&site->id, id, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&stats_lock);
+  return id - 1;
+}
+
+/**
+ * @brief 线程退出时将分片的计数合并到全局计数并释放分片。
+ * @param arg 分片指针。
+ */
+static void mem_stats_shard_destroy(void *arg) {
+  mem_stats_shard *shard = (mem_stats_shard *)arg;
+  mem_stats_counter *c;
+  uint32_t i;
+
+  pthread_mutex_lock(&stats_lock);
+  for (i = 0; i < MEM_STATS_MAX_SITES; i++) {
+    c = &shard->counters[i];
+    retired[i].allocs += c->allocs;
+    retired[i].frees += c->frees;
+    retired[i].live_bytes += c->live_bytes;
+    if (c->peak_bytes > retired[i].peak_bytes)
+      retired[i].peak_bytes = c->peak_bytes;
+  }
+  if (shard->prev)
+    shard->prev->next = shard->next;
+  else
+    shards = shard->next;
+  if (shard->next)
+    shard->next->prev = shard->prev;
+  pthread_mutex_unlock(&stats_lock);
+
+  thread_shard = NULL;
+  free(shard);
+}
+
+/**
+ * @brief 创建线程退出时合并分片所用的键。
+ */
+static void mem_stats_key_create(void) {
+  pthread_key_create(&shard_key, mem_stats_shard_destroy);
+}
+
+/**
+ * @brief 获取当前线程的分片，首次调用时创建。
+ * @return 返回分片指针，内存不足返回 NULL。
+ */
+static mem_stats_shard *mem_stats_shard_get(void) {
+  mem_stats_shard *shard = thread_shard;
+
+  if (__builtin_expect(shard != NULL, 1))
+    return shard;
+
+  pthread_once(&shard_once, mem_stats_key_create);
+  shard = (mem_stats_shard *)calloc(1, sizeof(mem_stats_shard));
+  if (!shard)
+    return NULL;
+
+  pthread_mutex_lock(&stats_lock);
+  shard->prev = NULL;
+  shard->next = shards;
+  if (shards)
+    shards->prev = shard;
+  shards = shard;
+  pthread_mutex_unlock(&stats_lock);
+
+  pthread_setspecific(shard_key, shard);
+  thread_shard = shard;
+  return shard;
+}
+
+/**
+ * @brief 记录一次申请，分片只由本线程写入，使用 relaxed 存储供其他线程读取。
+ * @param slot 调用处编号。
+ * @param size 字节数。
+ */
+static void mem_stats_count_alloc(uint32_t slot, size_t size) {
+  mem_stats_shard *shard = mem_stats_shard_get();
+  mem_stats_counter *c;
+  int64_t live;
+
+  if (!shard)
+    return;
+
+  c = &shard->counters[slot];
+  live = c->live_bytes + (int64_t)size;
+  __atomic_store_n(&c->allocs, c->allocs + 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&c->live_bytes, live, __ATOMIC_RELAXED);
+  if (live > c->peak_bytes)
+    __atomic_store_n(&c->peak_bytes, live, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 记录一次释放。
+ * @param slot 调用处编号。
+ * @param size 字节数。
+ */
+static void mem_stats_count_free(uint32_t slot, size_t size) {
+  mem_stats_shard *shard = mem_stats_shard_get();
+  mem_stats_counter *c;
+
+  if (!shard)
+    return;
+
+  c = &shard->counters[slot];
+  __atomic_store_n(&c->frees, c->frees + 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&c->live_bytes, c->live_bytes - (int64_t)size,
+                   __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 填写头部并记录申请。
+ * @param raw 底层内存指针。
+ * @param offset 用户指针相对底层内存起始的偏移。
+ * @param size 字节数。
+ * @param site 调用处信息。
+ * @return 返回用户指针。
+ */
+static void *mem_stats_attach(char *raw, size_t offset, size_t size,
+                              mem_stats_site *site) {
+  mem_stats_header *hdr = (mem_stats_header *)(raw + offset) - 1;
+  uint32_t id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+  uint32_t slot = id ? id - 1 : mem_stats_register(site);
+
+  hdr->size = size;
+  hdr->slot = slot;
+  hdr->offset = (uint32_t)offset;
+  mem_stats_count_alloc(slot, size);
+  return raw + offset;
+}
+
+/**
+ * @brief 按调用处统计并申请内存。
+ * @param size 字节数。
+ * @param site 调用处信息。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+void *mem_stats_alloc(size_t size, mem_stats_site *site) {
+  char *raw;
+
+  if (size > SIZE_MAX - sizeof(mem_stats_header))
+    return NULL;
+  raw = (char *)MEM_STATS_RAW_ALLOC(size + sizeof(mem_stats_header));
+  if (!raw)
+    return NULL;
+  return mem_stats_attach(raw, sizeof(mem_stats_header), size, site);
+}
+
+/**
+ * @brief 按调用处统计并按对齐要求申请内存，可用 FREE_FUNC 释放。
+ * @param align 对齐字节数，需为 2 的幂。
+ * @param size 字节数。
+ * @param site 调用处信息。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+void *mem_stats_aligned_alloc(size_t align, size_t size, mem_stats_site *site) {
+  void *raw;
+
+  if (align <= sizeof(mem_stats_header))
+    return mem_stats_alloc(size, site);
+  if (size > SIZE_MAX - align)
+    return NULL;
+
+  /* 头部放在对齐后的用户指针之前，占用前导的 align 字节 */
+#ifdef USE_TC_ALLOC
+  raw = tc_aligned_alloc(align, size + align);
+  if (!raw)
+    return NULL;
+#else
+  if (posix_memalign(&raw, align, size + align))
+    return NULL;
+#endif
+  return mem_stats_attach((char *)raw, align, size, site);
+}
+
+/**
+ * @brief 按调用处统计并调整内存大小。
+ * @param ptr 原内存指针，可为 NULL。
+ * @param size 新的字节数。
+ * @param site 调用处信息。
+ * @return 返回新的内存指针，失败返回 NULL 且原内存不变。
+ */
+void *mem_stats_realloc(void *ptr, size_t size, mem_stats_site *site) {
+  mem_stats_header *hdr;
+  size_t old_size;
+  uint32_t old_slot;
+  char *raw;
+
+  if (!ptr)
+    return mem_stats_alloc(size, site);
+
+  hdr = (mem_stats_header *)ptr - 1;
+  old_size = hdr->size;
+  old_slot = hdr->slot;
+
+  /* 对齐申请的内存无法由底层 realloc 保持对齐，改为申请后复制 */
+  if (hdr->offset != sizeof(mem_stats_header)) {
+    raw = (char *)mem_stats_alloc(size, site);
+    if (!raw)
+      return NULL;
+    memcpy(raw, ptr, old_size < size ? old_size : size);
+    mem_stats_free(ptr);
+    return raw;
+  }
+
+  if (size > SIZE_MAX - sizeof(mem_stats_header))
+    return NULL;
+  raw = (char *)MEM_STATS_RAW_REALLOC((char *)hdr,
+                                      size + sizeof(mem_stats_header));
+  if (!raw)
+    return NULL;
+
+  mem_stats_count_free(old_slot, old_size);
+  return mem_stats_attach(raw, sizeof(mem_stats_header), size, site);
+}
+
+/**
+ * @brief 释放 mem_stats_alloc() 系列函数申请的内存，计入申请时的调用处。
+ * @param ptr 内存指针，可为 NULL。
+ */
+void mem_stats_free(void *ptr) {
+  mem_stats_header *hdr;
+
+  if (!ptr)
+    return;
+
+  hdr = (mem_stats_header *)ptr - 1;
+  mem_stats_count_free(hdr->slot, hdr->size);
+  MEM_STATS_RAW_FREE((char *)ptr - hdr->offset);
+}
+
+#endif // USE_MEM_STATS
+
+/**
+ * @brief 合并各线程分片，生成各调用处的统计快照。
+ * @param snap 快照指针，使用后调用 mem_stats_snapshot_free() 释放。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err。
+ */
+ret_val mem_stats_snapshot_take(mem_stats_snapshot *snap) {
+#ifdef USE_MEM_STATS
+  mem_stats_shard *shard;
+  mem_stats_counter *c;
+  mem_stats_entry *e;
+  int64_t peak;
+  uint32_t i;
+
+  pthread_mutex_lock(&stats_lock);
+  snap->count = site_count;
+  snap->entries = (mem_stats_entry *)calloc(site_count, sizeof(mem_stats_entry));
+  if (!snap->entries) {
+    snap->count = 0;
+    pthread_mutex_unlock(&stats_lock);
+    return ret_err;
+  }
+
+  for (i = 0; i < site_count; i++) {
+    e = &snap->entries[i];
+    e->file = i ? site_files[i] : "(other)";
+    e->line = i ? site_lines[i] : 0;
+    e->module = i ? site_modules[i] : "(other)";
+    e->allocs = retired[i].allocs;
+    e->frees = retired[i].frees;
+    e->live_bytes = retired[i].live_bytes;
+    peak = retired[i].peak_bytes;
+
+    for (shard = shards; shard; shard = shard->next) {
+      c = &shard->counters[i];
+      e->allocs += __atomic_load_n(&c->allocs, __ATOMIC_RELAXED);
+      e->frees += __atomic_load_n(&c->frees, __ATOMIC_RELAXED);
+      e->live_bytes += __atomic_load_n(&c->live_bytes, __ATOMIC_RELAXED);
+      if (__atomic_load_n(&c->peak_bytes, __ATOMIC_RELAXED) > peak)
+        peak = __atomic_load_n(&c->peak_bytes, __ATOMIC_RELAXED);
+    }
+
+    if (e->live_bytes > peak)
+      peak = e->live_bytes;
+    if (peak > snapshot_peak[i])
+      snapshot_peak[i] = peak;
+    e->peak_bytes = snapshot_peak[i];
+  }
+  pthread_mutex_unlock(&stats_lock);
+#else
+  snap->entries = NULL;
+  snap->count = 0;
+#endif // USE_MEM_STATS
+  return ret_ok;
+}
+
+/**
+ * @brief 将快照按模块汇总。
+ * @param snap 快照指针。
+ * @param out 存储汇总结果的数组。
+ * @param max 数组长度。
+ * @return 返回写入的模块数，超过 max 的模块被忽略。
+ */
+uint32_t mem_stats_snapshot_by_module(const mem_stats_snapshot *snap,
+                                      mem_stats_entry *out, uint32_t max) {
+  const mem_stats_entry *e;
+  uint32_t n = 0;
+  uint32_t i;
+  uint32_t j;
+
+  for (i = 0; i < snap->count; i++) {
+    e = &snap->entries[i];
+    for (j = 0; j < n; j++)
+      if (!strcmp(out[j].module, e->module))
+        break;
+
+    if (j == n) {
+      if (n == max)
+        continue;
+      memset(&out[j], 0, sizeof(out[j]));
+      out[j].module = e->module;
+      n++;
+    }
+
+    out[j].allocs += e->allocs;
+    out[j].frees += e->frees;
+    out[j].live_bytes += e->live_bytes;
+    /* 各调用处的峰值不一定同时出现，取其最大值与存量之和中的较大者 */
+    if (e->peak_bytes > out[j].peak_bytes)
+      out[j].peak_bytes = e->peak_bytes;
+    if (out[j].live_bytes > out[j].peak_bytes)
+      out[j].peak_bytes = out[j].live_bytes;
+  }
+  return n;
+}
+
+/**
+ * @brief 释放快照。
+ * @param snap 快照指针。
+ */
+void mem_stats_snapshot_free(mem_stats_snapshot *snap) {
+  free(snap->entries);
+  snap->entries = NULL;
+  snap->count = 0;
+}
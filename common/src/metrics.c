@@ -0,0 +1,620 @@
+/**
+ * @file metrics.c
+ * @brief 指标注册及 Prometheus 文本导出实现文件
+ * @author moecly
+ */
+
+#include "../inc/metrics.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* 直方图每个 2 的幂区间内的子桶数及掩码 */
+#define METRICS_HIST_SUBS (1U << METRICS_HIST_SUB_BITS)
+#define METRICS_HIST_SUB_MASK (METRICS_HIST_SUBS - 1)
+
+/**
+ * @brief 指标描述，注册后不再修改
+ */
+typedef struct {
+  char name[METRICS_NAME_LEN]; /* 名称 */
+  char *help;                  /* 说明文字，可为 NULL */
+  metrics_type type;           /* 类型 */
+  uint32_t slot;               /* 在分片中的起始槽，仪表不使用 */
+  uint32_t buckets;            /* 直方图的有限桶数，其后依次为 +Inf 桶和总和 */
+} metrics_desc;
+
+/**
+ * @brief 线程私有的计数分片，只由所属线程写入
+ */
+typedef struct metrics_shard {
+  struct metrics_shard *prev;        /* 上一个分片 */
+  struct metrics_shard *next;        /* 下一个分片 */
+  uint64_t slots[METRICS_MAX_SLOTS]; /* 计数槽 */
+} metrics_shard;
+
+static pthread_mutex_t metrics_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t shard_once = PTHREAD_ONCE_INIT;
+static pthread_key_t shard_key;
+static __thread metrics_shard *thread_shard;
+
+static metrics_shard *shards;
+static uint64_t retired[METRICS_MAX_SLOTS];
+static metrics_desc descs[METRICS_MAX_METRICS];
+static int64_t gauges[METRICS_MAX_METRICS];
+static uint32_t metric_count;
+static uint32_t slot_count;
+
+/**
+ * @brief 线程退出时将分片的计数合并到全局计数并释放分片。
+ * @param arg 分片指针。
+ */
+static void metrics_shard_destroy(void *arg) {
+  metrics_shard *shard = (metrics_shard *)arg;
+  uint32_t i;
+
+  pthread_mutex_lock(&metrics_lock);
+  for (i = 0; i < slot_count; i++)
+    retired[i] += shard->slots[i];
+  if (shard->prev)
+    shard->prev->next = shard->next;
+  else
+    shards = shard->next;
+  if (shard->next)
+    shard->next->prev = shard->prev;
+  pthread_mutex_unlock(&metrics_lock);
+
+  thread_shard = NULL;
+  mem_free(NULL, shard);
+}
+
+/**
+ * @brief 创建线程退出时合并分片所用的键。
+ */
+static void metrics_key_create(void) {
+  pthread_key_create(&shard_key, metrics_shard_destroy);
+}
+
+/**
+ * @brief 获取当前线程的分片，首次调用时创建。
+ * @return 返回分片指针，内存不足返回 NULL。
+ */
+static metrics_shard *metrics_shard_get(void) {
+  metrics_shard *shard = thread_shard;
+
+  if (__builtin_expect(shard != NULL, 1))
+    return shard;
+
+  pthread_once(&shard_once, metrics_key_create);
+  shard = (metrics_shard *)mem_alloc(NULL, sizeof(metrics_shard));
+  if (!shard)
+    return NULL;
+  memset(shard, 0, sizeof(metrics_shard));
+
+  pthread_mutex_lock(&metrics_lock);
+  shard->prev = NULL;
+  shard->next = shards;
+  if (shards)
+    shards->prev = shard;
+  shards = shard;
+  pthread_mutex_unlock(&metrics_lock);
+
+  pthread_setspecific(shard_key, shard);
+  thread_shard = shard;
+  return shard;
+}
+
+/**
+ * @brief 分片中的槽只由本线程写入，使用 relaxed 存储供导出时读取。
+ * @param slot 槽编号。
+ * @param n 增加的值。
+ */
+static inline void metrics_slot_add(uint32_t slot, uint64_t n) {
+  metrics_shard *shard = metrics_shard_get();
+
+  if (!shard)
+    return;
+  __atomic_store_n(&shard->slots[slot], shard->slots[slot] + n,
+                   __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 合并各分片中某个槽的值，调用者需持有 metrics_lock。
+ * @param slot 槽编号。
+ * @return 返回合并后的值。
+ */
+static uint64_t metrics_slot_sum(uint32_t slot) {
+  uint64_t sum = retired[slot];
+  metrics_shard *shard;
+
+  for (shard = shards; shard; shard = shard->next)
+    sum += __atomic_load_n(&shard->slots[slot], __ATOMIC_RELAXED);
+  return sum;
+}
+
+/**
+ * @brief 计算值所在的直方图桶。
+ * @param val 值。
+ * @return 返回桶编号。
+ */
+static uint32_t metrics_bucket_index(uint64_t val) {
+  uint32_t e;
+
+  if (val < METRICS_HIST_SUBS)
+    return (uint32_t)val;
+  e = 63 - (uint32_t)__builtin_clzll(val);
+  return ((e - METRICS_HIST_SUB_BITS + 1) << METRICS_HIST_SUB_BITS) +
+         (uint32_t)((val >> (e - METRICS_HIST_SUB_BITS)) &
+                    METRICS_HIST_SUB_MASK);
+}
+
+/**
+ * @brief 计算直方图桶的上界，桶内的值均不大于该上界。
+ * @param idx 桶编号。
+ * @return 返回上界。
+ */
+static uint64_t metrics_bucket_upper(uint32_t idx) {
+  uint32_t shift;
+  uint64_t lower;
+
+  if (idx < METRICS_HIST_SUBS)
+    return idx;
+  shift = (idx >> METRICS_HIST_SUB_BITS) - 1;
+  lower = (uint64_t)(METRICS_HIST_SUBS + (idx & METRICS_HIST_SUB_MASK))
+          << shift;
+  return lower + ((UINT64_C(1) << shift) - 1);
+}
+
+/**
+ * @brief 判断名称是否符合 Prometheus 命名规则。
+ * @param name 名称。
+ * @return 符合返回 1，否则返回 0。
+ */
+static int metrics_name_valid(const char *name) {
+  size_t i;
+  char c;
+
+  if (!name || !name[0])
+    return 0;
+  for (i = 0; name[i]; i++) {
+    c = name[i];
+    if (i >= METRICS_NAME_LEN - 1)
+      return 0;
+    if (c == '_' || c == ':' || (c >= 'a' && c <= 'z') ||
+        (c >= 'A' && c <= 'Z'))
+      continue;
+    if (i && c >= '0' && c <= '9')
+      continue;
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * @brief 注册指标，同名同类型的指标已存在时返回其句柄。
+ * @param name 名称。
+ * @param help 说明文字，可为 NULL。
+ * @param type 类型。
+ * @param slots 需要的计数槽数。
+ * @param buckets 直方图的有限桶数。
+ * @return 返回句柄，失败返回 METRICS_INVALID_HANDLE。
+ */
+static metrics_handle metrics_register(const char *name, const char *help,
+                                       metrics_type type, uint32_t slots,
+                                       uint32_t buckets) {
+  metrics_handle handle = METRICS_INVALID_HANDLE;
+  metrics_desc *desc;
+  uint32_t i;
+
+  if (!metrics_name_valid(name))
+    return METRICS_INVALID_HANDLE;
+
+  pthread_mutex_lock(&metrics_lock);
+  for (i = 0; i < metric_count; i++) {
+    if (!strcmp(descs[i].name, name)) {
+      if (descs[i].type == type && descs[i].buckets == buckets)
+        handle = i + 1;
+      goto out;
+    }
+  }
+
+  if (metric_count >= METRICS_MAX_METRICS ||
+      slots > METRICS_MAX_SLOTS - slot_count)
+    goto out;
+
+  desc = &descs[metric_count];
+  desc->help = NULL;
+  if (help) {
+    desc->help = (char *)mem_alloc(NULL, strlen(help) + 1);
+    if (!desc->help)
+      goto out;
+    strcpy(desc->help, help);
+  }
+  strcpy(desc->name, name);
+  desc->type = type;
+  desc->slot = slot_count;
+  desc->buckets = buckets;
+  slot_count += slots;
+  handle = metric_count + 1;
+  __atomic_store_n(&metric_count, handle, __ATOMIC_RELEASE);
+
+out:
+  pthread_mutex_unlock(&metrics_lock);
+  return handle;
+}
+
+/**
+ * @brief 由句柄获取指标描述。
+ * @param handle 句柄。
+ * @param type 期望的类型。
+ * @return 返回指标描述，句柄无效或类型不符返回 NULL。
+ */
+static inline const metrics_desc *metrics_lookup(metrics_handle handle,
+                                                 metrics_type type) {
+  const metrics_desc *desc;
+
+  if (handle == METRICS_INVALID_HANDLE ||
+      handle > __atomic_load_n(&metric_count, __ATOMIC_ACQUIRE))
+    return NULL;
+  desc = &descs[handle - 1];
+  return desc->type == type ? desc : NULL;
+}
+
+/**
+ * @brief 注册计数器。
+ * @param name 指标名称。
+ * @param help 说明文字，可为 NULL。
+ * @return 返回句柄，失败返回 METRICS_INVALID_HANDLE。
+ */
+metrics_handle metrics_counter_register(const char *name, const char *help) {
+  return metrics_register(name, help, metrics_type_counter, 1, 0);
+}
+
+/**
+ * @brief 注册仪表。
+ * @param name 指标名称。
+ * @param help 说明文字，可为 NULL。
+ * @return 返回句柄，失败返回 METRICS_INVALID_HANDLE。
+ */
+metrics_handle metrics_gauge_register(const char *name, const char *help) {
+  return metrics_register(name, help, metrics_type_gauge, 0, 0);
+}
+
+/**
+ * @brief 注册直方图。
+ * @param name 指标名称。
+ * @param help 说明文字，可为 NULL。
+ * @param max 需要区分的最大值。
+ * @return 返回句柄，失败返回 METRICS_INVALID_HANDLE。
+ */
+metrics_handle metrics_histogram_register(const char *name, const char *help,
+                                          uint64_t max) {
+  uint32_t buckets = metrics_bucket_index(max) + 1;
+
+  /* 有限桶之后依次为 +Inf 桶和总和 */
+  return metrics_register(name, help, metrics_type_histogram, buckets + 2,
+                          buckets);
+}
+
+/**
+ * @brief 增加计数器的值。
+ * @param handle 计数器句柄。
+ * @param n 增加的值。
+ */
+void metrics_counter_add(metrics_handle handle, uint64_t n) {
+  const metrics_desc *desc = metrics_lookup(handle, metrics_type_counter);
+
+  if (desc)
+    metrics_slot_add(desc->slot, n);
+}
+
+/**
+ * @brief 设置仪表的值。
+ * @param handle 仪表句柄。
+ * @param val 新的值。
+ */
+void metrics_gauge_set(metrics_handle handle, int64_t val) {
+  if (metrics_lookup(handle, metrics_type_gauge))
+    __atomic_store_n(&gauges[handle - 1], val, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 增加仪表的值。
+ * @param handle 仪表句柄。
+ * @param n 增加的值，可为负数。
+ */
+void metrics_gauge_add(metrics_handle handle, int64_t n) {
+  if (metrics_lookup(handle, metrics_type_gauge))
+    __atomic_fetch_add(&gauges[handle - 1], n, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 向直方图记录一个值。
+ * @param handle 直方图句柄。
+ * @param val 记录的值。
+ */
+void metrics_histogram_observe(metrics_handle handle, uint64_t val) {
+  const metrics_desc *desc = metrics_lookup(handle, metrics_type_histogram);
+  metrics_shard *shard;
+  uint32_t idx;
+  uint64_t *slots;
+
+  if (!desc)
+    return;
+  shard = metrics_shard_get();
+  if (!shard)
+    return;
+
+  idx = metrics_bucket_index(val);
+  if (idx > desc->buckets)
+    idx = desc->buckets;
+  slots = shard->slots + desc->slot;
+  __atomic_store_n(&slots[idx], slots[idx] + 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&slots[desc->buckets + 1], slots[desc->buckets + 1] + val,
+                   __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 合并各线程分片，获取计数器的值。
+ * @param handle 计数器句柄。
+ * @return 返回计数器的值，句柄无效返回 0。
+ */
+uint64_t metrics_counter_get(metrics_handle handle) {
+  const metrics_desc *desc = metrics_lookup(handle, metrics_type_counter);
+  uint64_t val;
+
+  if (!desc)
+    return 0;
+  pthread_mutex_lock(&metrics_lock);
+  val = metrics_slot_sum(desc->slot);
+  pthread_mutex_unlock(&metrics_lock);
+  return val;
+}
+
+/**
+ * @brief 获取仪表的值。
+ * @param handle 仪表句柄。
+ * @return 返回仪表的值，句柄无效返回 0。
+ */
+int64_t metrics_gauge_get(metrics_handle handle) {
+  if (!metrics_lookup(handle, metrics_type_gauge))
+    return 0;
+  return __atomic_load_n(&gauges[handle - 1], __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 合并各线程分片，获取直方图的记录次数和总和。
+ * @param handle 直方图句柄。
+ * @param count 保存记录次数，可为 NULL。
+ * @param sum 保存记录值的总和，可为 NULL。
+ */
+void metrics_histogram_get(metrics_handle handle, uint64_t *count,
+                           uint64_t *sum) {
+  const metrics_desc *desc = metrics_lookup(handle, metrics_type_histogram);
+  uint64_t n = 0;
+  uint64_t s = 0;
+  uint32_t i;
+
+  if (desc) {
+    pthread_mutex_lock(&metrics_lock);
+    for (i = 0; i <= desc->buckets; i++)
+      n += metrics_slot_sum(desc->slot + i);
+    s = metrics_slot_sum(desc->slot + desc->buckets + 1);
+    pthread_mutex_unlock(&metrics_lock);
+  }
+  if (count)
+    *count = n;
+  if (sum)
+    *sum = s;
+}
+
+/**
+ * @brief 估算直方图的分位数。
+ * @param handle 直方图句柄。
+ * @param q 分位，取值 0 到 1。
+ * @return 返回分位数所在桶的上界，没有记录时返回 0。
+ */
+uint64_t metrics_histogram_percentile(metrics_handle handle, double q) {
+  const metrics_desc *desc = metrics_lookup(handle, metrics_type_histogram);
+  uint64_t result = 0;
+  uint64_t total = 0;
+  uint64_t target;
+  uint64_t seen = 0;
+  uint32_t i;
+
+  if (!desc)
+    return 0;
+  if (q < 0)
+    q = 0;
+  if (q > 1)
+    q = 1;
+
+  pthread_mutex_lock(&metrics_lock);
+  for (i = 0; i <= desc->buckets; i++)
+    total += metrics_slot_sum(desc->slot + i);
+  if (total) {
+    target = (uint64_t)(q * (double)total);
+    if (target < 1)
+      target = 1;
+    if (target > total)
+      target = total;
+    for (i = 0; i <= desc->buckets; i++) {
+      seen += metrics_slot_sum(desc->slot + i);
+      if (seen >= target)
+        break;
+    }
+    result = i < desc->buckets ? metrics_bucket_upper(i) : UINT64_MAX;
+  }
+  pthread_mutex_unlock(&metrics_lock);
+  return result;
+}
+
+/**
+ * @brief 导出时使用的输出缓冲区
+ */
+typedef struct {
+  char *buf;   /* 缓冲区 */
+  size_t size; /* 缓冲区字节数 */
+  size_t len;  /* 完整内容的字节数 */
+} metrics_writer;
+
+/**
+ * @brief 追加字节，超出缓冲区的部分只计入长度。
+ * @param w 输出缓冲区。
+ * @param s 字节。
+ * @param n 字节数。
+ */
+static void metrics_put(metrics_writer *w, const char *s, size_t n) {
+  size_t room;
+
+  if (w->len + 1 < w->size) {
+    room = w->size - 1 - w->len;
+    memcpy(w->buf + w->len, s, n < room ? n : room);
+  }
+  w->len += n;
+}
+
+/**
+ * @brief 追加格式化内容。
+ * @param w 输出缓冲区。
+ * @param format 格式化字符串。
+ */
+static void metrics_printf(metrics_writer *w, const char *format, ...) {
+  char line[METRICS_NAME_LEN + 96];
+  va_list args;
+  int n;
+
+  va_start(args, format);
+  n = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (n > 0)
+    metrics_put(w, line, (size_t)n < sizeof(line) ? (size_t)n
+                                                  : sizeof(line) - 1);
+}
+
+/**
+ * @brief 输出 HELP 和 TYPE 行，说明文字中的反斜杠和换行需要转义。
+ * @param w 输出缓冲区。
+ * @param desc 指标描述。
+ */
+static void metrics_put_header(metrics_writer *w, const metrics_desc *desc) {
+  static const char *type_names[] = {"counter", "gauge", "histogram"};
+  const char *p;
+
+  if (desc->help) {
+    metrics_printf(w, "# HELP %s ", desc->name);
+    for (p = desc->help; *p; p++) {
+      if (*p == '\\')
+        metrics_put(w, "\\\\", 2);
+      else if (*p == '\n')
+        metrics_put(w, "\\n", 2);
+      else
+        metrics_put(w, p, 1);
+    }
+    metrics_put(w, "\n", 1);
+  }
+  metrics_printf(w, "# TYPE %s %s\n", desc->name, type_names[desc->type]);
+}
+
+/**
+ * @brief 输出直方图的各桶、总和及次数，桶按 Prometheus 要求为累计值。
+ * @param w 输出缓冲区。
+ * @param desc 指标描述。
+ */
+static void metrics_put_histogram(metrics_writer *w, const metrics_desc *desc) {
+  uint64_t cumulative = 0;
+  uint32_t i;
+
+  for (i = 0; i < desc->buckets; i++) {
+    cumulative += metrics_slot_sum(desc->slot + i);
+    metrics_printf(w, "%s_bucket{le=\"%" PRIu64 "\"} %" PRIu64 "\n",
+                   desc->name, metrics_bucket_upper(i), cumulative);
+  }
+  cumulative += metrics_slot_sum(desc->slot + desc->buckets);
+  metrics_printf(w, "%s_bucket{le=\"+Inf\"} %" PRIu64 "\n", desc->name,
+                 cumulative);
+  metrics_printf(w, "%s_sum %" PRIu64 "\n", desc->name,
+                 metrics_slot_sum(desc->slot + desc->buckets + 1));
+  metrics_printf(w, "%s_count %" PRIu64 "\n", desc->name, cumulative);
+}
+
+/**
+ * @brief 以 Prometheus 文本格式导出全部指标到缓冲区。
+ * @param buf 缓冲区，size 为 0 时可为 NULL。
+ * @param size 缓冲区字节数。
+ * @return 返回完整内容的字节数，不含结尾的 '\0'。
+ */
+size_t metrics_export(char *buf, size_t size) {
+  metrics_writer w = {buf, size, 0};
+  const metrics_desc *desc;
+  uint32_t i;
+
+  pthread_mutex_lock(&metrics_lock);
+  for (i = 0; i < metric_count; i++) {
+    desc = &descs[i];
+    metrics_put_header(&w, desc);
+    switch (desc->type) {
+    case metrics_type_counter:
+      metrics_printf(&w, "%s %" PRIu64 "\n", desc->name,
+                     metrics_slot_sum(desc->slot));
+      break;
+    case metrics_type_gauge:
+      metrics_printf(&w, "%s %" PRId64 "\n", desc->name,
+                     __atomic_load_n(&gauges[i], __ATOMIC_RELAXED));
+      break;
+    case metrics_type_histogram:
+      metrics_put_histogram(&w, desc);
+      break;
+    }
+  }
+  pthread_mutex_unlock(&metrics_lock);
+
+  if (size)
+    buf[w.len < size ? w.len : size - 1] = '\0';
+  return w.len;
+}
+
+/**
+ * @brief 以 Prometheus 文本格式导出全部指标到文件描述符。
+ *
+ * 先导出到临时缓冲区，写入时不持有锁，避免慢速的描述符阻塞注册和线程退出。
+ *
+ * @param fd 文件描述符。
+ * @return 成功返回 ret_ok，写入失败返回 ret_err。
+ */
+ret_val metrics_export_fd(int fd) {
+  size_t size = 4096;
+  size_t len;
+  size_t off;
+  ssize_t n;
+  char *buf;
+
+  for (;;) {
+    buf = (char *)mem_alloc(NULL, size);
+    if (!buf)
+      return ret_err;
+    len = metrics_export(buf, size);
+    if (len < size)
+      break;
+    mem_free(NULL, buf);
+    size = len + 1;
+  }
+
+  for (off = 0; off < len; off += (size_t)n) {
+    n = write(fd, buf + off, len - off);
+    if (n < 0 && errno == EINTR) {
+      n = 0;
+      continue;
+    }
+    if (n <= 0) {
+      mem_free(NULL, buf);
+      return ret_err;
+    }
+  }
+  mem_free(NULL, buf);
+  return ret_ok;
+}
@@ -0,0 +1,236 @@
+/**
+ * @file obj_pool.c
+ * @brief 按类型生成的对象池实现文件
+ * @author moecly
+ */
+
+#include "../inc/obj_pool.h"
+
+/* 仓库栈顶中指针占用的位数，其余高位为版本号 */
+#define OBJ_POOL_PTR_BITS 48
+#define OBJ_POOL_PTR_MASK ((UINT64_C(1) << OBJ_POOL_PTR_BITS) - 1)
+#define OBJ_POOL_TAG_ONE (UINT64_C(1) << OBJ_POOL_PTR_BITS)
+
+/* 内存块头部大小，保持对象按 16 字节对齐 */
+#define OBJ_POOL_CHUNK_HEADER 16
+
+/* 空闲对象的第一个字保存同一弹匣的下一个对象 */
+#define OBJ_POOL_NEXT(obj) (((void **)(obj))[0])
+
+/* 弹匣首对象的第二个字保存仓库中的下一个弹匣 */
+#define OBJ_POOL_BATCH_NEXT(obj) (((void **)(obj))[1])
+
+/* 弹匣首对象的第三个字保存弹匣的对象数 */
+#define OBJ_POOL_BATCH_COUNT(obj) (((uintptr_t *)(obj))[2])
+
+static __thread obj_pool_magazine *thread_magazines;
+static pthread_key_t magazine_key;
+static pthread_once_t magazine_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief 将弹匣压入仓库栈，每次修改栈顶时递增版本号以避免 ABA 问题。
+ * @param pool 对象池指针。
+ * @param batch 弹匣首对象。
+ * @param count 弹匣的对象数。
+ */
+static void obj_pool_depot_push(obj_pool *pool, void *batch, uint32_t count) {
+  uint64_t old = __atomic_load_n(&pool->depot, __ATOMIC_RELAXED);
+  uint64_t top;
+
+  OBJ_POOL_BATCH_COUNT(batch) = count;
+  do {
+    __atomic_store_n(&OBJ_POOL_BATCH_NEXT(batch),
+                     (void *)(uintptr_t)(old & OBJ_POOL_PTR_MASK),
+                     __ATOMIC_RELAXED);
+    top = (uint64_t)(uintptr_t)batch |
+          ((old & ~OBJ_POOL_PTR_MASK) + OBJ_POOL_TAG_ONE);
+  } while (!__atomic_compare_exchange_n(&pool->depot, &old, top, 1,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/**
+ * @brief 从仓库栈弹出一个弹匣。
+ *
+ * 读取的栈顶可能已被其他线程弹出并使用，但对象内存不会释放，读到的旧值
+ * 会因版本号变化导致比较交换失败。
+ *
+ * @param pool 对象池指针。
+ * @return 返回弹匣首对象，仓库为空返回 NULL。
+ */
+static void *obj_pool_depot_pop(obj_pool *pool) {
+  uint64_t old = __atomic_load_n(&pool->depot, __ATOMIC_ACQUIRE);
+  uint64_t top;
+  void *batch;
+  void *next;
+
+  do {
+    batch = (void *)(uintptr_t)(old & OBJ_POOL_PTR_MASK);
+    if (!batch)
+      return NULL;
+    next = __atomic_load_n(&OBJ_POOL_BATCH_NEXT(batch), __ATOMIC_RELAXED);
+    top = (uint64_t)(uintptr_t)next |
+          ((old & ~OBJ_POOL_PTR_MASK) + OBJ_POOL_TAG_ONE);
+  } while (!__atomic_compare_exchange_n(&pool->depot, &old, top, 1,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+  return batch;
+}
+
+/**
+ * @brief 申请新的内存块并切分为若干满弹匣，除第一个外全部放入仓库。
+ * @param pool 对象池指针。
+ * @return 返回第一个弹匣的首对象，内存不足返回 NULL。
+ */
+static void *obj_pool_carve(obj_pool *pool) {
+  uint32_t nobjs = OBJ_POOL_MAGAZINE_SIZE * OBJ_POOL_CHUNK_MAGAZINES;
+  size_t bytes = OBJ_POOL_CHUNK_HEADER + pool->slot_size * nobjs;
+  char *chunk = (char *)mem_alloc(NULL, bytes);
+  char *obj;
+  void *first = NULL;
+  uint32_t m;
+  uint32_t i;
+
+  if (!chunk)
+    return NULL;
+
+  pthread_mutex_lock(&pool->lock);
+  *(void **)chunk = pool->chunks;
+  pool->chunks = chunk;
+  pool->chunk_bytes += bytes;
+  pthread_mutex_unlock(&pool->lock);
+
+  obj = chunk + OBJ_POOL_CHUNK_HEADER;
+  for (m = 0; m < OBJ_POOL_CHUNK_MAGAZINES; m++) {
+    void *head = obj;
+
+    for (i = 0; i < OBJ_POOL_MAGAZINE_SIZE - 1; i++) {
+      OBJ_POOL_NEXT(obj) = obj + pool->slot_size;
+      obj += pool->slot_size;
+    }
+    OBJ_POOL_NEXT(obj) = NULL;
+    obj += pool->slot_size;
+
+    if (first) {
+      obj_pool_depot_push(pool, head, OBJ_POOL_MAGAZINE_SIZE);
+    } else {
+      OBJ_POOL_BATCH_COUNT(head) = OBJ_POOL_MAGAZINE_SIZE;
+      first = head;
+    }
+  }
+  return first;
+}
+
+/**
+ * @brief 将弹匣中的对象全部归还到仓库。
+ * @param mag 弹匣指针。
+ */
+static void obj_pool_magazine_flush(obj_pool_magazine *mag) {
+  if (mag->cur) {
+    obj_pool_depot_push(mag->pool, mag->cur, mag->cur_count);
+    mag->cur = NULL;
+    mag->cur_count = 0;
+  }
+  if (mag->spare) {
+    obj_pool_depot_push(mag->pool, mag->spare, OBJ_POOL_MAGAZINE_SIZE);
+    mag->spare = NULL;
+  }
+}
+
+/**
+ * @brief 线程退出时归还该线程全部弹匣中的对象。
+ * @param arg 未使用。
+ */
+static void obj_pool_thread_exit(void *arg) {
+  obj_pool_magazine *mag;
+  obj_pool_magazine *next;
+
+  UNUSED(arg);
+  for (mag = thread_magazines; mag; mag = next) {
+    next = mag->next;
+    obj_pool_magazine_flush(mag);
+    mag->pool = NULL;
+    mag->next = NULL;
+  }
+  thread_magazines = NULL;
+}
+
+/**
+ * @brief 创建线程退出时归还弹匣的键。
+ */
+static void obj_pool_key_create(void) {
+  pthread_key_create(&magazine_key, obj_pool_thread_exit);
+}
+
+/**
+ * @brief 注册当前线程的弹匣，线程退出时归还其中的对象。
+ * @param pool 对象池指针。
+ * @param mag 弹匣指针。
+ */
+static void obj_pool_register(obj_pool *pool, obj_pool_magazine *mag) {
+  pthread_once(&magazine_once, obj_pool_key_create);
+  mag->pool = pool;
+  mag->next = thread_magazines;
+  thread_magazines = mag;
+  pthread_setspecific(magazine_key, &thread_magazines);
+}
+
+/**
+ * @brief 当前弹匣为空时取出一个对象，由 DEFINE_POOL 生成的函数调用。
+ * @param pool 对象池指针。
+ * @param mag 当前线程的弹匣。
+ * @return 返回对象指针，内存不足返回 NULL。
+ */
+void *obj_pool_get_slow(obj_pool *pool, obj_pool_magazine *mag) {
+  void *batch;
+  void *obj;
+
+  if (!mag->pool)
+    obj_pool_register(pool, mag);
+
+  if (mag->spare) {
+    mag->cur = mag->spare;
+    mag->cur_count = OBJ_POOL_MAGAZINE_SIZE;
+    mag->spare = NULL;
+  } else {
+    batch = obj_pool_depot_pop(pool);
+    if (!batch)
+      batch = obj_pool_carve(pool);
+    if (!batch)
+      return NULL;
+    mag->cur = batch;
+    mag->cur_count = (uint32_t)OBJ_POOL_BATCH_COUNT(batch);
+  }
+
+  obj = mag->cur;
+  mag->cur = OBJ_POOL_NEXT(obj);
+  mag->cur_count--;
+  return obj;
+}
+
+/**
+ * @brief 弹匣未注册或当前弹匣已满时腾出空间，由 DEFINE_POOL 生成的函数调用。
+ * @param pool 对象池指针。
+ * @param mag 当前线程的弹匣，返回后当前弹匣可再放入一个对象。
+ */
+void obj_pool_put_slow(obj_pool *pool, obj_pool_magazine *mag) {
+  if (!mag->pool)
+    obj_pool_register(pool, mag);
+  if (mag->cur_count < OBJ_POOL_MAGAZINE_SIZE)
+    return;
+
+  /* 备用弹匣已满时先归还到仓库，再将当前弹匣作为备用弹匣 */
+  if (mag->spare)
+    obj_pool_depot_push(pool, mag->spare, OBJ_POOL_MAGAZINE_SIZE);
+  mag->spare = mag->cur;
+  mag->cur = NULL;
+  mag->cur_count = 0;
+}
+
+/**
+ * @brief 将当前线程所有弹匣中的对象归还到各自的仓库。
+ */
+void obj_pool_thread_flush(void) {
+  obj_pool_magazine *mag;
+
+  for (mag = thread_magazines; mag; mag = mag->next)
+    obj_pool_magazine_flush(mag);
+}
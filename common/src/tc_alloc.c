@@ -0,0 +1,706 @@
+/**
+ * @file tc_alloc.c
+ * @brief 线程缓存的小对象分配器实现文件
+ * @author moecly
+ */
+
+#include "../inc/tc_alloc.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* 大对象的尺寸类标记 */
+#define TC_ALLOC_LARGE UINT32_MAX
+
+/* 每批次对象的总字节数，以及批次对象数的上下限 */
+#define TC_ALLOC_BATCH_BYTES 8192
+#define TC_ALLOC_BATCH_MIN 4
+#define TC_ALLOC_BATCH_MAX 64
+
+/* 空闲对象的第一个字保存同一批次的下一个对象 */
+#define TC_OBJ_NEXT(obj) (((void **)(obj))[0])
+
+/* 批次首对象的第二个字保存下一个批次 */
+#define TC_BATCH_NEXT(obj) (((void **)(obj))[1])
+
+/**
+ * @brief span 头部，位于按 TC_ALLOC_SPAN_SIZE 对齐的映射起始处
+ */
+typedef struct tc_span {
+  struct tc_span *next; /* 同一尺寸类的下一个 span */
+  size_t map_size;      /* 映射的字节数 */
+  uint32_t cls;         /* 尺寸类，大对象为 TC_ALLOC_LARGE */
+  uint32_t offset;      /* 对象相对 span 起始的偏移 */
+  uint32_t nobjs;       /* span 中的对象数 */
+  uint32_t trim_free;   /* 整理时统计的空闲对象数 */
+} tc_span;
+
+/**
+ * @brief 线程缓存中单个尺寸类的空闲对象链表
+ */
+typedef struct {
+  void *head;     /* 空闲对象链表 */
+  uint32_t count; /* 空闲对象数 */
+} tc_bin;
+
+/**
+ * @brief 线程缓存
+ */
+typedef struct {
+  tc_bin bins[TC_ALLOC_CLASSES]; /* 各尺寸类的空闲对象 */
+  int registered;                /* 是否已注册线程退出时的归还函数 */
+} tc_cache;
+
+/**
+ * @brief 单个尺寸类的中心仓库
+ */
+typedef struct {
+  pthread_mutex_t lock;  /* 保护仓库的互斥锁 */
+  void *batches;         /* 满批次链表 */
+  void *loose;           /* 不足一批的空闲对象链表 */
+  uint32_t loose_count;  /* 不足一批的空闲对象数 */
+  size_t free_objs;      /* 仓库中的空闲对象总数 */
+  tc_span *spans;        /* 该尺寸类申请的全部 span */
+} tc_depot;
+
+static tc_depot depots[TC_ALLOC_CLASSES] = {
+    [0 ... TC_ALLOC_CLASSES - 1] = {.lock = PTHREAD_MUTEX_INITIALIZER},
+};
+
+static __thread tc_cache thread_cache;
+static pthread_key_t cache_key;
+static pthread_once_t cache_once = PTHREAD_ONCE_INIT;
+
+static size_t span_bytes;
+static size_t span_count;
+static size_t large_bytes;
+static size_t large_count;
+
+/**
+ * @brief 根据字节数计算尺寸类。
+ * @param size 字节数，不超过 TC_ALLOC_MAX_SIZE。
+ * @return 返回尺寸类。
+ */
+static uint32_t tc_size_class(size_t size) {
+  uint32_t shift;
+
+  if (size <= 256)
+    return size ? (uint32_t)((size + 15) >> 4) - 1 : 0;
+
+  /* 每个 2 的幂区间均分为 4 个尺寸类 */
+  shift = 63 - (uint32_t)__builtin_clzll(size - 1);
+  return 16 + (shift - 8) * 4 + (uint32_t)((size - 1 - (1UL << shift)) >>
+                                           (shift - 2));
+}
+
+/**
+ * @brief 获取尺寸类的对象字节数。
+ * @param cls 尺寸类。
+ * @return 返回对象字节数。
+ */
+static size_t tc_class_size(uint32_t cls) {
+  uint32_t group;
+
+  if (cls < 16)
+    return (size_t)(cls + 1) << 4;
+
+  group = (cls - 16) >> 2;
+  return (256UL << group) + (((cls - 16) & 3) + 1) * (64UL << group);
+}
+
+/**
+ * @brief 获取尺寸类每批次交换的对象数。
+ * @param cls 尺寸类。
+ * @return 返回批次对象数。
+ */
+static uint32_t tc_batch_size(uint32_t cls) {
+  size_t n = TC_ALLOC_BATCH_BYTES / tc_class_size(cls);
+
+  if (n < TC_ALLOC_BATCH_MIN)
+    return TC_ALLOC_BATCH_MIN;
+  if (n > TC_ALLOC_BATCH_MAX)
+    return TC_ALLOC_BATCH_MAX;
+  return (uint32_t)n;
+}
+
+/**
+ * @brief 获取对象所属的 span。
+ * @param ptr 对象指针。
+ * @return 返回 span 指针。
+ */
+static tc_span *tc_span_of(void *ptr) {
+  return (tc_span *)((uintptr_t)ptr & ~(uintptr_t)(TC_ALLOC_SPAN_SIZE - 1));
+}
+
+/**
+ * @brief 映射按 TC_ALLOC_SPAN_SIZE 对齐的匿名内存。
+ * @param size 字节数，需为页大小的整数倍。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+static void *tc_map_aligned(size_t size) {
+  uintptr_t raw;
+  uintptr_t aligned;
+  size_t head;
+  void *ptr;
+
+  ptr = mmap(NULL, size + TC_ALLOC_SPAN_SIZE, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED)
+    return NULL;
+
+  /* 多映射一个 span，再裁掉首尾未对齐的部分 */
+  raw = (uintptr_t)ptr;
+  aligned = (raw + TC_ALLOC_SPAN_SIZE - 1) &
+            ~(uintptr_t)(TC_ALLOC_SPAN_SIZE - 1);
+  head = aligned - raw;
+  if (head)
+    munmap(ptr, head);
+  if (TC_ALLOC_SPAN_SIZE - head)
+    munmap((void *)(aligned + size), TC_ALLOC_SPAN_SIZE - head);
+  return (void *)aligned;
+}
+
+/**
+ * @brief 通过 mmap 申请大对象。
+ * @param offset 对象相对映射起始的偏移，不小于 TC_ALLOC_SPAN_HEADER。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+static void *tc_large_alloc(size_t offset, size_t size) {
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t map_size;
+  tc_span *span;
+
+  if (size > SIZE_MAX - offset - page - TC_ALLOC_SPAN_SIZE)
+    return NULL;
+
+  map_size = (offset + size + page - 1) & ~(page - 1);
+  span = (tc_span *)tc_map_aligned(map_size);
+  if (!span)
+    return NULL;
+
+  span->next = NULL;
+  span->map_size = map_size;
+  span->cls = TC_ALLOC_LARGE;
+  span->offset = (uint32_t)offset;
+  span->nobjs = 1;
+  __atomic_fetch_add(&large_bytes, map_size, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&large_count, 1, __ATOMIC_RELAXED);
+  return (char *)span + offset;
+}
+
+/**
+ * @brief 释放大对象。
+ * @param span 大对象所在的 span。
+ */
+static void tc_large_free(tc_span *span) {
+  __atomic_fetch_sub(&large_bytes, span->map_size, __ATOMIC_RELAXED);
+  __atomic_fetch_sub(&large_count, 1, __ATOMIC_RELAXED);
+  munmap(span, span->map_size);
+}
+
+/**
+ * @brief 将对象链表按批次放入仓库，调用者需持有仓库锁。
+ * @param depot 仓库指针。
+ * @param cls 尺寸类。
+ * @param head 对象链表，以 NULL 结尾。
+ * @param count 对象数。
+ */
+static void tc_depot_put_locked(tc_depot *depot, uint32_t cls, void *head,
+                                uint32_t count) {
+  uint32_t batch = tc_batch_size(cls);
+  void *tail;
+  void *obj;
+  uint32_t i;
+
+  depot->free_objs += count;
+  while (count >= batch) {
+    tail = head;
+    for (i = 1; i < batch; i++)
+      tail = TC_OBJ_NEXT(tail);
+    obj = head;
+    head = TC_OBJ_NEXT(tail);
+    TC_OBJ_NEXT(tail) = NULL;
+    TC_BATCH_NEXT(obj) = depot->batches;
+    depot->batches = obj;
+    count -= batch;
+  }
+
+  /* 剩余不足一批的对象挂到零散链表 */
+  while (head) {
+    obj = head;
+    head = TC_OBJ_NEXT(obj);
+    TC_OBJ_NEXT(obj) = depot->loose;
+    depot->loose = obj;
+    depot->loose_count++;
+  }
+}
+
+/**
+ * @brief 将对象链表归还仓库。
+ * @param cls 尺寸类。
+ * @param head 对象链表，以 NULL 结尾。
+ * @param count 对象数。
+ */
+static void tc_depot_put(uint32_t cls, void *head, uint32_t count) {
+  tc_depot *depot = &depots[cls];
+
+  pthread_mutex_lock(&depot->lock);
+  tc_depot_put_locked(depot, cls, head, count);
+  pthread_mutex_unlock(&depot->lock);
+}
+
+/**
+ * @brief 申请新的 span 并切分为对象链表。
+ * @param cls 尺寸类。
+ * @return 返回 span 指针，失败返回 NULL。
+ */
+static tc_span *tc_span_new(uint32_t cls) {
+  size_t size = tc_class_size(cls);
+  tc_span *span;
+  char *obj;
+  uint32_t i;
+
+  span = (tc_span *)tc_map_aligned(TC_ALLOC_SPAN_SIZE);
+  if (!span)
+    return NULL;
+
+  span->map_size = TC_ALLOC_SPAN_SIZE;
+  span->cls = cls;
+  span->offset = TC_ALLOC_SPAN_HEADER;
+  span->nobjs = (uint32_t)((TC_ALLOC_SPAN_SIZE - TC_ALLOC_SPAN_HEADER) / size);
+  span->trim_free = 0;
+
+  obj = (char *)span + TC_ALLOC_SPAN_HEADER;
+  for (i = 0; i + 1 < span->nobjs; i++, obj += size)
+    TC_OBJ_NEXT(obj) = obj + size;
+  TC_OBJ_NEXT(obj) = NULL;
+
+  __atomic_fetch_add(&span_bytes, TC_ALLOC_SPAN_SIZE, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&span_count, 1, __ATOMIC_RELAXED);
+  return span;
+}
+
+/**
+ * @brief 从仓库取一批对象填充线程缓存，仓库为空时申请新的 span。
+ * @param bin 线程缓存中对应尺寸类的链表。
+ * @param cls 尺寸类。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err。
+ */
+static ret_val tc_depot_refill(tc_bin *bin, uint32_t cls) {
+  tc_depot *depot = &depots[cls];
+  uint32_t batch = tc_batch_size(cls);
+  tc_span *span;
+  void *head;
+  void *tail;
+  uint32_t i;
+
+  pthread_mutex_lock(&depot->lock);
+  if (depot->batches) {
+    head = depot->batches;
+    depot->batches = TC_BATCH_NEXT(head);
+    depot->free_objs -= batch;
+    pthread_mutex_unlock(&depot->lock);
+    bin->head = head;
+    bin->count = batch;
+    return ret_ok;
+  }
+
+  if (depot->loose) {
+    bin->head = depot->loose;
+    bin->count = depot->loose_count;
+    depot->free_objs -= depot->loose_count;
+    depot->loose = NULL;
+    depot->loose_count = 0;
+    pthread_mutex_unlock(&depot->lock);
+    return ret_ok;
+  }
+  pthread_mutex_unlock(&depot->lock);
+
+  /* 在锁外映射并切分新的 span */
+  span = tc_span_new(cls);
+  if (!span)
+    return ret_err;
+
+  head = (char *)span + TC_ALLOC_SPAN_HEADER;
+  tail = head;
+  for (i = 1; i < batch && i < span->nobjs; i++)
+    tail = TC_OBJ_NEXT(tail);
+  bin->head = head;
+  bin->count = i;
+  head = TC_OBJ_NEXT(tail);
+  TC_OBJ_NEXT(tail) = NULL;
+
+  pthread_mutex_lock(&depot->lock);
+  span->next = depot->spans;
+  depot->spans = span;
+  if (head)
+    tc_depot_put_locked(depot, cls, head, span->nobjs - i);
+  pthread_mutex_unlock(&depot->lock);
+  return ret_ok;
+}
+
+/**
+ * @brief 将线程缓存的全部空闲对象归还仓库。
+ * @param cache 线程缓存指针。
+ */
+static void tc_cache_flush(tc_cache *cache) {
+  tc_bin *bin;
+  uint32_t cls;
+
+  for (cls = 0; cls < TC_ALLOC_CLASSES; cls++) {
+    bin = &cache->bins[cls];
+    if (!bin->head)
+      continue;
+    tc_depot_put(cls, bin->head, bin->count);
+    bin->head = NULL;
+    bin->count = 0;
+  }
+}
+
+/**
+ * @brief 线程退出时归还线程缓存。
+ *
+ * 清除注册标记，之后运行的其他析构函数再申请或释放内存时重新注册，
+ * 线程库会再次调用本函数归还。
+ *
+ * @param arg 线程缓存指针。
+ */
+static void tc_cache_destroy(void *arg) {
+  tc_cache *cache = (tc_cache *)arg;
+
+  tc_cache_flush(cache);
+  cache->registered = 0;
+}
+
+/**
+ * @brief 创建线程退出时归还线程缓存所用的键。
+ */
+static void tc_cache_key_create(void) {
+  pthread_key_create(&cache_key, tc_cache_destroy);
+}
+
+/**
+ * @brief 为当前线程注册退出时的归还函数。
+ */
+static void tc_cache_register(void) {
+  pthread_once(&cache_once, tc_cache_key_create);
+  pthread_setspecific(cache_key, &thread_cache);
+  thread_cache.registered = 1;
+}
+
+/**
+ * @brief 申请内存，按 16 字节对齐。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+void *tc_malloc(size_t size) {
+  tc_bin *bin;
+  uint32_t cls;
+  void *obj;
+
+  if (size > TC_ALLOC_MAX_SIZE)
+    return tc_large_alloc(TC_ALLOC_SPAN_HEADER, size);
+
+  cls = tc_size_class(size);
+  bin = &thread_cache.bins[cls];
+  if (!bin->head) {
+    if (!thread_cache.registered)
+      tc_cache_register();
+    if (tc_depot_refill(bin, cls) != ret_ok)
+      return NULL;
+  }
+
+  obj = bin->head;
+  bin->head = TC_OBJ_NEXT(obj);
+  bin->count--;
+  return obj;
+}
+
+/**
+ * @brief 释放 tc_malloc() 系列函数申请的内存。
+ * @param ptr 内存指针，可为 NULL。
+ */
+void tc_free(void *ptr) {
+  tc_span *span;
+  tc_bin *bin;
+  uint32_t batch;
+  uint32_t i;
+  void *tail;
+  void *head;
+
+  if (!ptr)
+    return;
+
+  span = tc_span_of(ptr);
+  if (span->cls == TC_ALLOC_LARGE) {
+    tc_large_free(span);
+    return;
+  }
+
+  if (!thread_cache.registered)
+    tc_cache_register();
+  bin = &thread_cache.bins[span->cls];
+  TC_OBJ_NEXT(ptr) = bin->head;
+  bin->head = ptr;
+  bin->count++;
+
+  /* 缓存超过两批时归还一批，避免对象在单个线程中堆积 */
+  batch = tc_batch_size(span->cls);
+  if (bin->count < batch * 2)
+    return;
+
+  head = bin->head;
+  tail = head;
+  for (i = 1; i < batch; i++)
+    tail = TC_OBJ_NEXT(tail);
+  bin->head = TC_OBJ_NEXT(tail);
+  bin->count -= batch;
+  TC_OBJ_NEXT(tail) = NULL;
+  tc_depot_put(span->cls, head, batch);
+}
+
+/**
+ * @brief 调整内存大小，新大小仍属于同一尺寸类时原地返回。
+ * @param ptr 原内存指针，可为 NULL。
+ * @param size 新的字节数。
+ * @return 返回新的内存指针，失败返回 NULL 且原内存不变。
+ */
+void *tc_realloc(void *ptr, size_t size) {
+  tc_span *span;
+  size_t old_size;
+  void *new_ptr;
+
+  if (!ptr)
+    return tc_malloc(size);
+
+  span = tc_span_of(ptr);
+  if (span->cls == TC_ALLOC_LARGE) {
+    old_size = span->map_size - span->offset;
+    if (size <= old_size && size > TC_ALLOC_MAX_SIZE)
+      return ptr;
+  } else {
+    old_size = tc_class_size(span->cls);
+    if (size <= TC_ALLOC_MAX_SIZE && tc_size_class(size) == span->cls)
+      return ptr;
+  }
+
+  new_ptr = tc_malloc(size);
+  if (!new_ptr)
+    return NULL;
+  memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+  tc_free(ptr);
+  return new_ptr;
+}
+
+/**
+ * @brief 按对齐要求申请内存，可用 tc_free() 释放。
+ * @param align 对齐字节数，需为 2 的幂且不超过 TC_ALLOC_SPAN_SIZE / 2。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+void *tc_aligned_alloc(size_t align, size_t size) {
+  tc_bin *bin;
+  uint32_t cls;
+  void *obj;
+
+  if (align <= 16)
+    return tc_malloc(size);
+
+  /* span 中的对象从 TC_ALLOC_SPAN_HEADER 处开始，尺寸为 align 整数倍的
+   * 尺寸类天然满足对齐要求 */
+  if (align <= TC_ALLOC_SPAN_HEADER && size <= TC_ALLOC_MAX_SIZE) {
+    cls = tc_size_class(size);
+    while (cls < TC_ALLOC_CLASSES && tc_class_size(cls) % align)
+      cls++;
+    if (cls < TC_ALLOC_CLASSES) {
+      bin = &thread_cache.bins[cls];
+      if (!bin->head) {
+        if (!thread_cache.registered)
+          tc_cache_register();
+        if (tc_depot_refill(bin, cls) != ret_ok)
+          return NULL;
+      }
+      obj = bin->head;
+      bin->head = TC_OBJ_NEXT(obj);
+      bin->count--;
+      return obj;
+    }
+  }
+
+  if (align > TC_ALLOC_SPAN_SIZE / 2)
+    return NULL;
+  return tc_large_alloc(align > TC_ALLOC_SPAN_HEADER ? align
+                                                     : TC_ALLOC_SPAN_HEADER,
+                        size);
+}
+
+/**
+ * @brief 将当前线程缓存的空闲对象全部归还中心仓库。
+ */
+void tc_alloc_thread_trim(void) { tc_cache_flush(&thread_cache); }
+
+/**
+ * @brief 释放单个仓库中完全空闲的 span。
+ * @param cls 尺寸类。
+ */
+static void tc_depot_trim(uint32_t cls) {
+  tc_depot *depot = &depots[cls];
+  tc_span **link;
+  tc_span *span;
+  void *batch;
+  void *keep = NULL;
+  uint32_t kept = 0;
+  void *obj;
+  void *next;
+
+  pthread_mutex_lock(&depot->lock);
+  if (!depot->spans) {
+    pthread_mutex_unlock(&depot->lock);
+    return;
+  }
+
+  /* 将仓库中的对象串成一条链表，并统计每个 span 的空闲对象数 */
+  for (span = depot->spans; span; span = span->next)
+    span->trim_free = 0;
+  for (batch = depot->batches; batch; batch = next) {
+    next = TC_BATCH_NEXT(batch);
+    for (obj = batch; obj; obj = TC_OBJ_NEXT(obj))
+      tc_span_of(obj)->trim_free++;
+  }
+  for (obj = depot->loose; obj; obj = TC_OBJ_NEXT(obj))
+    tc_span_of(obj)->trim_free++;
+
+  /* 只保留仍有对象在使用的 span 中的空闲对象 */
+  for (batch = depot->batches; batch; batch = next) {
+    next = TC_BATCH_NEXT(batch);
+    for (obj = batch; obj; obj = TC_OBJ_NEXT(obj))
+      if (tc_span_of(obj)->trim_free != tc_span_of(obj)->nobjs) {
+        TC_BATCH_NEXT(obj) = keep;
+        keep = obj;
+        kept++;
+      }
+  }
+  for (obj = depot->loose; obj; obj = TC_OBJ_NEXT(obj))
+    if (tc_span_of(obj)->trim_free != tc_span_of(obj)->nobjs) {
+      TC_BATCH_NEXT(obj) = keep;
+      keep = obj;
+      kept++;
+    }
+
+  link = &depot->spans;
+  while ((span = *link)) {
+    if (span->trim_free == span->nobjs) {
+      *link = span->next;
+      __atomic_fetch_sub(&span_bytes, span->map_size, __ATOMIC_RELAXED);
+      __atomic_fetch_sub(&span_count, 1, __ATOMIC_RELAXED);
+      munmap(span, span->map_size);
+    } else {
+      link = &span->next;
+    }
+  }
+
+  /* 保留的对象暂存在第二个字中，重新串联后按批次放回仓库 */
+  for (obj = keep; obj; obj = TC_BATCH_NEXT(obj))
+    TC_OBJ_NEXT(obj) = TC_BATCH_NEXT(obj);
+  depot->batches = NULL;
+  depot->loose = NULL;
+  depot->loose_count = 0;
+  depot->free_objs = 0;
+  if (keep)
+    tc_depot_put_locked(depot, cls, keep, kept);
+  pthread_mutex_unlock(&depot->lock);
+}
+
+/**
+ * @brief 归还当前线程缓存，并将中心仓库中完全空闲的 span 释放给系统。
+ */
+void tc_alloc_trim(void) {
+  uint32_t cls;
+
+  tc_alloc_thread_trim();
+  for (cls = 0; cls < TC_ALLOC_CLASSES; cls++)
+    tc_depot_trim(cls);
+}
+
+/**
+ * @brief 获取分配器统计信息。
+ * @param stats 存储统计信息的结构体指针。
+ */
+void tc_alloc_get_stats(tc_alloc_stats *stats) {
+  tc_depot *depot;
+  uint32_t cls;
+
+  stats->span_bytes = __atomic_load_n(&span_bytes, __ATOMIC_RELAXED);
+  stats->spans = __atomic_load_n(&span_count, __ATOMIC_RELAXED);
+  stats->large_bytes = __atomic_load_n(&large_bytes, __ATOMIC_RELAXED);
+  stats->large_objs = __atomic_load_n(&large_count, __ATOMIC_RELAXED);
+  stats->depot_bytes = 0;
+  stats->thread_bytes = 0;
+  for (cls = 0; cls < TC_ALLOC_CLASSES; cls++) {
+    depot = &depots[cls];
+    pthread_mutex_lock(&depot->lock);
+    stats->depot_bytes += depot->free_objs * tc_class_size(cls);
+    pthread_mutex_unlock(&depot->lock);
+    stats->thread_bytes +=
+        (size_t)thread_cache.bins[cls].count * tc_class_size(cls);
+  }
+}
+
+/**
+ * @brief 分配器接口的申请函数。
+ * @param ctx 分配器上下文，未使用。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+static void *tc_allocator_alloc(void *ctx, size_t size) {
+  UNUSED(ctx);
+  return tc_malloc(size);
+}
+
+/**
+ * @brief 分配器接口的调整大小函数。
+ * @param ctx 分配器上下文，未使用。
+ * @param ptr 原内存指针。
+ * @param size 新的字节数。
+ * @return 返回新的内存指针，失败返回 NULL。
+ */
+static void *tc_allocator_realloc(void *ctx, void *ptr, size_t size) {
+  UNUSED(ctx);
+  return tc_realloc(ptr, size);
+}
+
+/**
+ * @brief 分配器接口的释放函数。
+ * @param ctx 分配器上下文，未使用。
+ * @param ptr 内存指针。
+ */
+static void tc_allocator_free(void *ctx, void *ptr) {
+  UNUSED(ctx);
+  tc_free(ptr);
+}
+
+/**
+ * @brief 分配器接口的对齐申请函数。
+ * @param ctx 分配器上下文，未使用。
+ * @param align 对齐字节数。
+ * @param size 字节数。
+ * @return 返回内存指针，失败返回 NULL。
+ */
+static void *tc_allocator_aligned_alloc(void *ctx, size_t align, size_t size) {
+  UNUSED(ctx);
+  return tc_aligned_alloc(align, size);
+}
+
+static mem_allocator tc_allocator = {
+    tc_allocator_alloc, tc_allocator_realloc, tc_allocator_free,
+    tc_allocator_aligned_alloc, NULL,
+};
+
+/**
+ * @brief 获取以本分配器实现的分配器接口。
+ * @return 返回分配器指针。
+ */
+mem_allocator *tc_alloc_get_allocator(void) { return &tc_allocator; }
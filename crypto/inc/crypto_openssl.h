@@ -22,4 +22,18 @@
  */
 ret_val create_openssl_crypto_opr(crypto_operator *opr);
 
+/**
+ * @brief Create an OpenSSL-based crypto operator with an allocator.
+ *
+ * Same as create_openssl_crypto_opr(), but buffers owned by the operator are
+ * taken from the given allocator. OpenSSL internal allocations are not
+ * affected.
+ *
+ * @param opr Pointer to the crypto operator to be initialized with OpenSSL.
+ * @param allocator Allocator to use, NULL for the default allocator.
+ * @return Returns ret_ok on success, ret_err on failure.
+ */
+ret_val create_openssl_crypto_opr_with_allocator(crypto_operator *opr,
+                                                 mem_allocator *allocator);
+
 #endif // !__CRYPTO_OPENSSL_H_
@@ -8,6 +8,8 @@
 #define __CRYPTO_OPERATOR_H_
 
 #include "../../common/inc/common.h"
+#include "../../common/inc/obj_pool.h"
+#include "../../iobuf/inc/iobuf.h"
 
 #define USE_OPENSSL
 #ifdef USE_OPENSSL
@@ -26,6 +28,13 @@ typedef struct {
  */
 #define HASH_MAX_SIZE 64
 
+/**
+ * @brief Size of the read buffer used by crypto_cal_file().
+ */
+#ifndef CRYPTO_FILE_BUF_SIZE
+#define CRYPTO_FILE_BUF_SIZE (64 * 1024)
+#endif // !CRYPTO_FILE_BUF_SIZE
+
 /**
  * @brief Enumeration of supported crypto types.
  */
@@ -54,7 +63,8 @@ typedef enum {
  * @brief Structure defining a cryptographic operator.
  */
 typedef struct crypto_operator {
-  crypto_info info; /**< Cryptographic information */
+  crypto_info info;         /**< Cryptographic information */
+  mem_allocator *allocator; /**< Allocator for buffers, NULL for default */
   int (*init)(struct crypto_operator *opr,
               crypto_type type); /**< Initialization function */
   int (*update)(struct crypto_operator *opr, void *buf,
@@ -81,4 +91,26 @@ typedef struct crypto_operator {
 ret_val crypto_cal_file(crypto_operator *opr, crypto_type type, char *file_path,
                         unsigned char *hash, int *size);
 
+/**
+ * @brief Feed the contents of an iobuf to an initialized crypto operator.
+ *
+ * Each segment is passed to the update function in place, so chained data
+ * does not need to be coalesced first. The iobuf is not modified.
+ *
+ * @param opr Pointer to the crypto operator.
+ * @param buf Pointer to the iobuf holding the data.
+ * @return Returns ret_ok on success, ret_err on failure.
+ */
+ret_val crypto_update_iobuf(crypto_operator *opr, const iobuf *buf);
+
+/**
+ * @brief Pooled crypto_operator objects.
+ *
+ * crypto_operator_pool_get() returns a zeroed crypto_operator, or NULL if out
+ * of memory; bind a backend with create_openssl_crypto_opr() before use.
+ * crypto_operator_pool_put() returns it to the pool; any digest context must
+ * already be destroyed.
+ */
+DECLARE_POOL(crypto_operator)
+
 #endif // !__CRYPTO_OPERATOR_H_
@@ -6,6 +6,7 @@
 
 #include "../inc/crypto_openssl.h"
 #include "c-utils/common/inc/common.h"
+#include "c-utils/common/inc/metrics.h"
 
 /**
  * @brief Select the OpenSSL digest method based on the crypto_type.
@@ -138,6 +139,8 @@ static int openssl_crypto_update_handler(struct crypto_operator *opr, void *buf,
   crypto_info *info = &opr->info;
   if (EVP_DigestUpdate(info->mdctx, buf, (size_t)len) != 1)
     return ret_err;
+  METRICS_COUNT("c_utils_crypto_digest_bytes_total",
+                "Bytes fed to message digests.", (uint64_t)len);
   return ret_ok;
 }
 
@@ -157,6 +160,8 @@ static int openssl_crypto_final_handler(struct crypto_operator *opr,
   crypto_info *info = &opr->info;
   if (EVP_DigestFinal(info->mdctx, hash, (unsigned int *)size) != 1)
     return ret_err;
+  METRICS_COUNT("c_utils_crypto_digests_total", "Message digests computed.",
+                1);
   return ret_ok;
 }
 
@@ -184,6 +189,23 @@ static int openssl_crypto_destroy_handler(struct crypto_operator *opr) {
  * @return Returns ret_ok on success, ret_err on failure.
  */
 ret_val create_openssl_crypto_opr(crypto_operator *opr) {
+  return create_openssl_crypto_opr_with_allocator(opr, NULL);
+}
+
+/**
+ * @brief Create an OpenSSL-based crypto operator with an allocator.
+ *
+ * Same as create_openssl_crypto_opr(), but buffers owned by the operator are
+ * taken from the given allocator. OpenSSL internal allocations are not
+ * affected.
+ *
+ * @param opr Pointer to the crypto operator to be initialized with OpenSSL.
+ * @param allocator Allocator to use, NULL for the default allocator.
+ * @return Returns ret_ok on success, ret_err on failure.
+ */
+ret_val create_openssl_crypto_opr_with_allocator(crypto_operator *opr,
+                                                 mem_allocator *allocator) {
+  opr->allocator = allocator;
   opr->init = openssl_crypto_init_handler;
   opr->update = openssl_crypto_update_handler;
   opr->final = openssl_crypto_final_handler;
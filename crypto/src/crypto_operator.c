@@ -7,8 +7,21 @@
 #include "../inc/crypto_operator.h"
 #include "c-utils/common/inc/common.h"
 #include <fcntl.h>
+#include <limits.h>
+#include <string.h>
 #include <unistd.h>
 
+/**
+ * @brief Resets a crypto operator taken from the pool.
+ *
+ * @param obj Pointer to the crypto operator.
+ */
+static void crypto_operator_pool_ctor(void *obj) {
+  memset(obj, 0, sizeof(crypto_operator));
+}
+
+DEFINE_POOL_WITH_HOOKS(crypto_operator, crypto_operator_pool_ctor, NULL)
+
 /**
  * @brief Initializes a crypto operator with the specified crypto type.
  *
@@ -80,32 +93,75 @@ static ret_val crypto_destroy(crypto_operator *opr) {
  */
 ret_val crypto_cal_file(crypto_operator *opr, crypto_type type, char *file_path,
                         unsigned char *hash, int *size) {
+  unsigned char *buffer;
+  ssize_t bytes_read;
   int fd;
 
-  crypto_init(opr, type);
   fd = open(file_path, O_RDONLY);
   if (fd < 0)
     goto err_open;
 
-  unsigned char buffer[256];
-  size_t bytes_read;
+  buffer = (unsigned char *)mem_alloc(opr->allocator, CRYPTO_FILE_BUF_SIZE);
+  if (!buffer)
+    goto err_alloc;
+
+  if (crypto_init(opr, type) != ret_ok)
+    goto err_init;
 
   // Read the file in chunks and update the crypto calculation
-  while ((bytes_read = read(fd, buffer, (size_t)sizeof(buffer))) > 0) {
+  while ((bytes_read = read(fd, buffer, CRYPTO_FILE_BUF_SIZE)) > 0) {
     if (crypto_update(opr, buffer, (int)bytes_read) != ret_ok)
       goto err_update;
   }
+  if (bytes_read < 0)
+    goto err_update;
 
   // Finalize the calculation and retrieve the hash
   if (crypto_final(opr, hash, size) != ret_ok)
     goto err_final;
 
   crypto_destroy(opr);
+  mem_free(opr->allocator, buffer);
+  close(fd);
   return ret_ok;
 
 err_final:
 err_update:
+err_init:
+  crypto_destroy(opr);
+  mem_free(opr->allocator, buffer);
+err_alloc:
   close(fd);
 err_open:
   return ret_err;
 }
+
+/**
+ * @brief Feed the contents of an iobuf to an initialized crypto operator.
+ *
+ * Each segment is passed to the update function in place. Segments larger
+ * than INT_MAX are split, since the update function takes an int length.
+ *
+ * @param opr Pointer to the crypto operator.
+ * @param buf Pointer to the iobuf holding the data.
+ * @return Returns ret_ok on success, ret_err on failure.
+ */
+ret_val crypto_update_iobuf(crypto_operator *opr, const iobuf *buf) {
+  iobuf_node *node;
+  unsigned char *data;
+  size_t left;
+  int n;
+
+  each_node_for_iobuf(node, buf) {
+    data = node->data;
+    left = node->len;
+    while (left) {
+      n = left > INT_MAX ? INT_MAX : (int)left;
+      if (crypto_update(opr, data, n) != ret_ok)
+        return ret_err;
+      data += n;
+      left -= (size_t)n;
+    }
+  }
+  return ret_ok;
+}
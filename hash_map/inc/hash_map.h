@@ -0,0 +1,163 @@
+/**
+ * @brief: 开放寻址哈希表头文件，按 16 字节控制字节组进行 SIMD 探测
+ * @file: hash_map.h
+ * @author: moecly
+ */
+
+#ifndef __HASH_MAP_H_
+#define __HASH_MAP_H_
+
+#include "../../common/inc/common.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+/* 每组控制字节数，与一次 SSE2 比较的宽度一致 */
+#define HASH_MAP_GROUP 16
+
+/* 空槽位的控制字节，已占用槽位保存哈希值的低 7 位 */
+#define HASH_MAP_EMPTY ((uint8_t)0x80)
+
+/* 最小容量，需为 2 的幂且不小于一组 */
+#ifndef HASH_MAP_MIN_CAPACITY
+#define HASH_MAP_MIN_CAPACITY 16
+#endif // !HASH_MAP_MIN_CAPACITY
+
+/**
+ * @brief: 键的哈希函数
+ */
+typedef uint64_t (*hash_map_hash_func)(const void *key);
+
+/**
+ * @brief: 键的比较函数，相等返回非 0
+ */
+typedef int (*hash_map_eq_func)(const void *a, const void *b);
+
+/**
+ * @brief: 哈希表条目结构定义
+ */
+typedef struct {
+  void *key; /* 键 */
+  void *val; /* 值 */
+} hash_map_entry;
+
+/**
+ * @brief: 哈希表结构定义
+ */
+typedef struct {
+  uint8_t *ctrl;            /* 控制字节，末尾额外复制一组首部字节 */
+  hash_map_entry *slots;    /* 槽位数组 */
+  uint32_t capacity;        /* 槽位数，为 2 的幂 */
+  uint32_t len;             /* 已保存的条目数 */
+  hash_map_hash_func hash;  /* 哈希函数 */
+  hash_map_eq_func eq;      /* 比较函数 */
+  mem_allocator *allocator; /* 分配器，为 NULL 时使用默认分配器 */
+} hash_map;
+
+/* 定义一个宏，用于遍历哈希表中的条目，单层循环，跳过空槽位 */
+#define each_entry_for_hash_map(entry, idx, map)                               \
+  for (idx = hash_map_next_slot(map, 0);                                       \
+       idx < (map)->capacity && ((entry = &(map)->slots[idx]), 1);             \
+       idx = hash_map_next_slot(map, idx + 1))
+
+/**
+ * @brief: 查找下标不小于 idx 的第一个非空槽位，供 each_entry_for_hash_map 使用
+ * @param map: 哈希表指针
+ * @param idx: 起始槽位下标
+ * @return: 返回非空槽位下标，没有时返回容量
+ */
+uint32_t hash_map_next_slot(const hash_map *map, uint32_t idx);
+
+/**
+ * @brief: 创建一个新的哈希表
+ * @param hash: 哈希函数，为 NULL 时按指针值哈希
+ * @param eq: 比较函数，为 NULL 时比较指针值
+ * @return: 返回一个指向新哈希表的指针，失败返回 NULL
+ */
+hash_map *hash_map_new(hash_map_hash_func hash, hash_map_eq_func eq);
+
+/**
+ * @brief: 使用指定分配器创建一个新的哈希表
+ *
+ * 控制字节和槽位数组按缓存行对齐申请，传入 mem_page_allocator_init()
+ * 得到的分配器即可使用大页或绑定 NUMA 节点。
+ *
+ * @param hash: 哈希函数，为 NULL 时按指针值哈希
+ * @param eq: 比较函数，为 NULL 时比较指针值
+ * @param allocator: 分配器指针，为 NULL 时使用默认分配器
+ * @return: 返回一个指向新哈希表的指针，失败返回 NULL
+ */
+hash_map *hash_map_new_with_allocator(hash_map_hash_func hash,
+                                      hash_map_eq_func eq,
+                                      mem_allocator *allocator);
+
+/**
+ * @brief: 释放哈希表，键和值由调用者管理
+ * @param map: 哈希表指针
+ */
+void hash_map_free(hash_map *map);
+
+/**
+ * @brief: 预留容量，保证插入 n 个条目前不再扩容
+ * @param map: 哈希表指针
+ * @param n: 条目数
+ * @return: 成功返回 ret_ok，内存不足返回 ret_err
+ */
+ret_val hash_map_reserve(hash_map *map, uint32_t n);
+
+/**
+ * @brief: 插入条目，键已存在时替换其值
+ * @param map: 哈希表指针
+ * @param key: 键
+ * @param val: 值
+ * @return: 成功返回 ret_ok，内存不足返回 ret_err
+ */
+ret_val hash_map_put(hash_map *map, void *key, void *val);
+
+/**
+ * @brief: 查找条目
+ * @param map: 哈希表指针
+ * @param key: 键
+ * @return: 返回条目指针，不存在返回 NULL，插入或删除后失效
+ */
+hash_map_entry *hash_map_find(hash_map *map, const void *key);
+
+/**
+ * @brief: 查找键对应的值
+ * @param map: 哈希表指针
+ * @param key: 键
+ * @return: 返回值，不存在返回 NULL
+ */
+void *hash_map_get(hash_map *map, const void *key);
+
+/**
+ * @brief: 删除条目，后续条目前移填补空位，不留下墓碑
+ * @param map: 哈希表指针
+ * @param key: 键
+ * @param val: 保存被删除的值，可为 NULL
+ * @return: 成功返回 ret_ok，键不存在返回 ret_err
+ */
+ret_val hash_map_remove(hash_map *map, const void *key, void **val);
+
+/**
+ * @brief: 获取哈希表条目数
+ * @param map: 哈希表指针
+ * @return: 返回条目数
+ */
+uint32_t hash_map_get_length(hash_map *map);
+
+/**
+ * @brief: 以 NUL 结尾字符串为键的哈希函数
+ * @param key: 字符串
+ * @return: 返回哈希值
+ */
+uint64_t hash_map_hash_str(const void *key);
+
+/**
+ * @brief: 以 NUL 结尾字符串为键的比较函数
+ * @param a: 字符串
+ * @param b: 字符串
+ * @return: 相等返回 1，否则返回 0
+ */
+int hash_map_eq_str(const void *a, const void *b);
+
+#endif // !__HASH_MAP_H_
@@ -0,0 +1,411 @@
+/**
+ * @file hash_map.c
+ * @brief 开放寻址哈希表实现文件，线性探测，删除时后移填补空位。
+ * @author moecly
+ */
+
+#include "../inc/hash_map.h"
+#include "../../common/inc/fast_hash.h"
+#include "../../common/inc/mem_pages.h"
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief 64 位整数混淆，使低位和高位都依赖全部输入位。
+ * @param x 输入值。
+ * @return 返回混淆后的值。
+ */
+static uint64_t hash_map_mix(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+/**
+ * @brief 默认哈希函数，按指针值哈希。
+ * @param key 键。
+ * @return 返回哈希值。
+ */
+static uint64_t hash_map_hash_ptr(const void *key) {
+  return hash_map_mix((uint64_t)(uintptr_t)key);
+}
+
+/**
+ * @brief 默认比较函数，比较指针值。
+ * @param a 键。
+ * @param b 键。
+ * @return 相等返回 1，否则返回 0。
+ */
+static int hash_map_eq_ptr(const void *a, const void *b) { return a == b; }
+
+/**
+ * @brief 在一组控制字节中匹配指定字节。
+ * @param ctrl 组首地址，可不对齐。
+ * @param h2 要匹配的控制字节。
+ * @return 返回匹配位掩码，第 i 位对应组内第 i 个槽位。
+ */
+static uint32_t hash_map_group_match(const uint8_t *ctrl, uint8_t h2) {
+#ifdef __SSE2__
+  __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+  return (uint32_t)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2)));
+#else
+  uint32_t mask = 0;
+  uint32_t i;
+
+  for (i = 0; i < HASH_MAP_GROUP; i++)
+    mask |= (uint32_t)(ctrl[i] == h2) << i;
+  return mask;
+#endif
+}
+
+/**
+ * @brief 在一组控制字节中匹配空槽位。
+ * @param ctrl 组首地址，可不对齐。
+ * @return 返回空槽位掩码。
+ */
+static uint32_t hash_map_group_match_empty(const uint8_t *ctrl) {
+#ifdef __SSE2__
+  /* 只有空槽位的最高位为 1 */
+  return (uint32_t)_mm_movemask_epi8(
+      _mm_loadu_si128((const __m128i *)ctrl));
+#else
+  return hash_map_group_match(ctrl, HASH_MAP_EMPTY);
+#endif
+}
+
+/**
+ * @brief 设置控制字节，首部一组同时写入末尾的副本。
+ * @param map 哈希表指针。
+ * @param idx 槽位下标。
+ * @param val 控制字节。
+ */
+static void hash_map_set_ctrl(hash_map *map, uint32_t idx, uint8_t val) {
+  map->ctrl[idx] = val;
+  if (idx < HASH_MAP_GROUP)
+    map->ctrl[map->capacity + idx] = val;
+}
+
+/**
+ * @brief 计算槽位数组的理想位置。
+ * @param map 哈希表指针。
+ * @param hash 哈希值。
+ * @return 返回理想槽位下标。
+ */
+static uint32_t hash_map_home(hash_map *map, uint64_t hash) {
+  return (uint32_t)(hash >> 7) & (map->capacity - 1);
+}
+
+/**
+ * @brief 从理想位置开始查找第一个空槽位。
+ * @param map 哈希表指针。
+ * @param hash 哈希值。
+ * @return 返回空槽位下标。
+ */
+static uint32_t hash_map_find_empty(hash_map *map, uint64_t hash) {
+  uint32_t mask = map->capacity - 1;
+  uint32_t pos = hash_map_home(map, hash);
+  uint32_t match;
+
+  for (;;) {
+    match = hash_map_group_match_empty(map->ctrl + pos);
+    if (match)
+      return (pos + (uint32_t)__builtin_ctz(match)) & mask;
+    pos = (pos + HASH_MAP_GROUP) & mask;
+  }
+}
+
+/**
+ * @brief 申请指定容量的控制字节和槽位数组。
+ * @param map 哈希表指针。
+ * @param capacity 槽位数，为 2 的幂。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err。
+ */
+static ret_val hash_map_alloc(hash_map *map, uint32_t capacity) {
+  map->ctrl = (uint8_t *)mem_cache_aligned_alloc(map->allocator,
+                                                 capacity + HASH_MAP_GROUP);
+  map->slots = (hash_map_entry *)mem_cache_aligned_alloc(
+      map->allocator, sizeof(hash_map_entry) * capacity);
+  if (!map->ctrl || !map->slots) {
+    mem_free(map->allocator, map->ctrl);
+    mem_free(map->allocator, map->slots);
+    return ret_err;
+  }
+
+  memset(map->ctrl, HASH_MAP_EMPTY, capacity + HASH_MAP_GROUP);
+  map->capacity = capacity;
+  return ret_ok;
+}
+
+/**
+ * @brief 查找下标不小于 idx 的第一个非空槽位，按组扫描控制字节。
+ * @param map 哈希表指针。
+ * @param idx 起始槽位下标。
+ * @return 返回非空槽位下标，没有时返回容量。
+ */
+uint32_t hash_map_next_slot(const hash_map *map, uint32_t idx) {
+  uint32_t full;
+
+  /* 控制字节末尾多出一组，从任意下标读取一整组都不越界 */
+  for (; idx < map->capacity; idx += HASH_MAP_GROUP) {
+    full = ~hash_map_group_match_empty(map->ctrl + idx) &
+           ((1u << HASH_MAP_GROUP) - 1);
+    if (full) {
+      idx += (uint32_t)__builtin_ctz(full);
+      return idx < map->capacity ? idx : map->capacity;
+    }
+  }
+  return map->capacity;
+}
+
+/**
+ * @brief 将哈希表调整为指定容量并重新放置全部条目。
+ * @param map 哈希表指针。
+ * @param capacity 新的槽位数，为 2 的幂。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err 且哈希表不变。
+ */
+static ret_val hash_map_resize(hash_map *map, uint32_t capacity) {
+  uint8_t *old_ctrl = map->ctrl;
+  hash_map_entry *old_slots = map->slots;
+  uint32_t old_capacity = map->capacity;
+  uint64_t hash;
+  uint32_t idx;
+  uint32_t i;
+
+  if (hash_map_alloc(map, capacity) != ret_ok) {
+    map->ctrl = old_ctrl;
+    map->slots = old_slots;
+    return ret_err;
+  }
+
+  for (i = 0; i < old_capacity; i++) {
+    if (old_ctrl[i] == HASH_MAP_EMPTY)
+      continue;
+    hash = map->hash(old_slots[i].key);
+    idx = hash_map_find_empty(map, hash);
+    hash_map_set_ctrl(map, idx, (uint8_t)(hash & 0x7f));
+    map->slots[idx] = old_slots[i];
+  }
+
+  mem_free(map->allocator, old_ctrl);
+  mem_free(map->allocator, old_slots);
+  return ret_ok;
+}
+
+/**
+ * @brief 根据哈希值查找条目所在的槽位。
+ * @param map 哈希表指针。
+ * @param key 键。
+ * @param hash 键的哈希值。
+ * @return 返回槽位下标，不存在返回 capacity。
+ */
+static uint32_t hash_map_lookup(hash_map *map, const void *key,
+                                uint64_t hash) {
+  uint32_t mask = map->capacity - 1;
+  uint32_t pos = hash_map_home(map, hash);
+  uint8_t h2 = (uint8_t)(hash & 0x7f);
+  uint32_t match;
+  uint32_t idx;
+
+  for (;;) {
+    match = hash_map_group_match(map->ctrl + pos, h2);
+    while (match) {
+      idx = (pos + (uint32_t)__builtin_ctz(match)) & mask;
+      if (map->eq(map->slots[idx].key, key))
+        return idx;
+      match &= match - 1;
+    }
+
+    /* 线性探测中条目与理想位置之间不会出现空槽位 */
+    if (hash_map_group_match_empty(map->ctrl + pos))
+      return map->capacity;
+    pos = (pos + HASH_MAP_GROUP) & mask;
+  }
+}
+
+/**
+ * @brief 创建一个新的哈希表。
+ * @param hash 哈希函数，为 NULL 时按指针值哈希。
+ * @param eq 比较函数，为 NULL 时比较指针值。
+ * @return 返回一个指向新哈希表的指针，失败返回 NULL。
+ */
+hash_map *hash_map_new(hash_map_hash_func hash, hash_map_eq_func eq) {
+  return hash_map_new_with_allocator(hash, eq, NULL);
+}
+
+/**
+ * @brief 使用指定分配器创建一个新的哈希表。
+ * @param hash 哈希函数，为 NULL 时按指针值哈希。
+ * @param eq 比较函数，为 NULL 时比较指针值。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @return 返回一个指向新哈希表的指针，失败返回 NULL。
+ */
+hash_map *hash_map_new_with_allocator(hash_map_hash_func hash,
+                                      hash_map_eq_func eq,
+                                      mem_allocator *allocator) {
+  hash_map *map = MEM_ALLOC_FUNC(allocator, hash_map);
+  if (!map)
+    return NULL;
+
+  map->hash = hash ? hash : hash_map_hash_ptr;
+  map->eq = eq ? eq : hash_map_eq_ptr;
+  map->len = 0;
+  map->allocator = allocator;
+  if (hash_map_alloc(map, HASH_MAP_MIN_CAPACITY) != ret_ok) {
+    mem_free(allocator, map);
+    return NULL;
+  }
+  return map;
+}
+
+/**
+ * @brief 释放哈希表，键和值由调用者管理。
+ * @param map 哈希表指针。
+ */
+void hash_map_free(hash_map *map) {
+  mem_free(map->allocator, map->ctrl);
+  mem_free(map->allocator, map->slots);
+  mem_free(map->allocator, map);
+}
+
+/**
+ * @brief 预留容量，保证插入 n 个条目前不再扩容。
+ * @param map 哈希表指针。
+ * @param n 条目数。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err。
+ */
+ret_val hash_map_reserve(hash_map *map, uint32_t n) {
+  uint64_t capacity = map->capacity;
+
+  /* 负载因子上限为 7/8 */
+  while ((uint64_t)n * 8 > capacity * 7)
+    capacity *= 2;
+  if (capacity > UINT32_MAX / 2 + 1)
+    return ret_err;
+  if (capacity == map->capacity)
+    return ret_ok;
+  return hash_map_resize(map, (uint32_t)capacity);
+}
+
+/**
+ * @brief 插入条目，键已存在时替换其值。
+ * @param map 哈希表指针。
+ * @param key 键。
+ * @param val 值。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err。
+ */
+ret_val hash_map_put(hash_map *map, void *key, void *val) {
+  uint64_t hash = map->hash(key);
+  uint32_t idx;
+
+  idx = hash_map_lookup(map, key, hash);
+  if (idx != map->capacity) {
+    map->slots[idx].val = val;
+    return ret_ok;
+  }
+
+  if (hash_map_reserve(map, map->len + 1) != ret_ok)
+    return ret_err;
+
+  idx = hash_map_find_empty(map, hash);
+  hash_map_set_ctrl(map, idx, (uint8_t)(hash & 0x7f));
+  map->slots[idx].key = key;
+  map->slots[idx].val = val;
+  map->len++;
+  return ret_ok;
+}
+
+/**
+ * @brief 查找条目。
+ * @param map 哈希表指针。
+ * @param key 键。
+ * @return 返回条目指针，不存在返回 NULL，插入或删除后失效。
+ */
+hash_map_entry *hash_map_find(hash_map *map, const void *key) {
+  uint32_t idx = hash_map_lookup(map, key, map->hash(key));
+  if (idx == map->capacity)
+    return NULL;
+  return &map->slots[idx];
+}
+
+/**
+ * @brief 查找键对应的值。
+ * @param map 哈希表指针。
+ * @param key 键。
+ * @return 返回值，不存在返回 NULL。
+ */
+void *hash_map_get(hash_map *map, const void *key) {
+  hash_map_entry *entry = hash_map_find(map, key);
+  if (!entry)
+    return NULL;
+  return entry->val;
+}
+
+/**
+ * @brief 删除条目，后续条目前移填补空位，不留下墓碑。
+ * @param map 哈希表指针。
+ * @param key 键。
+ * @param val 保存被删除的值，可为 NULL。
+ * @return 成功返回 ret_ok，键不存在返回 ret_err。
+ */
+ret_val hash_map_remove(hash_map *map, const void *key, void **val) {
+  uint32_t mask = map->capacity - 1;
+  uint32_t hole;
+  uint32_t idx;
+  uint32_t home;
+
+  hole = hash_map_lookup(map, key, map->hash(key));
+  if (hole == map->capacity)
+    return ret_err;
+
+  if (val)
+    *val = map->slots[hole].val;
+  hash_map_set_ctrl(map, hole, HASH_MAP_EMPTY);
+  map->len--;
+
+  /* 向后扫描到空槽位，理想位置不在 (hole, idx] 内的条目可前移到空位 */
+  for (idx = (hole + 1) & mask; map->ctrl[idx] != HASH_MAP_EMPTY;
+       idx = (idx + 1) & mask) {
+    home = hash_map_home(map, map->hash(map->slots[idx].key));
+    if (((idx - home) & mask) < ((idx - hole) & mask))
+      continue;
+
+    map->slots[hole] = map->slots[idx];
+    hash_map_set_ctrl(map, hole, map->ctrl[idx]);
+    hash_map_set_ctrl(map, idx, HASH_MAP_EMPTY);
+    hole = idx;
+  }
+  return ret_ok;
+}
+
+/**
+ * @brief 获取哈希表条目数。
+ * @param map 哈希表指针。
+ * @return 返回条目数。
+ */
+uint32_t hash_map_get_length(hash_map *map) { return map->len; }
+
+/**
+ * @brief 以 NUL 结尾字符串为键的哈希函数。
+ * @param key 字符串。
+ * @return 返回哈希值。
+ */
+uint64_t hash_map_hash_str(const void *key) {
+  return fast_hash64(key, strlen((const char *)key));
+}
+
+/**
+ * @brief 以 NUL 结尾字符串为键的比较函数。
+ * @param a 字符串。
+ * @param b 字符串。
+ * @return 相等返回 1，否则返回 0。
+ */
+int hash_map_eq_str(const void *a, const void *b) {
+  return !strcmp((const char *)a, (const char *)b);
+}
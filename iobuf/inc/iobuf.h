@@ -0,0 +1,215 @@
+/**
+ * @brief: 引用计数的链式字节缓冲区头文件
+ * @file: iobuf.h
+ * @author: moecly
+ *
+ * 缓冲区由若干节点串联，每个节点引用共享段中的一段连续字节。切片和克隆
+ * 只增加段的引用计数，不复制数据；只有段未被共享时才会在其前后的空闲
+ * 空间中写入。
+ */
+
+#ifndef __IOBUF_H_
+#define __IOBUF_H_
+
+#include "../../common/inc/common.h"
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/* 新建段的默认容量 */
+#ifndef IOBUF_DEFAULT_SEG_SIZE
+#define IOBUF_DEFAULT_SEG_SIZE 4096
+#endif // !IOBUF_DEFAULT_SEG_SIZE
+
+/* 空缓冲区新建首段时在前部预留的字节数，用于前置协议头 */
+#ifndef IOBUF_DEFAULT_HEADROOM
+#define IOBUF_DEFAULT_HEADROOM 64
+#endif // !IOBUF_DEFAULT_HEADROOM
+
+/**
+ * @brief: 外部数据的释放函数
+ */
+typedef void (*iobuf_free_func)(void *ctx, void *data);
+
+/**
+ * @brief: 共享段结构定义，引用计数归零时释放
+ */
+typedef struct iobuf_seg {
+  uint32_t refs;             /* 引用计数 */
+  uint32_t external;         /* 数据区由调用者提供，不写入其中的空闲空间 */
+  size_t cap;                /* 数据区字节数 */
+  unsigned char *base;       /* 数据区起始地址 */
+  mem_allocator *allocator;  /* 申请段时使用的分配器 */
+  iobuf_free_func free_func; /* 外部数据的释放函数，内部数据为 NULL */
+  void *free_ctx;            /* 释放函数的上下文 */
+  unsigned char storage[];   /* 内部数据区 */
+} iobuf_seg;
+
+/**
+ * @brief: 缓冲区节点结构定义，引用段中的一段有效字节
+ */
+typedef struct iobuf_node {
+  struct iobuf_node *next; /* 下一个节点 */
+  iobuf_seg *seg;          /* 所引用的段 */
+  unsigned char *data;     /* 有效字节起始地址 */
+  size_t len;              /* 有效字节数 */
+} iobuf_node;
+
+/**
+ * @brief: 链式缓冲区结构定义
+ */
+typedef struct {
+  iobuf_node *head;         /* 首节点 */
+  iobuf_node *tail;         /* 尾节点 */
+  size_t len;               /* 有效字节总数 */
+  uint32_t count;           /* 节点数 */
+  mem_allocator *allocator; /* 申请段使用的分配器，为 NULL 时使用默认分配器 */
+} iobuf;
+
+/* 定义一个宏，用于遍历缓冲区中的节点 */
+#define each_node_for_iobuf(node, buf)                                         \
+  for (node = (buf)->head; node != NULL; node = node->next)
+
+/**
+ * @brief: 初始化空缓冲区
+ * @param buf: 缓冲区指针
+ * @param allocator: 申请段使用的分配器，为 NULL 时使用默认分配器
+ */
+void iobuf_init(iobuf *buf, mem_allocator *allocator);
+
+/**
+ * @brief: 释放缓冲区的全部节点，段在最后一个引用释放时回收
+ * @param buf: 缓冲区指针
+ */
+void iobuf_destroy(iobuf *buf);
+
+/**
+ * @brief: 获取有效字节总数
+ * @param buf: 缓冲区指针
+ * @return: 返回字节数
+ */
+size_t iobuf_get_length(const iobuf *buf);
+
+/**
+ * @brief: 在尾部获取至少 min 字节的可写空间，写入后调用 iobuf_commit()
+ *
+ * 尾段为内部段、未被共享且剩余空间足够时直接使用，否则追加容量不小于
+ * IOBUF_DEFAULT_SEG_SIZE 的新段。
+ *
+ * @param buf: 缓冲区指针
+ * @param min: 需要的最少字节数
+ * @param avail: 保存实际可写的字节数，可为 NULL
+ * @return: 返回可写空间起始地址，内存不足返回 NULL
+ */
+unsigned char *iobuf_reserve(iobuf *buf, size_t min, size_t *avail);
+
+/**
+ * @brief: 确认 iobuf_reserve() 返回的空间中已写入的字节数
+ * @param buf: 缓冲区指针
+ * @param n: 写入的字节数，不超过可写字节数
+ */
+void iobuf_commit(iobuf *buf, size_t n);
+
+/**
+ * @brief: 放弃 iobuf_reserve() 返回的空间，尾节点为空时释放，用于写入失败
+ * @param buf: 缓冲区指针
+ */
+void iobuf_unreserve(iobuf *buf);
+
+/**
+ * @brief: 复制数据到尾部
+ * @param buf: 缓冲区指针
+ * @param data: 数据指针
+ * @param len: 字节数
+ * @return: 成功返回 ret_ok，内存不足返回 ret_err
+ */
+ret_val iobuf_append(iobuf *buf, const void *data, size_t len);
+
+/**
+ * @brief: 不复制地将外部数据作为新段追加到尾部，之后不会写入该段
+ * @param buf: 缓冲区指针
+ * @param data: 数据指针
+ * @param len: 字节数
+ * @param free_func: 最后一个引用释放时调用，可为 NULL
+ * @param ctx: 释放函数的上下文
+ * @return: 成功返回 ret_ok，内存不足返回 ret_err，此时不调用释放函数
+ */
+ret_val iobuf_append_external(iobuf *buf, void *data, size_t len,
+                              iobuf_free_func free_func, void *ctx);
+
+/**
+ * @brief: 复制数据到头部，首段为内部段、未被共享且前部空间足够时不新建段
+ * @param buf: 缓冲区指针
+ * @param data: 数据指针
+ * @param len: 字节数
+ * @return: 成功返回 ret_ok，内存不足返回 ret_err
+ */
+ret_val iobuf_prepend(iobuf *buf, const void *data, size_t len);
+
+/**
+ * @brief: 将 src 的全部节点移动到 dst 尾部，不复制数据
+ * @param dst: 目标缓冲区指针
+ * @param src: 源缓冲区指针，返回后为空
+ */
+void iobuf_append_buf(iobuf *dst, iobuf *src);
+
+/**
+ * @brief: 从头部丢弃字节
+ * @param buf: 缓冲区指针
+ * @param n: 字节数，超过总长度时清空
+ */
+void iobuf_trim_front(iobuf *buf, size_t n);
+
+/**
+ * @brief: 从尾部丢弃字节
+ * @param buf: 缓冲区指针
+ * @param n: 字节数，超过总长度时清空
+ */
+void iobuf_trim_back(iobuf *buf, size_t n);
+
+/**
+ * @brief: 以共享方式取出一段字节追加到 dst，不复制数据
+ * @param src: 源缓冲区指针
+ * @param off: 起始偏移
+ * @param len: 字节数
+ * @param dst: 目标缓冲区指针
+ * @return: 成功返回 ret_ok，范围越界或内存不足返回 ret_err
+ */
+ret_val iobuf_slice(const iobuf *src, size_t off, size_t len, iobuf *dst);
+
+/**
+ * @brief: 将全部字节合并到一个连续段中，已连续时不复制
+ * @param buf: 缓冲区指针
+ * @return: 返回连续数据的起始地址，空缓冲区或内存不足返回 NULL
+ */
+unsigned char *iobuf_coalesce(iobuf *buf);
+
+/**
+ * @brief: 复制一段字节到平坦内存
+ * @param buf: 缓冲区指针
+ * @param off: 起始偏移
+ * @param dst: 目标内存
+ * @param len: 最多复制的字节数
+ * @return: 返回实际复制的字节数
+ */
+size_t iobuf_copy_out(const iobuf *buf, size_t off, void *dst, size_t len);
+
+/**
+ * @brief: 将节点转换为 iovec 数组，不复制数据
+ * @param buf: 缓冲区指针
+ * @param iov: iovec 数组
+ * @param max: 数组长度
+ * @return: 返回填充的元素数，节点数超过 max 时只填充前 max 个
+ */
+int iobuf_to_iovec(const iobuf *buf, struct iovec *iov, int max);
+
+/**
+ * @brief: 将 iovec 数组中的数据复制到尾部
+ * @param buf: 缓冲区指针
+ * @param iov: iovec 数组
+ * @param n: 数组长度
+ * @return: 成功返回 ret_ok，内存不足返回 ret_err
+ */
+ret_val iobuf_from_iovec(iobuf *buf, const struct iovec *iov, int n);
+
+#endif // !__IOBUF_H_
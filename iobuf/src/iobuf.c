@@ -0,0 +1,578 @@
+/**
+ * @file iobuf.c
+ * @brief 引用计数的链式字节缓冲区实现文件。
+ * @author moecly
+ */
+
+#include "../inc/iobuf.h"
+#include "../../common/inc/obj_pool.h"
+#include <stdint.h>
+#include <string.h>
+
+DEFINE_POOL(iobuf_node)
+
+/**
+ * @brief 申请容量为 cap 的内部段。
+ * @param allocator 分配器指针，为 NULL 时使用默认分配器。
+ * @param cap 数据区字节数。
+ * @return 返回段指针，内存不足返回 NULL。
+ */
+static iobuf_seg *iobuf_seg_new(mem_allocator *allocator, size_t cap) {
+  iobuf_seg *seg;
+
+  if (cap > SIZE_MAX - sizeof(iobuf_seg))
+    return NULL;
+  seg = (iobuf_seg *)mem_alloc(allocator, sizeof(iobuf_seg) + cap);
+  if (!seg)
+    return NULL;
+
+  seg->refs = 1;
+  seg->external = 0;
+  seg->cap = cap;
+  seg->base = seg->storage;
+  seg->allocator = allocator;
+  seg->free_func = NULL;
+  seg->free_ctx = NULL;
+  return seg;
+}
+
+/**
+ * @brief 释放段的一个引用，最后一个引用释放时回收段。
+ * @param seg 段指针。
+ */
+static void iobuf_seg_release(iobuf_seg *seg) {
+  if (__atomic_sub_fetch(&seg->refs, 1, __ATOMIC_ACQ_REL))
+    return;
+  if (seg->free_func)
+    seg->free_func(seg->free_ctx, seg->base);
+  mem_free(seg->allocator, seg);
+}
+
+/**
+ * @brief 判断能否写入段中的空闲空间，段须为内部段且只被一个节点引用。
+ * @param seg 段指针。
+ * @return 可写入返回非 0。
+ */
+static int iobuf_seg_writable(iobuf_seg *seg) {
+  return !seg->external && __atomic_load_n(&seg->refs, __ATOMIC_ACQUIRE) == 1;
+}
+
+/**
+ * @brief 创建引用段中一段字节的节点，段的引用由调用者转交给节点。
+ * @param seg 段指针。
+ * @param data 有效字节起始地址。
+ * @param len 有效字节数。
+ * @return 返回节点指针，内存不足返回 NULL。
+ */
+static iobuf_node *iobuf_node_new(iobuf_seg *seg, unsigned char *data,
+                                  size_t len) {
+  iobuf_node *node = iobuf_node_pool_get();
+  if (!node)
+    return NULL;
+
+  node->next = NULL;
+  node->seg = seg;
+  node->data = data;
+  node->len = len;
+  return node;
+}
+
+/**
+ * @brief 释放节点及其对段的引用。
+ * @param node 节点指针。
+ */
+static void iobuf_node_free(iobuf_node *node) {
+  iobuf_seg_release(node->seg);
+  iobuf_node_pool_put(node);
+}
+
+/**
+ * @brief 将节点挂到尾部。
+ * @param buf 缓冲区指针。
+ * @param node 节点指针。
+ */
+static void iobuf_link_tail(iobuf *buf, iobuf_node *node) {
+  if (buf->tail)
+    buf->tail->next = node;
+  else
+    buf->head = node;
+  buf->tail = node;
+  buf->len += node->len;
+  buf->count++;
+}
+
+/**
+ * @brief 将节点挂到头部。
+ * @param buf 缓冲区指针。
+ * @param node 节点指针。
+ */
+static void iobuf_link_head(iobuf *buf, iobuf_node *node) {
+  node->next = buf->head;
+  buf->head = node;
+  if (!buf->tail)
+    buf->tail = node;
+  buf->len += node->len;
+  buf->count++;
+}
+
+/**
+ * @brief 申请新段并作为空节点挂到尾部。
+ * @param buf 缓冲区指针。
+ * @param cap 段容量。
+ * @param headroom 前部预留的字节数，不超过 cap。
+ * @return 返回新节点，内存不足返回 NULL。
+ */
+static iobuf_node *iobuf_add_seg(iobuf *buf, size_t cap, size_t headroom) {
+  iobuf_seg *seg = iobuf_seg_new(buf->allocator, cap);
+  iobuf_node *node;
+
+  if (!seg)
+    return NULL;
+  node = iobuf_node_new(seg, seg->base + headroom, 0);
+  if (!node) {
+    iobuf_seg_release(seg);
+    return NULL;
+  }
+  iobuf_link_tail(buf, node);
+  return node;
+}
+
+/**
+ * @brief 初始化空缓冲区。
+ * @param buf 缓冲区指针。
+ * @param allocator 申请段使用的分配器，为 NULL 时使用默认分配器。
+ */
+void iobuf_init(iobuf *buf, mem_allocator *allocator) {
+  buf->head = NULL;
+  buf->tail = NULL;
+  buf->len = 0;
+  buf->count = 0;
+  buf->allocator = allocator;
+}
+
+/**
+ * @brief 释放缓冲区的全部节点，段在最后一个引用释放时回收。
+ * @param buf 缓冲区指针。
+ */
+void iobuf_destroy(iobuf *buf) {
+  iobuf_node *node = buf->head;
+  iobuf_node *next;
+
+  while (node) {
+    next = node->next;
+    iobuf_node_free(node);
+    node = next;
+  }
+  buf->head = NULL;
+  buf->tail = NULL;
+  buf->len = 0;
+  buf->count = 0;
+}
+
+/**
+ * @brief 获取有效字节总数。
+ * @param buf 缓冲区指针。
+ * @return 返回字节数。
+ */
+size_t iobuf_get_length(const iobuf *buf) { return buf->len; }
+
+/**
+ * @brief 在尾部获取至少 min 字节的可写空间，写入后调用 iobuf_commit()。
+ * @param buf 缓冲区指针。
+ * @param min 需要的最少字节数。
+ * @param avail 保存实际可写的字节数，可为 NULL。
+ * @return 返回可写空间起始地址，内存不足返回 NULL。
+ */
+unsigned char *iobuf_reserve(iobuf *buf, size_t min, size_t *avail) {
+  iobuf_node *node = buf->tail;
+  size_t headroom = buf->head ? 0 : IOBUF_DEFAULT_HEADROOM;
+  size_t room;
+  size_t cap;
+
+  if (node && iobuf_seg_writable(node->seg)) {
+    room = (size_t)(node->seg->base + node->seg->cap - node->data) - node->len;
+    if (room && room >= min)
+      goto out;
+  }
+
+  if (min > SIZE_MAX - headroom)
+    return NULL;
+  cap = min + headroom;
+  if (cap < IOBUF_DEFAULT_SEG_SIZE)
+    cap = IOBUF_DEFAULT_SEG_SIZE;
+  node = iobuf_add_seg(buf, cap, headroom);
+  if (!node)
+    return NULL;
+  room = cap - headroom;
+
+out:
+  if (avail)
+    *avail = room;
+  return node->data + node->len;
+}
+
+/**
+ * @brief 确认 iobuf_reserve() 返回的空间中已写入的字节数。
+ * @param buf 缓冲区指针。
+ * @param n 写入的字节数，不超过可写字节数。
+ */
+void iobuf_commit(iobuf *buf, size_t n) {
+  buf->tail->len += n;
+  buf->len += n;
+}
+
+/**
+ * @brief 放弃 iobuf_reserve() 返回的空间，尾节点为空时释放，用于写入失败。
+ * @param buf 缓冲区指针。
+ */
+void iobuf_unreserve(iobuf *buf) {
+  iobuf_node *node = buf->tail;
+  iobuf_node *prev;
+
+  if (!node || node->len)
+    return;
+
+  if (buf->head == node) {
+    buf->head = NULL;
+    buf->tail = NULL;
+  } else {
+    for (prev = buf->head; prev->next != node; prev = prev->next)
+      ;
+    prev->next = NULL;
+    buf->tail = prev;
+  }
+  buf->count--;
+  iobuf_node_free(node);
+}
+
+/**
+ * @brief 复制数据到尾部。
+ * @param buf 缓冲区指针。
+ * @param data 数据指针。
+ * @param len 字节数。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err。
+ */
+ret_val iobuf_append(iobuf *buf, const void *data, size_t len) {
+  unsigned char *dst;
+
+  if (!len)
+    return ret_ok;
+  dst = iobuf_reserve(buf, len, NULL);
+  if (!dst)
+    return ret_err;
+  memcpy(dst, data, len);
+  iobuf_commit(buf, len);
+  return ret_ok;
+}
+
+/**
+ * @brief 不复制地将外部数据作为新段追加到尾部，之后不会写入该段。
+ * @param buf 缓冲区指针。
+ * @param data 数据指针。
+ * @param len 字节数。
+ * @param free_func 最后一个引用释放时调用，可为 NULL。
+ * @param ctx 释放函数的上下文。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err，此时不调用释放函数。
+ */
+ret_val iobuf_append_external(iobuf *buf, void *data, size_t len,
+                              iobuf_free_func free_func, void *ctx) {
+  iobuf_seg *seg = iobuf_seg_new(buf->allocator, 0);
+  iobuf_node *node;
+
+  if (!seg)
+    return ret_err;
+  seg->external = 1;
+  seg->cap = len;
+  seg->base = (unsigned char *)data;
+
+  node = iobuf_node_new(seg, seg->base, len);
+  if (!node) {
+    iobuf_seg_release(seg);
+    return ret_err;
+  }
+  seg->free_func = free_func;
+  seg->free_ctx = ctx;
+  iobuf_link_tail(buf, node);
+  return ret_ok;
+}
+
+/**
+ * @brief 复制数据到头部，首段为内部段、未被共享且前部空间足够时不新建段。
+ * @param buf 缓冲区指针。
+ * @param data 数据指针。
+ * @param len 字节数。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err。
+ */
+ret_val iobuf_prepend(iobuf *buf, const void *data, size_t len) {
+  iobuf_node *node = buf->head;
+  iobuf_seg *seg;
+
+  if (!len)
+    return ret_ok;
+
+  if (!node || !iobuf_seg_writable(node->seg) ||
+      (size_t)(node->data - node->seg->base) < len) {
+    /* 新段的数据放在末尾，之后的前置写入可继续使用前部空间 */
+    if (len > SIZE_MAX - IOBUF_DEFAULT_HEADROOM)
+      return ret_err;
+    seg = iobuf_seg_new(buf->allocator, len + IOBUF_DEFAULT_HEADROOM);
+    if (!seg)
+      return ret_err;
+    node = iobuf_node_new(seg, seg->base + seg->cap, 0);
+    if (!node) {
+      iobuf_seg_release(seg);
+      return ret_err;
+    }
+    iobuf_link_head(buf, node);
+  }
+
+  node->data -= len;
+  node->len += len;
+  buf->len += len;
+  memcpy(node->data, data, len);
+  return ret_ok;
+}
+
+/**
+ * @brief 将 src 的全部节点移动到 dst 尾部，不复制数据。
+ * @param dst 目标缓冲区指针。
+ * @param src 源缓冲区指针，返回后为空。
+ */
+void iobuf_append_buf(iobuf *dst, iobuf *src) {
+  if (!src->head)
+    return;
+
+  if (dst->tail)
+    dst->tail->next = src->head;
+  else
+    dst->head = src->head;
+  dst->tail = src->tail;
+  dst->len += src->len;
+  dst->count += src->count;
+
+  src->head = NULL;
+  src->tail = NULL;
+  src->len = 0;
+  src->count = 0;
+}
+
+/**
+ * @brief 从头部丢弃字节。
+ * @param buf 缓冲区指针。
+ * @param n 字节数，超过总长度时清空。
+ */
+void iobuf_trim_front(iobuf *buf, size_t n) {
+  iobuf_node *node;
+
+  if (n >= buf->len) {
+    iobuf_destroy(buf);
+    return;
+  }
+
+  while (n) {
+    node = buf->head;
+    if (node->len > n) {
+      node->data += n;
+      node->len -= n;
+      buf->len -= n;
+      return;
+    }
+    n -= node->len;
+    buf->len -= node->len;
+    buf->head = node->next;
+    buf->count--;
+    iobuf_node_free(node);
+  }
+}
+
+/**
+ * @brief 从尾部丢弃字节。
+ * @param buf 缓冲区指针。
+ * @param n 字节数，超过总长度时清空。
+ */
+void iobuf_trim_back(iobuf *buf, size_t n) {
+  size_t keep;
+  iobuf_node *node;
+  iobuf_node *next;
+
+  if (n >= buf->len) {
+    iobuf_destroy(buf);
+    return;
+  }
+  if (!n)
+    return;
+
+  /* 找到保留部分的最后一个节点，截断后释放其后的节点 */
+  keep = buf->len - n;
+  node = buf->head;
+  while (node->len < keep) {
+    keep -= node->len;
+    node = node->next;
+  }
+  node->len = keep;
+  next = node->next;
+  node->next = NULL;
+  buf->tail = node;
+  buf->len -= n;
+
+  while (next) {
+    node = next;
+    next = node->next;
+    buf->count--;
+    iobuf_node_free(node);
+  }
+}
+
+/**
+ * @brief 以共享方式取出一段字节追加到 dst，不复制数据。
+ * @param src 源缓冲区指针。
+ * @param off 起始偏移。
+ * @param len 字节数。
+ * @param dst 目标缓冲区指针。
+ * @return 成功返回 ret_ok，范围越界或内存不足返回 ret_err。
+ */
+ret_val iobuf_slice(const iobuf *src, size_t off, size_t len, iobuf *dst) {
+  iobuf_node *node;
+  iobuf_node *copy;
+  iobuf slice;
+  size_t n;
+
+  if (off > src->len || len > src->len - off)
+    return ret_err;
+
+  iobuf_init(&slice, dst->allocator);
+  for (node = src->head; node && len; node = node->next) {
+    if (off >= node->len) {
+      off -= node->len;
+      continue;
+    }
+
+    n = node->len - off;
+    if (n > len)
+      n = len;
+    copy = iobuf_node_new(node->seg, node->data + off, n);
+    if (!copy) {
+      iobuf_destroy(&slice);
+      return ret_err;
+    }
+    __atomic_add_fetch(&node->seg->refs, 1, __ATOMIC_RELAXED);
+    iobuf_link_tail(&slice, copy);
+    len -= n;
+    off = 0;
+  }
+
+  iobuf_append_buf(dst, &slice);
+  return ret_ok;
+}
+
+/**
+ * @brief 将全部字节合并到一个连续段中，已连续时不复制。
+ * @param buf 缓冲区指针。
+ * @return 返回连续数据的起始地址，空缓冲区或内存不足返回 NULL。
+ */
+unsigned char *iobuf_coalesce(iobuf *buf) {
+  iobuf merged;
+  iobuf_node *node;
+  unsigned char *dst;
+
+  if (!buf->len)
+    return NULL;
+  if (buf->count == 1)
+    return buf->head->data;
+
+  iobuf_init(&merged, buf->allocator);
+  dst = iobuf_reserve(&merged, buf->len, NULL);
+  if (!dst)
+    return NULL;
+  each_node_for_iobuf(node, buf) {
+    memcpy(dst, node->data, node->len);
+    dst += node->len;
+  }
+  iobuf_commit(&merged, buf->len);
+
+  iobuf_destroy(buf);
+  iobuf_append_buf(buf, &merged);
+  return buf->head->data;
+}
+
+/**
+ * @brief 复制一段字节到平坦内存。
+ * @param buf 缓冲区指针。
+ * @param off 起始偏移。
+ * @param dst 目标内存。
+ * @param len 最多复制的字节数。
+ * @return 返回实际复制的字节数。
+ */
+size_t iobuf_copy_out(const iobuf *buf, size_t off, void *dst, size_t len) {
+  unsigned char *out = (unsigned char *)dst;
+  iobuf_node *node;
+  size_t copied = 0;
+  size_t n;
+
+  for (node = buf->head; node && copied < len; node = node->next) {
+    if (off >= node->len) {
+      off -= node->len;
+      continue;
+    }
+
+    n = node->len - off;
+    if (n > len - copied)
+      n = len - copied;
+    memcpy(out + copied, node->data + off, n);
+    copied += n;
+    off = 0;
+  }
+  return copied;
+}
+
+/**
+ * @brief 将节点转换为 iovec 数组，不复制数据。
+ * @param buf 缓冲区指针。
+ * @param iov iovec 数组。
+ * @param max 数组长度。
+ * @return 返回填充的元素数，节点数超过 max 时只填充前 max 个。
+ */
+int iobuf_to_iovec(const iobuf *buf, struct iovec *iov, int max) {
+  iobuf_node *node;
+  int n = 0;
+
+  for (node = buf->head; node && n < max; node = node->next) {
+    if (!node->len)
+      continue;
+    iov[n].iov_base = node->data;
+    iov[n].iov_len = node->len;
+    n++;
+  }
+  return n;
+}
+
+/**
+ * @brief 将 iovec 数组中的数据复制到尾部。
+ * @param buf 缓冲区指针。
+ * @param iov iovec 数组。
+ * @param n 数组长度。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err。
+ */
+ret_val iobuf_from_iovec(iobuf *buf, const struct iovec *iov, int n) {
+  unsigned char *dst;
+  size_t total = 0;
+  int i;
+
+  for (i = 0; i < n; i++) {
+    if (iov[i].iov_len > SIZE_MAX - total)
+      return ret_err;
+    total += iov[i].iov_len;
+  }
+  if (!total)
+    return ret_ok;
+
+  dst = iobuf_reserve(buf, total, NULL);
+  if (!dst)
+    return ret_err;
+  for (i = 0; i < n; i++) {
+    memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+    dst += iov[i].iov_len;
+  }
+  iobuf_commit(buf, total);
+  return ret_ok;
+}
@@ -0,0 +1,116 @@
+/**
+ * @brief: 侵入式链表头文件，链表节点嵌入在用户结构体中
+ * @file: ilist.h
+ * @author: moecly
+ */
+
+#ifndef __ILIST_H_
+#define __ILIST_H_
+
+#include "../../common/inc/common.h"
+#include <stdint.h>
+
+/**
+ * @brief: 侵入式链表节点结构定义，嵌入到用户结构体中使用
+ */
+typedef struct ilist_node {
+  struct ilist_node *prev; /* 指向前一个节点 */
+  struct ilist_node *next; /* 指向后一个节点 */
+} ilist_node;
+
+/**
+ * @brief: 侵入式链表结构定义，哨兵节点内嵌于链表中，首尾相连
+ */
+typedef struct {
+  ilist_node head; /* 哨兵节点 */
+  uint32_t len;    /* 链表长度 */
+} ilist;
+
+#ifndef ILIST_HEAD_NODE
+#define ILIST_HEAD_NODE(list) ((list)->head.next)
+#endif // !ILIST_HEAD_NODE
+
+#ifndef ILIST_TAIL_NODE
+#define ILIST_TAIL_NODE(list) ((list)->head.prev)
+#endif // !ILIST_TAIL_NODE
+
+#ifndef ILIST_ENTRY
+#define ILIST_ENTRY(nd, type, member) container_of(nd, type, member)
+#endif // !ILIST_ENTRY
+
+#ifndef ILIST_INIT
+#define ILIST_INIT(list)                                                       \
+  { {&(list).head, &(list).head}, 0 }
+#endif // !ILIST_INIT
+
+/* 定义一个宏，用于遍历侵入式链表节点 */
+#define each_node_for_ilist(node, list)                                        \
+  for (node = ILIST_HEAD_NODE(list); node != &(list)->head; node = node->next)
+
+/* 定义一个宏，用于遍历侵入式链表节点，遍历过程中允许删除当前节点 */
+#define each_node_for_ilist_safe(node, tmp, list)                              \
+  for (node = ILIST_HEAD_NODE(list), tmp = node->next; node != &(list)->head;  \
+       node = tmp, tmp = node->next)
+
+/* 定义一个宏，用于直接遍历侵入式链表中的用户结构体 */
+#define each_entry_for_ilist(pos, list, type, member)                          \
+  for (pos = ILIST_ENTRY(ILIST_HEAD_NODE(list), type, member);                 \
+       &pos->member != &(list)->head;                                          \
+       pos = ILIST_ENTRY(pos->member.next, type, member))
+
+/**
+ * @brief: 初始化侵入式链表
+ * @param list: 链表指针
+ */
+void ilist_init(ilist *list);
+
+/**
+ * @brief: 将节点插入链表头部
+ * @param list: 链表指针
+ * @param nd: 要插入的节点
+ */
+void ilist_push_to_head(ilist *list, ilist_node *nd);
+
+/**
+ * @brief: 将节点插入链表尾部
+ * @param list: 链表指针
+ * @param nd: 要插入的节点
+ */
+void ilist_push_to_tail(ilist *list, ilist_node *nd);
+
+/**
+ * @brief: 从链表头部弹出节点
+ * @param list: 链表指针
+ * @return: 返回头部节点，链表为空返回 NULL
+ */
+ilist_node *ilist_pop_from_head(ilist *list);
+
+/**
+ * @brief: 从链表尾部弹出节点
+ * @param list: 链表指针
+ * @return: 返回尾部节点，链表为空返回 NULL
+ */
+ilist_node *ilist_pop_from_tail(ilist *list);
+
+/**
+ * @brief: 将节点从链表中删除，节点内存由调用者管理
+ * @param list: 链表指针
+ * @param nd: 要删除的节点
+ */
+void ilist_del(ilist *list, ilist_node *nd);
+
+/**
+ * @brief: 判断链表是否为空
+ * @param list: 链表指针
+ * @return: 链表为空返回 1，否则返回 0
+ */
+int ilist_empty(ilist *list);
+
+/**
+ * @brief: 获取链表长度
+ * @param list: 链表指针
+ * @return: 返回链表的长度
+ */
+uint32_t ilist_get_length(ilist *list);
+
+#endif // !__ILIST_H_
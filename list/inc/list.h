@@ -7,6 +7,7 @@
 #ifndef __LIST_H_
 #define __LIST_H_
 
+#include "../../common/inc/common.h"
 #include "stdlib.h"
 #include <stdint.h>
 
@@ -19,15 +20,80 @@ typedef struct list_node {
   void *val;              /* 节点存储的值 */
 } list_node;
 
+/**
+ * @brief: slab 内存块结构定义，一次申请 nodes_per_slab 个节点
+ */
+typedef struct list_slab_chunk {
+  struct list_slab_chunk *next; /* 指向下一个 slab 内存块 */
+  list_node nodes[];            /* 内存块中的节点数组 */
+} list_slab_chunk;
+
+/**
+ * @brief: 链表节点 slab 分配器结构定义
+ */
+typedef struct {
+  list_slab_chunk *chunks; /* 已申请的 slab 内存块链表 */
+  list_node *free_nodes;   /* 空闲节点链表，通过 next 串联 */
+  uint32_t nodes_per_slab; /* 每个 slab 内存块包含的节点数 */
+  uint32_t used;           /* 当前内存块中已切分的节点数 */
+  mem_allocator *allocator; /* 内存块分配器，为 NULL 时使用默认分配器 */
+} list_slab;
+
+/**
+ * @brief: 跳表索引层结构定义
+ */
+typedef struct list_skip_level {
+  struct list_skip_node *next; /* 同一层的下一个索引节点 */
+  uint32_t span;               /* 到下一个索引节点跨越的链表节点数 */
+} list_skip_level;
+
+/**
+ * @brief: 跳表索引节点结构定义，只有部分链表节点拥有索引节点
+ */
+typedef struct list_skip_node {
+  list_node *nd;           /* 索引节点对应的链表节点 */
+  list_skip_level level[]; /* 各层的索引信息 */
+} list_skip_node;
+
+/**
+ * @brief: 链表顺序统计跳表索引结构定义
+ */
+typedef struct {
+  list_skip_node *header; /* 索引头节点，对应链表头哨兵 */
+  uint32_t level;         /* 当前使用的索引层数 */
+  uint32_t seed;          /* 随机层高的种子 */
+} list_skip_index;
+
 /**
  * @brief: 链表结构定义
  */
 typedef struct {
-  list_node *head; /* 链表头节点 */
-  list_node *tail; /* 链表尾节点 */
-  uint32_t len;    /* 链表长度 */
+  list_node *head;        /* 链表头节点 */
+  list_node *tail;        /* 链表尾节点 */
+  uint32_t len;           /* 链表长度 */
+  uint8_t own_slab;       /* slab 分配器是否由链表持有 */
+  list_slab *slab;        /* 节点分配器，为 NULL 时使用 MALLOC_FUNC */
+  list_skip_index *index; /* 跳表索引，为 NULL 时按索引访问需遍历链表 */
+  mem_allocator *allocator; /* 内存分配器，为 NULL 时使用默认分配器 */
 } pn_list;
 
+/**
+ * @brief: 链表值比较函数，a 小于、等于、大于 b 时分别返回负数、0、正数
+ */
+typedef int (*list_cmp_func)(const void *a, const void *b);
+
+#ifndef LIST_SORT_MAX_THREADS
+#define LIST_SORT_MAX_THREADS 64
+#endif // !LIST_SORT_MAX_THREADS
+
+#ifndef LIST_SKIP_MAX_LEVEL
+#define LIST_SKIP_MAX_LEVEL 16
+#endif // !LIST_SKIP_MAX_LEVEL
+
+#ifndef LIST_SLAB_DEFAULT_NODES
+#define LIST_SLAB_DEFAULT_NODES 256
+#endif // !LIST_SLAB_DEFAULT_NODES
+
 #ifndef SET_NODE
 #define SET_NODE(src, dst, property) src->property = dst;
 #endif // !SET_NODE
@@ -76,10 +142,26 @@ typedef struct {
 #define NODE_VAL(nd) (nd->val)
 #endif // !NODE_VAL
 
+#ifndef LIST_SLAB
+#define LIST_SLAB(list) (list->slab)
+#endif // !LIST_SLAB
+
+#ifndef LIST_INDEX
+#define LIST_INDEX(list) (list->index)
+#endif // !LIST_INDEX
+
+#ifndef LIST_ALLOCATOR
+#define LIST_ALLOCATOR(list) (list->allocator)
+#endif // !LIST_ALLOCATOR
+
 #ifndef LIST_INIT
 #define LIST_INIT(list)                                                        \
   list = MALLOC_FUNC(pn_list);                                                 \
   SET_LIST_LEN(list, 0);                                                       \
+  LIST_SLAB(list) = NULL;                                                      \
+  LIST_INDEX(list) = NULL;                                                     \
+  LIST_ALLOCATOR(list) = NULL;                                                 \
+  list->own_slab = 0;                                                          \
   LIST_TAIL(list) = MALLOC_FUNC(list_node);                                    \
   LIST_HEAD(list) = MALLOC_FUNC(list_node);                                    \
   SET_NODE_NEXT(LIST_HEAD(list), LIST_TAIL(list));                             \
@@ -116,11 +198,105 @@ typedef struct {
 pn_list *list_new(void);
 
 /**
- * @brief: 释放链表及其节点
+ * @brief: 创建一个使用独立 slab 分配器的链表
+ * @param nodes_per_slab: 每个 slab 内存块的节点数，为 0 时使用默认值
+ * @return: 返回一个指向新链表的指针，失败返回 NULL
+ */
+pn_list *list_new_slab(uint32_t nodes_per_slab);
+
+/**
+ * @brief: 创建一个使用外部 slab 分配器的链表，分配器可被多个链表共享
+ * @param slab: slab 分配器指针，例如 list_slab_thread_local() 的返回值
+ * @return: 返回一个指向新链表的指针，失败返回 NULL
+ */
+pn_list *list_new_with_slab(list_slab *slab);
+
+/**
+ * @brief: 创建一个使用指定内存分配器的链表，链表、节点和索引均由其申请
+ *
+ * 传入 arena_get_allocator() 的返回值时，链表随 arena 一起释放，无需调用
+ * list_free()。
+ *
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器
+ * @return: 返回一个指向新链表的指针，失败返回 NULL
+ */
+pn_list *list_new_with_allocator(mem_allocator *allocator);
+
+/**
+ * @brief: 创建一个使用独立 slab 分配器的链表，slab 内存块由指定分配器申请
+ * @param nodes_per_slab: 每个 slab 内存块的节点数，为 0 时使用默认值
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器
+ * @return: 返回一个指向新链表的指针，失败返回 NULL
+ */
+pn_list *list_new_slab_with_allocator(uint32_t nodes_per_slab,
+                                      mem_allocator *allocator);
+
+/**
+ * @brief: 释放链表及其节点，独立 slab 模式下整块释放内存
  * @param list: 链表指针
  */
 void list_free(pn_list *list);
 
+/**
+ * @brief: 初始化 slab 分配器
+ * @param slab: slab 分配器指针
+ * @param nodes_per_slab: 每个 slab 内存块的节点数，为 0 时使用默认值
+ */
+void list_slab_init(list_slab *slab, uint32_t nodes_per_slab);
+
+/**
+ * @brief: 初始化使用指定内存分配器申请内存块的 slab 分配器
+ * @param slab: slab 分配器指针
+ * @param nodes_per_slab: 每个 slab 内存块的节点数，为 0 时使用默认值
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器
+ */
+void list_slab_init_with_allocator(list_slab *slab, uint32_t nodes_per_slab,
+                                   mem_allocator *allocator);
+
+/**
+ * @brief: 释放 slab 分配器申请的全部内存块
+ * @param slab: slab 分配器指针
+ */
+void list_slab_destroy(list_slab *slab);
+
+/**
+ * @brief: 获取当前线程的 slab 分配器，仅能在本线程内使用
+ *
+ * 线程退出时自动释放其内存块，使用它的链表不能比线程存活得更久。
+ *
+ * @return: 返回当前线程的 slab 分配器指针
+ */
+list_slab *list_slab_thread_local(void);
+
+/**
+ * @brief: 立即释放当前线程的 slab 分配器，适用于主线程等长期存活的线程
+ *
+ * 调用者需保证使用它的链表均已释放，之后再次获取时重新初始化。
+ */
+void list_slab_thread_release(void);
+
+/**
+ * @brief: 从 slab 分配器中申请一个节点
+ * @param slab: slab 分配器指针
+ * @return: 返回节点指针，失败返回 NULL
+ */
+list_node *list_slab_alloc(list_slab *slab);
+
+/**
+ * @brief: 从 slab 分配器中一次申请 n 个连续节点，节点位于独立的内存块中
+ * @param slab: slab 分配器指针
+ * @param n: 节点数
+ * @return: 返回节点数组首地址，失败返回 NULL
+ */
+list_node *list_slab_alloc_bulk(list_slab *slab, uint32_t n);
+
+/**
+ * @brief: 将节点归还到 slab 分配器的空闲链表
+ * @param slab: slab 分配器指针
+ * @param nd: 要归还的节点
+ */
+void list_slab_recycle(list_slab *slab, list_node *nd);
+
 /**
  * @brief: 将节点插入链表头部
  * @param list: 链表指针
@@ -150,7 +326,114 @@ void list_push_to_head(pn_list *list, void *val);
 void list_push_to_tail(pn_list *list, void *val);
 
 /**
- * @brief: 从索引获取节点
+ * @brief: 将数组中的值依次插入链表尾部，只链接一次并更新一次长度
+ *
+ * slab 模式下全部节点在一个内存块中申请，否则通过内存分配器逐个申请。
+ *
+ * @param list: 链表指针
+ * @param vals: 值数组
+ * @param n: 值的数量
+ * @return: 成功返回 ret_ok，内存不足返回 ret_err 且链表不变
+ */
+ret_val list_push_array_to_tail(pn_list *list, void **vals, uint32_t n);
+
+/**
+ * @brief: 将 other 的全部节点移动到 list 中 prev 节点之后，other 变为空链表
+ *
+ * 未开启索引时为 O(1)。两个链表需使用同一节点分配器（使用同一个内存分配器，
+ * 或共享同一个 slab 分配器）。
+ *
+ * @param list: 目标链表指针
+ * @param prev: 插入位置的前一个节点，可为 LIST_HEAD(list)
+ * @param other: 源链表指针
+ * @return: 成功返回 ret_ok，两个链表相同、节点分配器不同或重建索引时内存不足
+ * 返回 ret_err，此时两个链表不变
+ */
+ret_val list_splice(pn_list *list, list_node *prev, pn_list *other);
+
+/**
+ * @brief: 将 other 的全部节点移动到 list 尾部，other 变为空链表
+ * @param list: 目标链表指针
+ * @param other: 源链表指针
+ * @return: 成功返回 ret_ok，两个链表相同、节点分配器不同或重建索引时内存不足
+ * 返回 ret_err，此时两个链表不变
+ */
+ret_val list_concat(pn_list *list, pn_list *other);
+
+/**
+ * @brief: 从 nd 处切分链表，将 nd 及其之后的节点移动到 dst 尾部
+ *
+ * 只重新链接首尾节点，但需要遍历被切分部分以计算长度。
+ *
+ * @param list: 源链表指针
+ * @param nd: 切分位置，属于 list 的数据节点
+ * @param dst: 目标链表指针，需与 list 使用同一节点分配器
+ * @return: 成功返回 ret_ok，两个链表相同、节点分配器不同或重建索引时内存不足
+ * 返回 ret_err，此时两个链表不变
+ */
+ret_val list_cut(pn_list *list, list_node *nd, pn_list *dst);
+
+/**
+ * @brief: 对链表进行原地稳定归并排序，只修改节点链接，不申请内存
+ * @param list: 链表指针
+ * @param cmp: 值比较函数
+ */
+void list_sort(pn_list *list, list_cmp_func cmp);
+
+/**
+ * @brief: 多线程原地稳定归并排序，各线程排序一段子链表后再归并
+ * @param list: 链表指针
+ * @param cmp: 值比较函数，需可被多个线程同时调用
+ * @param threads: 线程数，最多 LIST_SORT_MAX_THREADS，为 0 或 1 时单线程排序
+ */
+void list_sort_parallel(pn_list *list, list_cmp_func cmp, uint32_t threads);
+
+/**
+ * @brief: 从链表头部弹出值，并回收节点
+ * @param list: 链表指针
+ * @return: 返回头部节点的值，链表为空返回 NULL
+ */
+void *list_pop_from_head(pn_list *list);
+
+/**
+ * @brief: 从链表尾部弹出值，并回收节点
+ * @param list: 链表指针
+ * @return: 返回尾部节点的值，链表为空返回 NULL
+ */
+void *list_pop_from_tail(pn_list *list);
+
+/**
+ * @brief: 为链表开启跳表索引，之后按索引读取、插入、删除均为 O(log n)
+ * @param list: 链表指针
+ * @return: 成功返回 ret_ok，内存不足返回 ret_err
+ */
+ret_val list_index_enable(pn_list *list);
+
+/**
+ * @brief: 关闭链表的跳表索引并释放索引内存
+ * @param list: 链表指针
+ */
+void list_index_disable(pn_list *list);
+
+/**
+ * @brief: 在指定索引处插入值，原索引及之后的节点后移
+ * @param list: 链表指针
+ * @param idx: 插入位置，取值范围为 [0, len]
+ * @param val: 要插入的值
+ * @return: 成功返回 ret_ok，索引无效或内存不足返回 ret_err
+ */
+ret_val list_insert_to_index(pn_list *list, uint32_t idx, void *val);
+
+/**
+ * @brief: 删除指定索引处的节点，并回收节点
+ * @param list: 链表指针
+ * @param idx: 要删除的节点的索引
+ * @return: 返回被删除节点的值，如果索引无效返回 NULL
+ */
+void *list_remove_from_index(pn_list *list, uint32_t idx);
+
+/**
+ * @brief: 从索引获取节点，未开启索引时从距离较近的一端开始遍历
  * @param list: 链表指针
  * @param idx: 要获取的节点的索引
  * @return: 返回指向节点的指针，如果索引无效返回 NULL
@@ -0,0 +1,87 @@
+/**
+ * @brief: 无锁多生产者单消费者队列头文件，节点复用 list_node 结构
+ * @file: mpsc_queue.h
+ * @author: moecly
+ */
+
+#ifndef __MPSC_QUEUE_H_
+#define __MPSC_QUEUE_H_
+
+#include "../../common/inc/common.h"
+#include "list.h"
+#include <stdint.h>
+
+/* 缓存行大小，用于隔离生产者端和消费者端 */
+#ifndef MPSC_CACHE_LINE
+#define MPSC_CACHE_LINE 64
+#endif // !MPSC_CACHE_LINE
+
+/**
+ * @brief: 无锁多生产者单消费者队列结构定义（Vyukov 侵入式队列）
+ *
+ * 节点通过 list_node 的 next 串联，prev 不使用，val 由调用者自由使用。
+ */
+typedef struct {
+  /* 生产者端，最新入队节点 */
+  list_node *head;
+  /* 填充到缓存行末尾，避免生产者与消费者伪共享 */
+  char head_pad[MPSC_CACHE_LINE - sizeof(list_node *)];
+  list_node *tail; /* 消费者端，下一个出队节点 */
+  list_node stub;  /* 哨兵节点 */
+  int efd;         /* 唤醒消费者的 eventfd，为 -1 表示不使用 */
+  int sleeping;    /* 消费者是否正在等待 */
+} mpsc_queue;
+
+/**
+ * @brief: 初始化队列
+ * @param q: 队列指针
+ * @param use_eventfd: 为非 0 时创建 eventfd 以支持 mpsc_queue_wait()
+ * @return: 成功返回 ret_ok，创建 eventfd 失败返回 ret_err
+ */
+ret_val mpsc_queue_init(mpsc_queue *q, int use_eventfd);
+
+/**
+ * @brief: 销毁队列，队列中剩余节点由调用者处理
+ * @param q: 队列指针
+ */
+void mpsc_queue_destroy(mpsc_queue *q);
+
+/**
+ * @brief: 节点入队，可被多个线程同时调用
+ * @param q: 队列指针
+ * @param nd: 要入队的节点
+ */
+void mpsc_queue_push(mpsc_queue *q, list_node *nd);
+
+/**
+ * @brief: 节点出队，只能由消费者线程调用
+ * @param q: 队列指针
+ * @return: 返回出队节点，队列为空或生产者尚未完成入队返回 NULL
+ */
+list_node *mpsc_queue_pop(mpsc_queue *q);
+
+/**
+ * @brief: 批量出队，只能由消费者线程调用
+ * @param q: 队列指针
+ * @param nds: 保存出队节点的数组
+ * @param max: 数组容量
+ * @return: 返回出队节点数
+ */
+uint32_t mpsc_queue_pop_batch(mpsc_queue *q, list_node **nds, uint32_t max);
+
+/**
+ * @brief: 判断队列是否为空，只能由消费者线程调用
+ * @param q: 队列指针
+ * @return: 队列为空返回 1，否则返回 0
+ */
+int mpsc_queue_empty(mpsc_queue *q);
+
+/**
+ * @brief: 队列为空时通过 eventfd 休眠等待生产者唤醒
+ * @param q: 队列指针
+ * @param timeout_ms: 超时时间（毫秒），为 -1 时一直等待
+ * @return: 队列非空返回 ret_ok，超时或未启用 eventfd 返回 ret_err
+ */
+ret_val mpsc_queue_wait(mpsc_queue *q, int timeout_ms);
+
+#endif // !__MPSC_QUEUE_H_
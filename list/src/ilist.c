@@ -0,0 +1,110 @@
+/**
+ * @file ilist.c
+ * @brief 侵入式链表实现文件，节点内存由调用者管理，链表本身不申请内存。
+ * @author moecly
+ */
+
+#include "../inc/ilist.h"
+
+/**
+ * @brief 将节点插入到两个相邻节点之间。
+ * @param list 链表指针。
+ * @param nd 要插入的节点。
+ * @param prev 前一个节点。
+ * @param next 后一个节点。
+ */
+static void ilist_insert(ilist *list, ilist_node *nd, ilist_node *prev,
+                         ilist_node *next) {
+  nd->prev = prev;
+  nd->next = next;
+  prev->next = nd;
+  next->prev = nd;
+  list->len++;
+}
+
+/**
+ * @brief 初始化侵入式链表。
+ * @param list 链表指针。
+ */
+void ilist_init(ilist *list) {
+  list->head.prev = &list->head;
+  list->head.next = &list->head;
+  list->len = 0;
+}
+
+/**
+ * @brief 将节点插入链表头部。
+ * @param list 链表指针。
+ * @param nd 要插入的节点。
+ */
+void ilist_push_to_head(ilist *list, ilist_node *nd) {
+  ilist_insert(list, nd, &list->head, list->head.next);
+}
+
+/**
+ * @brief 将节点插入链表尾部。
+ * @param list 链表指针。
+ * @param nd 要插入的节点。
+ */
+void ilist_push_to_tail(ilist *list, ilist_node *nd) {
+  ilist_insert(list, nd, list->head.prev, &list->head);
+}
+
+/**
+ * @brief 将节点从链表中删除，节点内存由调用者管理。
+ * @param list 链表指针。
+ * @param nd 要删除的节点。
+ */
+void ilist_del(ilist *list, ilist_node *nd) {
+  nd->prev->next = nd->next;
+  nd->next->prev = nd->prev;
+  nd->prev = NULL;
+  nd->next = NULL;
+  list->len--;
+}
+
+/**
+ * @brief 从链表头部弹出节点。
+ * @param list 链表指针。
+ * @return 返回头部节点，链表为空返回 NULL。
+ */
+ilist_node *ilist_pop_from_head(ilist *list) {
+  ilist_node *nd;
+
+  if (ilist_empty(list))
+    return NULL;
+
+  nd = ILIST_HEAD_NODE(list);
+  ilist_del(list, nd);
+  return nd;
+}
+
+/**
+ * @brief 从链表尾部弹出节点。
+ * @param list 链表指针。
+ * @return 返回尾部节点，链表为空返回 NULL。
+ */
+ilist_node *ilist_pop_from_tail(ilist *list) {
+  ilist_node *nd;
+
+  if (ilist_empty(list))
+    return NULL;
+
+  nd = ILIST_TAIL_NODE(list);
+  ilist_del(list, nd);
+  return nd;
+}
+
+/**
+ * @brief 判断链表是否为空。
+ * @param list 链表指针。
+ * @return 链表为空返回 1，否则返回 0。
+ */
+int ilist_empty(ilist *list) { return list->head.next == &list->head; }
+
+/**
+ * @brief 获取链表长度。
+ * @param list 链表指针。
+ * @return 返回链表的长度。
+ */
+uint32_t ilist_get_length(ilist *list) { return list->len; }
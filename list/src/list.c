@@ -6,8 +6,242 @@
 
 #include "../inc/list.h"
 #include "../../common/inc/common.h"
+#include <pthread.h>
 #include <stdint.h>
 
+/**
+ * @brief 并行排序中单个线程的任务。
+ */
+typedef struct {
+  list_node *chain;  /* 以 NULL 结尾的单向子链表，排序后保存结果 */
+  list_cmp_func cmp; /* 值比较函数 */
+} list_sort_task;
+
+/* 每个线程私有的 slab 分配器 */
+static __thread list_slab thread_slab;
+
+/* 线程退出时释放私有 slab 分配器的线程键 */
+static pthread_key_t thread_slab_key;
+static pthread_once_t thread_slab_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief 初始化 slab 分配器。
+ * @param slab slab 分配器指针。
+ * @param nodes_per_slab 每个 slab 内存块的节点数，为 0 时使用默认值。
+ */
+void list_slab_init(list_slab *slab, uint32_t nodes_per_slab) {
+  list_slab_init_with_allocator(slab, nodes_per_slab, NULL);
+}
+
+/**
+ * @brief 初始化使用指定内存分配器申请内存块的 slab 分配器。
+ * @param slab slab 分配器指针。
+ * @param nodes_per_slab 每个 slab 内存块的节点数，为 0 时使用默认值。
+ * @param allocator 内存分配器指针，为 NULL 时使用默认分配器。
+ */
+void list_slab_init_with_allocator(list_slab *slab, uint32_t nodes_per_slab,
+                                   mem_allocator *allocator) {
+  slab->allocator = allocator;
+  slab->chunks = NULL;
+  slab->free_nodes = NULL;
+  slab->nodes_per_slab =
+      nodes_per_slab ? nodes_per_slab : LIST_SLAB_DEFAULT_NODES;
+  /* 标记当前内存块已用完，首次申请节点时再分配内存块 */
+  slab->used = slab->nodes_per_slab;
+}
+
+/**
+ * @brief 释放 slab 分配器申请的全部内存块。
+ * @param slab slab 分配器指针。
+ */
+void list_slab_destroy(list_slab *slab) {
+  list_slab_chunk *chunk;
+  list_slab_chunk *tmp;
+
+  chunk = slab->chunks;
+  while (chunk) {
+    tmp = chunk->next;
+    mem_free(slab->allocator, chunk);
+    chunk = tmp;
+  }
+  list_slab_init_with_allocator(slab, slab->nodes_per_slab, slab->allocator);
+}
+
+/**
+ * @brief 释放线程私有 slab 分配器的内存块，之后再次使用时重新初始化。
+ * @param arg slab 分配器指针。
+ */
+static void list_slab_thread_destroy(void *arg) {
+  list_slab *slab = (list_slab *)arg;
+
+  list_slab_destroy(slab);
+  slab->nodes_per_slab = 0;
+}
+
+/**
+ * @brief 创建线程私有 slab 分配器的线程键。
+ */
+static void list_slab_thread_key_init(void) {
+  pthread_key_create(&thread_slab_key, list_slab_thread_destroy);
+}
+
+/**
+ * @brief 获取当前线程的 slab 分配器，仅能在本线程内使用。
+ * @return 返回当前线程的 slab 分配器指针。
+ */
+list_slab *list_slab_thread_local(void) {
+  if (!thread_slab.nodes_per_slab) {
+    list_slab_init(&thread_slab, 0);
+    /* 线程退出时由线程键的析构函数释放内存块 */
+    pthread_once(&thread_slab_once, list_slab_thread_key_init);
+    pthread_setspecific(thread_slab_key, &thread_slab);
+  }
+  return &thread_slab;
+}
+
+/**
+ * @brief 立即释放当前线程的 slab 分配器，调用者保证其节点已不再使用。
+ */
+void list_slab_thread_release(void) {
+  if (!thread_slab.nodes_per_slab)
+    return;
+  pthread_setspecific(thread_slab_key, NULL);
+  list_slab_thread_destroy(&thread_slab);
+}
+
+/**
+ * @brief 从 slab 分配器中申请一个节点。
+ * @param slab slab 分配器指针。
+ * @return 返回节点指针，失败返回 NULL。
+ */
+list_node *list_slab_alloc(list_slab *slab) {
+  list_slab_chunk *chunk;
+  list_node *nd;
+
+  /* 优先复用空闲链表中的节点 */
+  nd = slab->free_nodes;
+  if (nd) {
+    slab->free_nodes = NODE_NEXT(nd);
+    return nd;
+  }
+
+  /* 当前内存块已切分完，申请新的内存块 */
+  if (slab->used >= slab->nodes_per_slab) {
+    chunk = (list_slab_chunk *)mem_alloc(
+        slab->allocator,
+        sizeof(list_slab_chunk) + sizeof(list_node) * slab->nodes_per_slab);
+    if (!chunk)
+      return NULL;
+    chunk->next = slab->chunks;
+    slab->chunks = chunk;
+    slab->used = 0;
+  }
+
+  return &slab->chunks->nodes[slab->used++];
+}
+
+/**
+ * @brief 从 slab 分配器中一次申请 n 个连续节点，节点位于独立的内存块中。
+ * @param slab slab 分配器指针。
+ * @param n 节点数。
+ * @return 返回节点数组首地址，失败返回 NULL。
+ */
+list_node *list_slab_alloc_bulk(list_slab *slab, uint32_t n) {
+  list_slab_chunk *chunk;
+
+  chunk = (list_slab_chunk *)mem_alloc(
+      slab->allocator, sizeof(list_slab_chunk) + sizeof(list_node) * n);
+  if (!chunk)
+    return NULL;
+
+  /* 挂在当前切分中的内存块之后，不影响后续单个节点的切分 */
+  if (slab->chunks) {
+    chunk->next = slab->chunks->next;
+    slab->chunks->next = chunk;
+  } else {
+    chunk->next = NULL;
+    slab->chunks = chunk;
+    slab->used = slab->nodes_per_slab;
+  }
+  return chunk->nodes;
+}
+
+/**
+ * @brief 将节点归还到 slab 分配器的空闲链表。
+ * @param slab slab 分配器指针。
+ * @param nd 要归还的节点。
+ */
+void list_slab_recycle(list_slab *slab, list_node *nd) {
+  SET_NODE_NEXT(nd, slab->free_nodes);
+  slab->free_nodes = nd;
+}
+
+/**
+ * @brief 为链表申请一个节点，根据链表模式选择 slab 或内存分配器。
+ * @param list 链表指针。
+ * @return 返回节点指针，失败返回 NULL。
+ */
+static list_node *list_node_alloc(pn_list *list) {
+  if (LIST_SLAB(list))
+    return list_slab_alloc(LIST_SLAB(list));
+  return MEM_ALLOC_FUNC(LIST_ALLOCATOR(list), list_node);
+}
+
+/**
+ * @brief 释放链表节点，根据链表模式归还 slab 或内存分配器。
+ * @param list 链表指针。
+ * @param nd 要释放的节点。
+ */
+static void list_node_release(pn_list *list, list_node *nd) {
+  if (LIST_SLAB(list))
+    list_slab_recycle(LIST_SLAB(list), nd);
+  else
+    mem_free(LIST_ALLOCATOR(list), nd);
+}
+
+/**
+ * @brief 使用 slab 分配器创建链表，哨兵节点同样从 slab 中申请。
+ * @param slab slab 分配器指针。
+ * @param own_slab 链表是否持有 slab 分配器。
+ * @return 返回一个指向新链表的指针，失败返回 NULL。
+ */
+static pn_list *list_new_from_slab(list_slab *slab, uint8_t own_slab) {
+  pn_list *list = MEM_ALLOC_FUNC(slab->allocator, pn_list);
+  if (!list) {
+    if (own_slab)
+      mem_free(slab->allocator, slab);
+    return NULL;
+  }
+
+  LIST_SLAB(list) = slab;
+  LIST_INDEX(list) = NULL;
+  LIST_ALLOCATOR(list) = slab->allocator;
+  list->own_slab = own_slab;
+  SET_LIST_LEN(list, 0);
+  LIST_HEAD(list) = list_slab_alloc(slab);
+  LIST_TAIL(list) = list_slab_alloc(slab);
+  if (!LIST_HEAD(list) || !LIST_TAIL(list))
+    goto err_alloc;
+
+  SET_NODE_NEXT(LIST_HEAD(list), LIST_TAIL(list));
+  SET_NODE_PREV(LIST_TAIL(list), LIST_HEAD(list));
+  SET_NODE_PREV(LIST_HEAD(list), NULL);
+  SET_NODE_NEXT(LIST_TAIL(list), NULL);
+  return list;
+
+err_alloc:
+  if (LIST_HEAD(list))
+    list_slab_recycle(slab, LIST_HEAD(list));
+  if (LIST_TAIL(list))
+    list_slab_recycle(slab, LIST_TAIL(list));
+  if (own_slab) {
+    list_slab_destroy(slab);
+    mem_free(LIST_ALLOCATOR(list), slab);
+  }
+  mem_free(LIST_ALLOCATOR(list), list);
+  return NULL;
+}
+
 /**
  * @brief 创建一个新的链表。
  * @return 返回一个指向新链表的指针。
@@ -20,10 +254,475 @@ pn_list *list_new(void) {
 }
 
 /**
- * @brief 释放链表及其节点。
+ * @brief 创建一个使用独立 slab 分配器的链表。
+ * @param nodes_per_slab 每个 slab 内存块的节点数，为 0 时使用默认值。
+ * @return 返回一个指向新链表的指针，失败返回 NULL。
+ */
+pn_list *list_new_slab(uint32_t nodes_per_slab) {
+  return list_new_slab_with_allocator(nodes_per_slab, NULL);
+}
+
+/**
+ * @brief 创建一个使用独立 slab 分配器的链表，slab 内存块由指定分配器申请。
+ * @param nodes_per_slab 每个 slab 内存块的节点数，为 0 时使用默认值。
+ * @param allocator 内存分配器指针，为 NULL 时使用默认分配器。
+ * @return 返回一个指向新链表的指针，失败返回 NULL。
+ */
+pn_list *list_new_slab_with_allocator(uint32_t nodes_per_slab,
+                                      mem_allocator *allocator) {
+  list_slab *slab = MEM_ALLOC_FUNC(allocator, list_slab);
+  if (!slab)
+    return NULL;
+
+  list_slab_init_with_allocator(slab, nodes_per_slab, allocator);
+  return list_new_from_slab(slab, 1);
+}
+
+/**
+ * @brief 创建一个使用外部 slab 分配器的链表，分配器可被多个链表共享。
+ * @param slab slab 分配器指针。
+ * @return 返回一个指向新链表的指针，失败返回 NULL。
+ */
+pn_list *list_new_with_slab(list_slab *slab) {
+  return list_new_from_slab(slab, 0);
+}
+
+/**
+ * @brief 创建一个使用指定内存分配器的链表，链表、节点和索引均由其申请。
+ * @param allocator 内存分配器指针，为 NULL 时使用默认分配器。
+ * @return 返回一个指向新链表的指针，失败返回 NULL。
+ */
+pn_list *list_new_with_allocator(mem_allocator *allocator) {
+  pn_list *list = MEM_ALLOC_FUNC(allocator, pn_list);
+  if (!list)
+    return NULL;
+
+  LIST_SLAB(list) = NULL;
+  LIST_INDEX(list) = NULL;
+  LIST_ALLOCATOR(list) = allocator;
+  list->own_slab = 0;
+  SET_LIST_LEN(list, 0);
+  LIST_HEAD(list) = MEM_ALLOC_FUNC(allocator, list_node);
+  LIST_TAIL(list) = MEM_ALLOC_FUNC(allocator, list_node);
+  if (!LIST_HEAD(list) || !LIST_TAIL(list)) {
+    mem_free(allocator, LIST_HEAD(list));
+    mem_free(allocator, LIST_TAIL(list));
+    mem_free(allocator, list);
+    return NULL;
+  }
+
+  SET_NODE_NEXT(LIST_HEAD(list), LIST_TAIL(list));
+  SET_NODE_PREV(LIST_TAIL(list), LIST_HEAD(list));
+  SET_NODE_PREV(LIST_HEAD(list), NULL);
+  SET_NODE_NEXT(LIST_TAIL(list), NULL);
+  return list;
+}
+
+/**
+ * @brief 释放链表及其节点，独立 slab 模式下整块释放内存。
+ * @param list 链表指针。
+ */
+void list_free(pn_list *list) {
+  list_node *nd;
+  list_node *tmp;
+
+  list_index_disable(list);
+  if (!LIST_SLAB(list) && !LIST_ALLOCATOR(list)) {
+    LIST_FREE(list);
+    return;
+  }
+
+  /* 独立 slab 直接释放全部内存块，无需逐个遍历节点 */
+  if (list->own_slab) {
+    list_slab_destroy(LIST_SLAB(list));
+    mem_free(LIST_ALLOCATOR(list), LIST_SLAB(list));
+    mem_free(LIST_ALLOCATOR(list), list);
+    return;
+  }
+
+  /* 共享 slab 或自定义分配器需将节点（包括哨兵）逐个归还 */
+  nd = LIST_HEAD(list);
+  while (nd) {
+    tmp = NODE_NEXT(nd);
+    list_node_release(list, nd);
+    nd = tmp;
+  }
+  mem_free(LIST_ALLOCATOR(list), list);
+}
+
+/**
+ * @brief 将节点链接到指定节点之后，并增加链表长度。
+ * @param list 链表指针。
+ * @param prev 插入位置的前一个节点。
+ * @param nd 要插入的节点。
+ */
+static void list_link_node(pn_list *list, list_node *prev, list_node *nd) {
+  SET_NODE_NEXT(nd, NODE_NEXT(prev));
+  SET_NODE_PREV(nd, prev);
+  SET_NODE_PREV(NODE_NEXT(prev), nd);
+  SET_NODE_NEXT(prev, nd);
+  SET_LIST_LEN(list, GET_LIST_LEN(list) + 1);
+}
+
+/**
+ * @brief 将节点从链表中断开，并减少链表长度。
+ * @param list 链表指针。
+ * @param nd 要断开的节点。
+ */
+static void list_unlink_node(pn_list *list, list_node *nd) {
+  SET_NODE_NEXT(NODE_PREV(nd), NODE_NEXT(nd));
+  SET_NODE_PREV(NODE_NEXT(nd), NODE_PREV(nd));
+  SET_LIST_LEN(list, GET_LIST_LEN(list) - 1);
+}
+
+/**
+ * @brief 从指定节点开始向后或向前移动若干步。
+ * @param nd 起始节点。
+ * @param steps 移动步数。
+ * @param forward 为 1 时沿 next 移动，否则沿 prev 移动。
+ * @return 返回移动后的节点。
+ */
+static list_node *list_walk_node(list_node *nd, uint32_t steps, int forward) {
+  if (forward) {
+    while (steps--)
+      nd = NODE_NEXT(nd);
+  } else {
+    while (steps--)
+      nd = NODE_PREV(nd);
+  }
+  return nd;
+}
+
+/**
+ * @brief 生成跳表索引节点的随机层高，每层晋升概率为 1/4。
+ * @param index 跳表索引指针。
+ * @return 返回层高，为 0 表示该链表节点不建立索引节点。
+ */
+static uint32_t list_index_random_level(list_skip_index *index) {
+  uint32_t x = index->seed;
+  uint32_t level = 0;
+
+  /* xorshift32 伪随机数 */
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  index->seed = x;
+
+  while (!(x & 3) && level < LIST_SKIP_MAX_LEVEL) {
+    level++;
+    x >>= 2;
+  }
+  return level;
+}
+
+/**
+ * @brief 申请一个跳表索引节点。
+ * @param allocator 内存分配器指针。
+ * @param nd 索引节点对应的链表节点。
+ * @param level 索引节点层高。
+ * @return 返回索引节点指针，失败返回 NULL。
+ */
+static list_skip_node *list_index_node_new(mem_allocator *allocator,
+                                           list_node *nd, uint32_t level) {
+  list_skip_node *x;
+  uint32_t i;
+
+  x = (list_skip_node *)mem_alloc(allocator, sizeof(list_skip_node) +
+                                                 sizeof(list_skip_level) *
+                                                     level);
+  if (!x)
+    return NULL;
+
+  x->nd = nd;
+  for (i = 0; i < level; i++) {
+    x->level[i].next = NULL;
+    x->level[i].span = 0;
+  }
+  return x;
+}
+
+/**
+ * @brief 在跳表索引中查找排名位于 rank 之前的节点。
+ *
+ * 排名从 1 开始，头哨兵排名为 0。update[i] 记录第 i 层中排名小于 rank 的
+ * 最后一个索引节点，ranks[i] 记录其排名。
+ *
+ * @param index 跳表索引指针。
+ * @param rank 目标排名。
+ * @param update 各层前驱索引节点，可为 NULL。
+ * @param ranks 各层前驱索引节点的排名，可为 NULL。
+ * @return 返回排名为 rank - 1 的链表节点。
+ */
+static list_node *list_index_locate(list_skip_index *index, uint32_t rank,
+                                    list_skip_node **update, uint32_t *ranks) {
+  list_skip_node *x = index->header;
+  uint32_t traversed = 0;
+  int i;
+
+  for (i = (int)index->level - 1; i >= 0; i--) {
+    while (x->level[i].next && traversed + x->level[i].span < rank) {
+      traversed += x->level[i].span;
+      x = x->level[i].next;
+    }
+    if (update) {
+      update[i] = x;
+      ranks[i] = traversed;
+    }
+  }
+
+  /* 索引节点之间的距离期望为常数，剩余部分沿链表前进 */
+  return list_walk_node(x->nd, rank - 1 - traversed, 1);
+}
+
+/**
+ * @brief 在开启索引的链表中将节点插入到指定索引处。
  * @param list 链表指针。
+ * @param idx 插入位置。
+ * @param nd 要插入的节点。
  */
-void list_free(pn_list *list) { LIST_FREE(list); }
+static void list_index_insert(pn_list *list, uint32_t idx, list_node *nd) {
+  list_skip_index *index = LIST_INDEX(list);
+  list_skip_node *update[LIST_SKIP_MAX_LEVEL];
+  uint32_t ranks[LIST_SKIP_MAX_LEVEL];
+  list_skip_node *x = NULL;
+  list_node *prev;
+  uint32_t rank = idx + 1;
+  uint32_t level;
+  uint32_t i;
+
+  prev = list_index_locate(index, rank, update, ranks);
+
+  level = list_index_random_level(index);
+  if (level) {
+    x = list_index_node_new(LIST_ALLOCATOR(list), nd, level);
+    /* 内存不足时退化为不建立索引节点，索引仍然正确 */
+    if (!x)
+      level = 0;
+  }
+
+  /* 新增的层以头节点为前驱，跨度为到尾哨兵的距离 */
+  for (i = index->level; i < level; i++) {
+    update[i] = index->header;
+    ranks[i] = 0;
+    index->header->level[i].next = NULL;
+    index->header->level[i].span = GET_LIST_LEN(list) + 1;
+  }
+  if (level > index->level)
+    index->level = level;
+
+  for (i = 0; i < level; i++) {
+    x->level[i].next = update[i]->level[i].next;
+    x->level[i].span = ranks[i] + update[i]->level[i].span + 1 - rank;
+    update[i]->level[i].next = x;
+    update[i]->level[i].span = rank - ranks[i];
+  }
+  for (; i < index->level; i++)
+    update[i]->level[i].span++;
+
+  list_link_node(list, prev, nd);
+}
+
+/**
+ * @brief 在开启索引的链表中断开指定索引处的节点。
+ * @param list 链表指针。
+ * @param idx 要断开的节点的索引。
+ * @return 返回被断开的节点。
+ */
+static list_node *list_index_unlink(pn_list *list, uint32_t idx) {
+  list_skip_index *index = LIST_INDEX(list);
+  list_skip_node *update[LIST_SKIP_MAX_LEVEL];
+  uint32_t ranks[LIST_SKIP_MAX_LEVEL];
+  list_skip_node *x = NULL;
+  list_skip_node *next;
+  list_node *nd;
+  uint32_t i;
+
+  nd = NODE_NEXT(list_index_locate(index, idx + 1, update, ranks));
+
+  for (i = 0; i < index->level; i++) {
+    next = update[i]->level[i].next;
+    if (next && next->nd == nd) {
+      update[i]->level[i].span += next->level[i].span - 1;
+      update[i]->level[i].next = next->level[i].next;
+      x = next;
+    } else {
+      update[i]->level[i].span--;
+    }
+  }
+  mem_free(LIST_ALLOCATOR(list), x);
+
+  while (index->level && !index->header->level[index->level - 1].next)
+    index->level--;
+
+  list_unlink_node(list, nd);
+  return nd;
+}
+
+/**
+ * @brief 为链表开启跳表索引，之后按索引读取、插入、删除均为 O(log n)。
+ * @param list 链表指针。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err。
+ */
+ret_val list_index_enable(pn_list *list) {
+  list_skip_node *last[LIST_SKIP_MAX_LEVEL];
+  uint32_t last_ranks[LIST_SKIP_MAX_LEVEL];
+  list_skip_index *index;
+  list_skip_node *x;
+  list_node *nd;
+  uint32_t rank = 0;
+  uint32_t level;
+  uint32_t i;
+
+  if (LIST_INDEX(list))
+    return ret_ok;
+
+  index = MEM_ALLOC_FUNC(LIST_ALLOCATOR(list), list_skip_index);
+  if (!index)
+    return ret_err;
+
+  index->level = 0;
+  index->seed = 0x9e3779b9;
+  index->header = list_index_node_new(LIST_ALLOCATOR(list), LIST_HEAD(list),
+                                      LIST_SKIP_MAX_LEVEL);
+  if (!index->header) {
+    mem_free(LIST_ALLOCATOR(list), index);
+    return ret_err;
+  }
+  LIST_INDEX(list) = index;
+
+  for (i = 0; i < LIST_SKIP_MAX_LEVEL; i++) {
+    last[i] = index->header;
+    last_ranks[i] = 0;
+  }
+
+  /* 顺序遍历链表，为抽中的节点建立索引节点 */
+  each_node_for_list(nd, list, next) {
+    rank++;
+    level = list_index_random_level(index);
+    if (!level)
+      continue;
+
+    x = list_index_node_new(LIST_ALLOCATOR(list), nd, level);
+    if (!x) {
+      list_index_disable(list);
+      return ret_err;
+    }
+
+    for (i = 0; i < level; i++) {
+      last[i]->level[i].next = x;
+      last[i]->level[i].span = rank - last_ranks[i];
+      last[i] = x;
+      last_ranks[i] = rank;
+    }
+    if (level > index->level)
+      index->level = level;
+  }
+
+  for (i = 0; i < LIST_SKIP_MAX_LEVEL; i++)
+    last[i]->level[i].span = GET_LIST_LEN(list) + 1 - last_ranks[i];
+
+  return ret_ok;
+}
+
+/**
+ * @brief 释放跳表索引的全部内存。
+ * @param allocator 内存分配器指针。
+ * @param index 跳表索引指针，可为 NULL。
+ */
+static void list_index_free(mem_allocator *allocator, list_skip_index *index) {
+  list_skip_node *x;
+  list_skip_node *tmp;
+
+  if (!index)
+    return;
+
+  /* 所有索引节点都位于第 0 层，沿第 0 层释放即可 */
+  x = index->header->level[0].next;
+  while (x) {
+    tmp = x->level[0].next;
+    mem_free(allocator, x);
+    x = tmp;
+  }
+  mem_free(allocator, index->header);
+  mem_free(allocator, index);
+}
+
+/**
+ * @brief 关闭链表的跳表索引并释放索引内存。
+ * @param list 链表指针。
+ */
+void list_index_disable(pn_list *list) {
+  list_index_free(LIST_ALLOCATOR(list), LIST_INDEX(list));
+  LIST_INDEX(list) = NULL;
+}
+
+/**
+ * @brief 为批量修改后的链表重建索引，成功后释放修改前摘下的旧索引。
+ *
+ * 调用者在修改前摘下两个链表的旧索引。重建失败时新建的索引被释放，旧索引
+ * 保持不变，调用者撤销修改后重新挂回即可。
+ *
+ * @param list 链表指针。
+ * @param old list 修改前的索引，为 NULL 时不重建。
+ * @param other 另一个链表指针，可为 NULL。
+ * @param other_old other 修改前的索引，为 NULL 时不重建。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err。
+ */
+static ret_val list_index_rebuild(pn_list *list, list_skip_index *old,
+                                  pn_list *other, list_skip_index *other_old) {
+  if (old && list_index_enable(list) != ret_ok)
+    return ret_err;
+  if (other_old && list_index_enable(other) != ret_ok) {
+    list_index_disable(list);
+    return ret_err;
+  }
+
+  list_index_free(LIST_ALLOCATOR(list), old);
+  if (other)
+    list_index_free(LIST_ALLOCATOR(other), other_old);
+  return ret_ok;
+}
+
+/**
+ * @brief 链表重新排列但长度不变时，将索引节点按排名重新指向链表节点。
+ *
+ * 索引的层高和跨度只与排名有关，重新指向后索引仍然正确，不需要申请内存。
+ *
+ * @param list 链表指针。
+ */
+static void list_index_repoint(pn_list *list) {
+  list_skip_node *x = LIST_INDEX(list)->header;
+  list_skip_node *next;
+  list_node *nd = LIST_HEAD(list);
+
+  while ((next = x->level[0].next)) {
+    nd = list_walk_node(nd, x->level[0].span, 1);
+    next->nd = nd;
+    x = next;
+  }
+}
+
+/**
+ * @brief 将 from 中 first 到 last 的连续节点移动到 to 中 prev 节点之后。
+ * @param from 源链表指针。
+ * @param first 第一个移动的节点。
+ * @param last 最后一个移动的节点。
+ * @param count 移动的节点数。
+ * @param to 目标链表指针。
+ * @param prev 插入位置的前一个节点。
+ */
+static void list_move_nodes(pn_list *from, list_node *first, list_node *last,
+                            uint32_t count, pn_list *to, list_node *prev) {
+  SET_NODE_NEXT(NODE_PREV(first), NODE_NEXT(last));
+  SET_NODE_PREV(NODE_NEXT(last), NODE_PREV(first));
+  SET_LIST_LEN(from, GET_LIST_LEN(from) - count);
+
+  SET_NODE_PREV(first, prev);
+  SET_NODE_NEXT(last, NODE_NEXT(prev));
+  SET_NODE_PREV(NODE_NEXT(prev), last);
+  SET_NODE_NEXT(prev, first);
+  SET_LIST_LEN(to, GET_LIST_LEN(to) + count);
+}
 
 /**
  * @brief 将节点插入链表头部。
@@ -31,12 +730,11 @@ void list_free(pn_list *list) { LIST_FREE(list); }
  * @param nd 要插入的节点。
  */
 void list_push_node_to_head(pn_list *list, list_node *nd) {
-  /* 更新节点的前后关系，增加链表长度 */
-  SET_NODE_NEXT(nd, NODE_NEXT(LIST_HEAD(list)));
-  SET_NODE_PREV(nd, LIST_HEAD(list));
-  SET_NODE_PREV(NODE_NEXT(LIST_HEAD(list)), nd);
-  SET_NODE_NEXT(LIST_HEAD(list), nd);
-  SET_LIST_LEN(list, GET_LIST_LEN(list) + 1);
+  if (LIST_INDEX(list)) {
+    list_index_insert(list, 0, nd);
+    return;
+  }
+  list_link_node(list, LIST_HEAD(list), nd);
 }
 
 /**
@@ -45,12 +743,11 @@ void list_push_node_to_head(pn_list *list, list_node *nd) {
  * @param nd 要插入的节点。
  */
 void list_push_node_to_tail(pn_list *list, list_node *nd) {
-  /* 更新节点的前后关系，增加链表长度 */
-  SET_NODE_NEXT(nd, LIST_TAIL(list));
-  SET_NODE_PREV(nd, NODE_PREV(LIST_TAIL(list)));
-  SET_NODE_NEXT(NODE_PREV(LIST_TAIL(list)), nd);
-  SET_NODE_PREV(LIST_TAIL(list), nd);
-  SET_LIST_LEN(list, GET_LIST_LEN(list) + 1);
+  if (LIST_INDEX(list)) {
+    list_index_insert(list, GET_LIST_LEN(list), nd);
+    return;
+  }
+  list_link_node(list, NODE_PREV(LIST_TAIL(list)), nd);
 }
 
 /**
@@ -60,7 +757,9 @@ void list_push_node_to_tail(pn_list *list, list_node *nd) {
  */
 void list_push_to_head(pn_list *list, void *val) {
   /* 创建节点，将值保存在节点中，然后调用 list_push_node_to_head() */
-  list_node *nd = MALLOC_FUNC(list_node);
+  list_node *nd = list_node_alloc(list);
+  if (!nd)
+    return;
   nd->val = (void *)val;
   list_push_node_to_head(list, nd);
 }
@@ -72,29 +771,441 @@ void list_push_to_head(pn_list *list, void *val) {
  */
 void list_push_to_tail(pn_list *list, void *val) {
   /* 创建节点，将值保存在节点中，然后调用 list_push_node_to_tail() */
-  list_node *nd = MALLOC_FUNC(list_node);
+  list_node *nd = list_node_alloc(list);
+  if (!nd)
+    return;
   nd->val = (void *)val;
   list_push_node_to_tail(list, nd);
 }
 
 /**
- * @brief 从索引获取节点。
+ * @brief 将数组中的值依次插入链表尾部，只链接一次并更新一次长度。
  * @param list 链表指针。
- * @param idx 要获取的节点的索引。
- * @return 返回指向节点的指针，如果索引无效返回 NULL。
+ * @param vals 值数组。
+ * @param n 值的数量。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err 且链表不变。
  */
-void *list_get_node_from_index(pn_list *list, uint32_t idx) {
+ret_val list_push_array_to_tail(pn_list *list, void **vals, uint32_t n) {
+  list_node *block = NULL;
+  list_node *first = NULL;
+  list_node *last = NULL;
   list_node *nd;
-  uint32_t index = 0;
-  /* 遍历链表，找到对应索引的节点 */
-  each_node_for_linked(nd, LIST_HEAD_NODE(list), next) {
-    if (index == idx)
-      return nd;
-    index++;
+  uint32_t i;
+  list_skip_index *index = LIST_INDEX(list);
+
+  if (!n)
+    return ret_ok;
+
+  if (LIST_SLAB(list)) {
+    block = list_slab_alloc_bulk(LIST_SLAB(list), n);
+    if (!block)
+      return ret_err;
+  }
+
+  /* 先在链表外串好全部节点 */
+  for (i = 0; i < n; i++) {
+    nd = block ? &block[i] : list_node_alloc(list);
+    if (!nd)
+      goto err_alloc;
+
+    nd->val = vals[i];
+    SET_NODE_PREV(nd, last);
+    if (last) {
+      SET_NODE_NEXT(last, nd);
+    } else {
+      first = nd;
+    }
+    last = nd;
+  }
+
+  /* 一次性挂到尾哨兵之前 */
+  LIST_INDEX(list) = NULL;
+  SET_NODE_PREV(first, NODE_PREV(LIST_TAIL(list)));
+  SET_NODE_NEXT(NODE_PREV(LIST_TAIL(list)), first);
+  SET_NODE_NEXT(last, LIST_TAIL(list));
+  SET_NODE_PREV(LIST_TAIL(list), last);
+  SET_LIST_LEN(list, GET_LIST_LEN(list) + n);
+  if (list_index_rebuild(list, index, NULL, NULL) == ret_ok)
+    return ret_ok;
+
+  /* 重建索引失败，摘下新节点并恢复旧索引 */
+  SET_NODE_NEXT(NODE_PREV(first), LIST_TAIL(list));
+  SET_NODE_PREV(LIST_TAIL(list), NODE_PREV(first));
+  SET_NODE_PREV(first, NULL);
+  SET_LIST_LEN(list, GET_LIST_LEN(list) - n);
+  LIST_INDEX(list) = index;
+
+err_alloc:
+  while (last) {
+    nd = NODE_PREV(last);
+    list_node_release(list, last);
+    last = nd;
+  }
+  return ret_err;
+}
+
+/**
+ * @brief 将 other 的全部节点移动到 list 中 prev 节点之后，other 变为空链表。
+ * @param list 目标链表指针。
+ * @param prev 插入位置的前一个节点，可为 LIST_HEAD(list)。
+ * @param other 源链表指针。
+ * @return 成功返回 ret_ok，两个链表相同、节点分配器不同或重建索引时内存不足
+ * 返回 ret_err，此时两个链表不变。
+ */
+ret_val list_splice(pn_list *list, list_node *prev, pn_list *other) {
+  list_node *first;
+  list_node *last;
+  uint32_t count = GET_LIST_LEN(other);
+  list_skip_index *index = LIST_INDEX(list);
+  list_skip_index *other_index = LIST_INDEX(other);
+
+  if (list == other || LIST_SLAB(list) != LIST_SLAB(other) ||
+      LIST_ALLOCATOR(list) != LIST_ALLOCATOR(other))
+    return ret_err;
+  if (!count)
+    return ret_ok;
+
+  first = LIST_HEAD_NODE(other);
+  last = LIST_TAIL_NODE(other);
+
+  /* 将 other 的节点整段挂到 prev 之后，other 的哨兵重新首尾相连 */
+  LIST_INDEX(list) = NULL;
+  LIST_INDEX(other) = NULL;
+  list_move_nodes(other, first, last, count, list, prev);
+  if (list_index_rebuild(list, index, other, other_index) == ret_ok)
+    return ret_ok;
+
+  /* 重建索引失败，将节点移回 other 并恢复旧索引 */
+  list_move_nodes(list, first, last, count, other, LIST_HEAD(other));
+  LIST_INDEX(list) = index;
+  LIST_INDEX(other) = other_index;
+  return ret_err;
+}
+
+/**
+ * @brief 将 other 的全部节点移动到 list 尾部，other 变为空链表。
+ * @param list 目标链表指针。
+ * @param other 源链表指针。
+ * @return 成功返回 ret_ok，两个链表相同、节点分配器不同或重建索引时内存不足
+ * 返回 ret_err，此时两个链表不变。
+ */
+ret_val list_concat(pn_list *list, pn_list *other) {
+  return list_splice(list, NODE_PREV(LIST_TAIL(list)), other);
+}
+
+/**
+ * @brief 从 nd 处切分链表，将 nd 及其之后的节点移动到 dst 尾部。
+ * @param list 源链表指针。
+ * @param nd 切分位置，属于 list 的数据节点。
+ * @param dst 目标链表指针，需与 list 使用同一节点分配器。
+ * @return 成功返回 ret_ok，两个链表相同、节点分配器不同或重建索引时内存不足
+ * 返回 ret_err，此时两个链表不变。
+ */
+ret_val list_cut(pn_list *list, list_node *nd, pn_list *dst) {
+  list_node *last = LIST_TAIL_NODE(list);
+  list_node *prev = NODE_PREV(nd);
+  list_node *tmp;
+  uint32_t count = 0;
+  list_skip_index *index = LIST_INDEX(list);
+  list_skip_index *dst_index = LIST_INDEX(dst);
+
+  if (list == dst || LIST_SLAB(list) != LIST_SLAB(dst) ||
+      LIST_ALLOCATOR(list) != LIST_ALLOCATOR(dst))
+    return ret_err;
+
+  each_node_for_linked(tmp, nd, next) {
+    if (tmp == LIST_TAIL(list))
+      break;
+    count++;
+  }
+
+  /* 源链表在 nd 之前截断，nd 到 last 整段挂到 dst 尾部 */
+  LIST_INDEX(list) = NULL;
+  LIST_INDEX(dst) = NULL;
+  list_move_nodes(list, nd, last, count, dst, NODE_PREV(LIST_TAIL(dst)));
+  if (list_index_rebuild(list, index, dst, dst_index) == ret_ok)
+    return ret_ok;
+
+  /* 重建索引失败，将节点移回 list 并恢复旧索引 */
+  list_move_nodes(dst, nd, last, count, list, prev);
+  LIST_INDEX(list) = index;
+  LIST_INDEX(dst) = dst_index;
+  return ret_err;
+}
+
+/**
+ * @brief 稳定归并两个以 NULL 结尾的单向链表，a 中的节点原本位于 b 之前。
+ * @param a 前一段有序链表。
+ * @param b 后一段有序链表。
+ * @param cmp 值比较函数。
+ * @return 返回归并后的链表。
+ */
+static list_node *list_sort_merge(list_node *a, list_node *b,
+                                  list_cmp_func cmp) {
+  list_node head;
+  list_node *tail = &head;
+
+  while (a && b) {
+    /* 相等时优先取 a，保证稳定 */
+    if (cmp(NODE_VAL(a), NODE_VAL(b)) <= 0) {
+      SET_NODE_NEXT(tail, a);
+      a = NODE_NEXT(a);
+    } else {
+      SET_NODE_NEXT(tail, b);
+      b = NODE_NEXT(b);
+    }
+    tail = NODE_NEXT(tail);
+  }
+  SET_NODE_NEXT(tail, a ? a : b);
+  return head.next;
+}
+
+/**
+ * @brief 自底向上归并排序以 NULL 结尾的单向链表。
+ *
+ * bins[i] 保存长度为 2^i 的有序段，序号越大的段包含越靠前的节点。
+ *
+ * @param nd 链表首节点。
+ * @param cmp 值比较函数。
+ * @return 返回排序后的链表。
+ */
+static list_node *list_sort_chain(list_node *nd, list_cmp_func cmp) {
+  list_node *bins[33] = {NULL};
+  list_node *carry;
+  list_node *next;
+  uint32_t i;
+
+  while (nd) {
+    next = NODE_NEXT(nd);
+    SET_NODE_NEXT(nd, NULL);
+    carry = nd;
+    for (i = 0; bins[i]; i++) {
+      carry = list_sort_merge(bins[i], carry, cmp);
+      bins[i] = NULL;
+    }
+    bins[i] = carry;
+    nd = next;
+  }
+
+  carry = NULL;
+  for (i = 0; i < ARRAY_LEN(bins); i++) {
+    if (bins[i])
+      carry = list_sort_merge(bins[i], carry, cmp);
   }
+  return carry;
+}
+
+/**
+ * @brief 并行排序线程入口。
+ * @param arg 排序任务指针。
+ * @return 返回 NULL。
+ */
+static void *list_sort_worker(void *arg) {
+  list_sort_task *task = (list_sort_task *)arg;
+  task->chain = list_sort_chain(task->chain, task->cmp);
   return NULL;
 }
 
+/**
+ * @brief 将排序后的单向链表重新挂回哨兵之间，并修复 prev 指针。
+ * @param list 链表指针。
+ * @param chain 排序后的链表。
+ */
+static void list_sort_relink(pn_list *list, list_node *chain) {
+  list_node *prev = LIST_HEAD(list);
+  list_node *nd;
+
+  each_node_for_linked(nd, chain, next) {
+    SET_NODE_PREV(nd, prev);
+    SET_NODE_NEXT(prev, nd);
+    prev = nd;
+  }
+  SET_NODE_NEXT(prev, LIST_TAIL(list));
+  SET_NODE_PREV(LIST_TAIL(list), prev);
+}
+
+/**
+ * @brief 对链表进行原地稳定归并排序，只修改节点链接，不申请内存。
+ * @param list 链表指针。
+ * @param cmp 值比较函数。
+ */
+void list_sort(pn_list *list, list_cmp_func cmp) {
+  list_sort_parallel(list, cmp, 1);
+}
+
+/**
+ * @brief 多线程原地稳定归并排序，各线程排序一段子链表后再归并。
+ * @param list 链表指针。
+ * @param cmp 值比较函数，需可被多个线程同时调用。
+ * @param threads 线程数，最多 LIST_SORT_MAX_THREADS，为 0 或 1 时单线程排序。
+ */
+void list_sort_parallel(pn_list *list, list_cmp_func cmp, uint32_t threads) {
+  list_sort_task tasks[LIST_SORT_MAX_THREADS];
+  pthread_t tids[LIST_SORT_MAX_THREADS];
+  int started[LIST_SORT_MAX_THREADS];
+  uint32_t len = GET_LIST_LEN(list);
+  uint32_t per;
+  uint32_t i;
+  uint32_t j;
+  list_node *nd;
+  list_node *chain;
+
+  if (len < 2)
+    return;
+
+  if (threads > LIST_SORT_MAX_THREADS)
+    threads = LIST_SORT_MAX_THREADS;
+  if (threads > len)
+    threads = len;
+  if (!threads)
+    threads = 1;
+
+  /* 断开哨兵，按线程数切分为若干段以 NULL 结尾的子链表 */
+  SET_NODE_NEXT(LIST_TAIL_NODE(list), NULL);
+  nd = LIST_HEAD_NODE(list);
+  per = len / threads;
+  for (i = 0; i < threads; i++) {
+    tasks[i].chain = nd;
+    tasks[i].cmp = cmp;
+    if (i == threads - 1)
+      break;
+    for (j = 1; j < per; j++)
+      nd = NODE_NEXT(nd);
+    chain = NODE_NEXT(nd);
+    SET_NODE_NEXT(nd, NULL);
+    nd = chain;
+  }
+
+  /* 第 0 段由当前线程排序，创建线程失败时同样退化为当前线程排序 */
+  for (i = 1; i < threads; i++)
+    started[i] = !pthread_create(&tids[i], NULL, list_sort_worker, &tasks[i]);
+  list_sort_worker(&tasks[0]);
+  for (i = 1; i < threads; i++) {
+    if (started[i])
+      pthread_join(tids[i], NULL);
+    else
+      list_sort_worker(&tasks[i]);
+  }
+
+  /* 相邻段两两归并，前一段始终作为 a 以保证稳定 */
+  for (per = 1; per < threads; per *= 2) {
+    for (i = 0; i + per < threads; i += 2 * per)
+      tasks[i].chain =
+          list_sort_merge(tasks[i].chain, tasks[i + per].chain, cmp);
+  }
+
+  list_sort_relink(list, tasks[0].chain);
+  if (LIST_INDEX(list))
+    list_index_repoint(list);
+}
+
+/**
+ * @brief 将指定索引处的节点从链表中摘除，并回收节点。
+ * @param list 链表指针。
+ * @param idx 要摘除的节点的索引，调用者保证有效。
+ * @return 返回节点中的值。
+ */
+static void *list_take_index(pn_list *list, uint32_t idx) {
+  list_node *nd;
+  void *val;
+
+  if (LIST_INDEX(list)) {
+    nd = list_index_unlink(list, idx);
+  } else {
+    nd = list_get_node_from_index(list, idx);
+    list_unlink_node(list, nd);
+  }
+
+  val = NODE_VAL(nd);
+  list_node_release(list, nd);
+  return val;
+}
+
+/**
+ * @brief 从链表头部弹出值，并回收节点。
+ * @param list 链表指针。
+ * @return 返回头部节点的值，链表为空返回 NULL。
+ */
+void *list_pop_from_head(pn_list *list) {
+  if (!GET_LIST_LEN(list))
+    return NULL;
+  return list_take_index(list, 0);
+}
+
+/**
+ * @brief 从链表尾部弹出值，并回收节点。
+ * @param list 链表指针。
+ * @return 返回尾部节点的值，链表为空返回 NULL。
+ */
+void *list_pop_from_tail(pn_list *list) {
+  if (!GET_LIST_LEN(list))
+    return NULL;
+  return list_take_index(list, GET_LIST_LEN(list) - 1);
+}
+
+/**
+ * @brief 在指定索引处插入值，原索引及之后的节点后移。
+ * @param list 链表指针。
+ * @param idx 插入位置，取值范围为 [0, len]。
+ * @param val 要插入的值。
+ * @return 成功返回 ret_ok，索引无效或内存不足返回 ret_err。
+ */
+ret_val list_insert_to_index(pn_list *list, uint32_t idx, void *val) {
+  list_node *next;
+  list_node *nd;
+
+  if (idx > GET_LIST_LEN(list))
+    return ret_err;
+
+  nd = list_node_alloc(list);
+  if (!nd)
+    return ret_err;
+  nd->val = val;
+
+  if (LIST_INDEX(list)) {
+    list_index_insert(list, idx, nd);
+    return ret_ok;
+  }
+
+  next = idx == GET_LIST_LEN(list) ? LIST_TAIL(list)
+                                   : list_get_node_from_index(list, idx);
+  list_link_node(list, NODE_PREV(next), nd);
+  return ret_ok;
+}
+
+/**
+ * @brief 删除指定索引处的节点，并回收节点。
+ * @param list 链表指针。
+ * @param idx 要删除的节点的索引。
+ * @return 返回被删除节点的值，如果索引无效返回 NULL。
+ */
+void *list_remove_from_index(pn_list *list, uint32_t idx) {
+  if (idx >= GET_LIST_LEN(list))
+    return NULL;
+  return list_take_index(list, idx);
+}
+
+/**
+ * @brief 从索引获取节点，未开启索引时从距离较近的一端开始遍历。
+ * @param list 链表指针。
+ * @param idx 要获取的节点的索引。
+ * @return 返回指向节点的指针，如果索引无效返回 NULL。
+ */
+void *list_get_node_from_index(pn_list *list, uint32_t idx) {
+  uint32_t len = GET_LIST_LEN(list);
+
+  if (idx >= len)
+    return NULL;
+
+  if (LIST_INDEX(list))
+    return NODE_NEXT(list_index_locate(LIST_INDEX(list), idx + 1, NULL, NULL));
+
+  /* 索引位于后半段时从尾部向前遍历 */
+  if (idx < len / 2)
+    return list_walk_node(LIST_HEAD_NODE(list), idx, 1);
+  return list_walk_node(LIST_TAIL_NODE(list), len - 1 - idx, 0);
+}
+
 /**
  * @brief 从索引获取值。
  * @param list 链表指针。
@@ -0,0 +1,221 @@
+/**
+ * @file mpsc_queue.c
+ * @brief 无锁多生产者单消费者队列实现文件。
+ * @author moecly
+ */
+
+#include "../inc/mpsc_queue.h"
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief 将节点链接到生产者端，不处理唤醒。
+ * @param q 队列指针。
+ * @param nd 要入队的节点。
+ */
+static void mpsc_queue_link(mpsc_queue *q, list_node *nd) {
+  list_node *prev;
+
+  __atomic_store_n(&nd->next, NULL, __ATOMIC_RELAXED);
+  prev = __atomic_exchange_n(&q->head, nd, __ATOMIC_SEQ_CST);
+  /* 在此之前消费者看不到 nd，出队会暂时返回 NULL */
+  __atomic_store_n(&prev->next, nd, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 初始化队列。
+ * @param q 队列指针。
+ * @param use_eventfd 为非 0 时创建 eventfd 以支持 mpsc_queue_wait()。
+ * @return 成功返回 ret_ok，创建 eventfd 失败返回 ret_err。
+ */
+ret_val mpsc_queue_init(mpsc_queue *q, int use_eventfd) {
+  q->stub.prev = NULL;
+  q->stub.next = NULL;
+  q->stub.val = NULL;
+  q->head = &q->stub;
+  q->tail = &q->stub;
+  q->sleeping = 0;
+  q->efd = -1;
+
+  if (!use_eventfd)
+    return ret_ok;
+
+  q->efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (q->efd == -1)
+    return ret_err;
+  return ret_ok;
+}
+
+/**
+ * @brief 销毁队列，队列中剩余节点由调用者处理。
+ * @param q 队列指针。
+ */
+void mpsc_queue_destroy(mpsc_queue *q) {
+  if (q->efd != -1)
+    close(q->efd);
+  q->efd = -1;
+}
+
+/**
+ * @brief 节点入队，可被多个线程同时调用。
+ * @param q 队列指针。
+ * @param nd 要入队的节点。
+ */
+void mpsc_queue_push(mpsc_queue *q, list_node *nd) {
+  uint64_t one = 1;
+
+  mpsc_queue_link(q, nd);
+
+  /* 消费者正在休眠时由抢到标记的生产者负责唤醒 */
+  if (q->efd != -1 && __atomic_load_n(&q->sleeping, __ATOMIC_SEQ_CST) &&
+      __atomic_exchange_n(&q->sleeping, 0, __ATOMIC_SEQ_CST)) {
+    if (write(q->efd, &one, sizeof(one)) != sizeof(one))
+      return;
+  }
+}
+
+/**
+ * @brief 节点出队，只能由消费者线程调用。
+ * @param q 队列指针。
+ * @return 返回出队节点，队列为空或生产者尚未完成入队返回 NULL。
+ */
+list_node *mpsc_queue_pop(mpsc_queue *q) {
+  list_node *tail = q->tail;
+  list_node *next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+
+  /* 跳过哨兵节点 */
+  if (tail == &q->stub) {
+    if (!next)
+      return NULL;
+    q->tail = next;
+    tail = next;
+    next = __atomic_load_n(&next->next, __ATOMIC_ACQUIRE);
+  }
+
+  if (next) {
+    q->tail = next;
+    return tail;
+  }
+
+  /* tail 不是最新入队节点，说明有生产者正在链接 */
+  if (tail != __atomic_load_n(&q->head, __ATOMIC_ACQUIRE))
+    return NULL;
+
+  /* 只剩最后一个节点，重新插入哨兵后才能将其取出 */
+  mpsc_queue_link(q, &q->stub);
+  next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+  if (next) {
+    q->tail = next;
+    return tail;
+  }
+  return NULL;
+}
+
+/**
+ * @brief 批量出队，只能由消费者线程调用。
+ * @param q 队列指针。
+ * @param nds 保存出队节点的数组。
+ * @param max 数组容量。
+ * @return 返回出队节点数。
+ */
+uint32_t mpsc_queue_pop_batch(mpsc_queue *q, list_node **nds, uint32_t max) {
+  uint32_t count = 0;
+  list_node *nd;
+
+  while (count < max) {
+    nd = mpsc_queue_pop(q);
+    if (!nd)
+      break;
+    nds[count++] = nd;
+  }
+  return count;
+}
+
+/**
+ * @brief 判断队列是否为空，只能由消费者线程调用。
+ * @param q 队列指针。
+ * @return 队列为空返回 1，否则返回 0。
+ */
+int mpsc_queue_empty(mpsc_queue *q) {
+  return q->tail == &q->stub &&
+         !__atomic_load_n(&q->stub.next, __ATOMIC_ACQUIRE) &&
+         __atomic_load_n(&q->head, __ATOMIC_SEQ_CST) == &q->stub;
+}
+
+/**
+ * @brief 获取单调时钟的毫秒数。
+ * @return 返回毫秒数。
+ */
+static int64_t mpsc_queue_now_ms(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief 读空 eventfd 中残留的唤醒计数。
+ * @param q 队列指针。
+ */
+static void mpsc_queue_drain(mpsc_queue *q) {
+  uint64_t val;
+  ssize_t n;
+
+  /* eventfd 为非阻塞模式，没有计数时读取失败，忽略即可 */
+  n = read(q->efd, &val, sizeof(val));
+  (void)n;
+}
+
+/**
+ * @brief 队列为空时通过 eventfd 休眠等待生产者唤醒。
+ *
+ * 唤醒计数可能来自已被取走的节点，醒来后队列仍为空时继续等待剩余时间。
+ *
+ * @param q 队列指针。
+ * @param timeout_ms 超时时间（毫秒），为 -1 时一直等待。
+ * @return 队列非空返回 ret_ok，超时或未启用 eventfd 返回 ret_err。
+ */
+ret_val mpsc_queue_wait(mpsc_queue *q, int timeout_ms) {
+  int64_t deadline = 0;
+  int64_t left;
+  struct pollfd pfd;
+  int wait_ms = timeout_ms;
+  int ret;
+
+  if (q->efd == -1)
+    return ret_err;
+  if (timeout_ms > 0)
+    deadline = mpsc_queue_now_ms() + timeout_ms;
+
+  pfd.fd = q->efd;
+  pfd.events = POLLIN;
+  for (;;) {
+    /* 先设置休眠标记再检查队列，保证不会错过生产者的唤醒 */
+    __atomic_store_n(&q->sleeping, 1, __ATOMIC_SEQ_CST);
+    if (!mpsc_queue_empty(q)) {
+      /* 标记已被生产者清除时其已写入或即将写入 eventfd，读掉避免下次误醒 */
+      if (!__atomic_exchange_n(&q->sleeping, 0, __ATOMIC_SEQ_CST))
+        mpsc_queue_drain(q);
+      return ret_ok;
+    }
+
+    ret = poll(&pfd, 1, wait_ms);
+    __atomic_store_n(&q->sleeping, 0, __ATOMIC_RELAXED);
+    if (ret < 0 && errno != EINTR)
+      return ret_err;
+    if (ret > 0)
+      mpsc_queue_drain(q);
+    if (!mpsc_queue_empty(q))
+      return ret_ok;
+
+    if (timeout_ms >= 0) {
+      left = timeout_ms ? deadline - mpsc_queue_now_ms() : 0;
+      if (left <= 0)
+        return ret_err;
+      wait_ms = (int)left;
+    }
+  }
+}
@@ -5,6 +5,16 @@
  */
 
 #include "../inc/log_msg.h"
+#include "../../common/inc/metrics.h"
+
+/* 定义一个宏，用于统计被日志级别过滤的日志行数 */
+#define LOG_COUNT_DROPPED()                                                    \
+  METRICS_COUNT("c_utils_log_lines_dropped_total",                             \
+                "Log lines discarded by the level filter.", 1)
+
+/* 定义一个宏，用于统计已输出的日志行数 */
+#define LOG_COUNT_WRITTEN()                                                    \
+  METRICS_COUNT("c_utils_log_lines_total", "Log lines written.", 1)
 
 /* 默认日志输出级别为 DEBUG */
 static LOG_LEVEL level = LOG_ERROR;
@@ -17,11 +27,14 @@ static LOG_LEVEL level = LOG_ERROR;
  */
 void log_msg(LOG_LEVEL lv, const char *format, ...) {
   /* 如果日志级别高于设定的输出级别，直接返回 */
-  if (lv > level)
+  if (lv > level) {
+    LOG_COUNT_DROPPED();
     return;
+  }
 
   /* 使用可变参数列表打印日志消息 */
   PRINT_LOG(format);
+  LOG_COUNT_WRITTEN();
 }
 
 /**
@@ -31,11 +44,14 @@ void log_msg(LOG_LEVEL lv, const char *format, ...) {
  */
 void dlog(const char *format, ...) {
   /* 如果日志级别低于 DEBUG，直接返回 */
-  if (level < LOG_DEBUG)
+  if (level < LOG_DEBUG) {
+    LOG_COUNT_DROPPED();
     return;
+  }
 
   /* 使用可变参数列表打印 DEBUG 级别日志消息 */
   PRINT_LOG(format);
+  LOG_COUNT_WRITTEN();
 }
 
 /**
@@ -45,11 +61,14 @@ void dlog(const char *format, ...) {
  */
 void elog(const char *format, ...) {
   /* 如果日志级别低于 ERROR，直接返回 */
-  if (level < LOG_ERROR)
+  if (level < LOG_ERROR) {
+    LOG_COUNT_DROPPED();
     return;
+  }
 
   /* 使用可变参数列表打印 ERROR 级别日志消息 */
   PRINT_LOG(format);
+  LOG_COUNT_WRITTEN();
 }
 
 /**
@@ -59,11 +78,14 @@ void elog(const char *format, ...) {
  */
 void wlog(const char *format, ...) {
   /* 如果日志级别低于 WARNING，直接返回 */
-  if (level < LOG_WARNING)
+  if (level < LOG_WARNING) {
+    LOG_COUNT_DROPPED();
     return;
+  }
 
   /* 使用可变参数列表打印 WARNING 级别日志消息 */
   PRINT_LOG(format);
+  LOG_COUNT_WRITTEN();
 }
 
 /**
@@ -73,9 +95,12 @@ void wlog(const char *format, ...) {
  */
 void ilog(const char *format, ...) {
   /* 如果日志级别低于 INFO，直接返回 */
-  if (level < LOG_INFO)
+  if (level < LOG_INFO) {
+    LOG_COUNT_DROPPED();
     return;
+  }
 
   /* 使用可变参数列表打印 INFO 级别日志消息 */
   PRINT_LOG(format);
+  LOG_COUNT_WRITTEN();
 }
@@ -8,6 +8,7 @@
 #define __PROCESS_OPERATOR_H_
 
 #include "../../common/inc/common.h"
+#include "../../common/inc/obj_pool.h"
 
 #define LINUX_OS
 #ifdef LINUX_OS
@@ -54,6 +55,14 @@ typedef struct process_operations {
  */
 ret_val process_ops_init(void);
 
+/**
+ * @brief 使用指定内存分配器初始化进程操作
+ *
+ * @param allocator 内存分配器指针，为 NULL 时使用默认分配器
+ * @return 初始化结果
+ */
+ret_val process_ops_init_with_allocator(mem_allocator *allocator);
+
 /**
  * @brief 重置进程操作
  *
@@ -132,4 +141,12 @@ int process_get_pid(process_info *info);
  */
 process_info create_process_info(void);
 
+/**
+ * @brief 进程信息对象池
+ *
+ * process_info_pool_get() 返回与 create_process_info() 相同初始状态的进程
+ * 信息，内存不足返回 NULL；process_info_pool_put() 将其归还到对象池。
+ */
+DECLARE_POOL(process_info)
+
 #endif // !__PROCESS_OPERATOR_H_
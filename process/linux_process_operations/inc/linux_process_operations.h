@@ -13,8 +13,10 @@
  * @brief 初始化Linux进程操作
  *
  * @param ops 用于存储Linux进程操作函数指针的结构体指针
+ * @param allocator 内存分配器指针，为 NULL 时使用默认分配器
  * @return 初始化结果
  */
-ret_val linux_process_ops_init(process_operations **ops);
+ret_val linux_process_ops_init(process_operations **ops,
+                               mem_allocator *allocator);
 
 #endif // !__LINUX_PROCESS_OPERATIONS_
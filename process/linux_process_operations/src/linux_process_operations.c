@@ -109,14 +109,16 @@ static ret_val process_wait_unblock_handler(process_info *info, int *status) {
  * @brief 初始化Linux进程操作
  *
  * @param ops 用于存储Linux进程操作函数指针的结构体指针
+ * @param allocator 内存分配器指针，为 NULL 时使用默认分配器
  * @return 初始化结果
  */
-ret_val linux_process_ops_init(process_operations **ops) {
+ret_val linux_process_ops_init(process_operations **ops,
+                               mem_allocator *allocator) {
   ret_val ret = ret_err;
   if (*ops != NULL)
     return ret_ok;
 
-  *ops = MALLOC_FUNC(process_operations);
+  *ops = MEM_ALLOC_FUNC(allocator, process_operations);
   ret = validate_pointer(*ops);
   if (ret != ret_ok)
     return ret;
@@ -6,12 +6,29 @@
 
 #include "../inc/process_operations.h"
 #include "c-utils/common/inc/common.h"
+#include "c-utils/common/inc/metrics.h"
 #include "c-utils/log_msg/inc/log_msg.h"
 #include "stdlib.h"
 #include <sys/wait.h>
 #include <unistd.h>
 
 static process_operations *ops = NULL;
+static mem_allocator *ops_allocator = NULL;
+
+/**
+ * @brief 重置从对象池取出的进程信息
+ *
+ * @param obj 进程信息结构体指针
+ */
+static void process_info_pool_ctor(void *obj) {
+  process_info *info = (process_info *)obj;
+
+  info->pid = 0;
+  info->args = NULL;
+  info->status = process_status_stop;
+}
+
+DEFINE_POOL_WITH_HOOKS(process_info, process_info_pool_ctor, NULL)
 
 /**
  * @brief 设置进程的命令行参数
@@ -27,7 +44,13 @@ void set_process_exec(process_info *info, char *args[]) { info->args = args; }
  * @param info 进程信息结构体指针
  * @return 启动结果
  */
-ret_val process_start(process_info *info) { return ops->start(info); }
+ret_val process_start(process_info *info) {
+  ret_val ret = ops->start(info);
+
+  if (ret == ret_ok)
+    METRICS_COUNT("c_utils_processes_spawned_total", "Processes started.", 1);
+  return ret;
+}
 
 /**
  * @brief 暂停进程
@@ -105,7 +128,15 @@ process_info create_process_info(void) {
  *
  * @return 初始化结果
  */
-ret_val process_ops_init(void) {
+ret_val process_ops_init(void) { return process_ops_init_with_allocator(NULL); }
+
+/**
+ * @brief 使用指定内存分配器初始化进程操作
+ *
+ * @param allocator 内存分配器指针，为 NULL 时使用默认分配器
+ * @return 初始化结果
+ */
+ret_val process_ops_init_with_allocator(mem_allocator *allocator) {
   ret_val ret;
 
   ret = validate_pointer(ops);
@@ -113,10 +144,13 @@ ret_val process_ops_init(void) {
     return ret;
 
 #ifdef LINUX_OS
-  extern ret_val linux_process_ops_init(process_operations * *ops);
-  ret = linux_process_ops_init(&ops);
+  extern ret_val linux_process_ops_init(process_operations * *ops,
+                                        mem_allocator * allocator);
+  ret = linux_process_ops_init(&ops, allocator);
 #endif
 
+  if (ret == ret_ok)
+    ops_allocator = allocator;
   return ret;
 }
 
@@ -128,7 +162,10 @@ ret_val process_ops_init(void) {
 ret_val process_ops_reset(void) {
   ret_val ret;
   ret = validate_pointer(ops);
-  if (ret == ret_ok)
-    FREE_FUNC(ops);
+  if (ret == ret_ok) {
+    mem_free(ops_allocator, ops);
+    ops = NULL;
+    ops_allocator = NULL;
+  }
   return ret;
 }
@@ -0,0 +1,119 @@
+/**
+ * @brief: 单生产者单消费者环形缓冲区头文件，容量固定为 2 的幂
+ * @file: ring_buffer.h
+ * @author: moecly
+ */
+
+#ifndef __RING_BUFFER_H_
+#define __RING_BUFFER_H_
+
+#include "../../common/inc/common.h"
+#include "../../common/inc/mem_pages.h"
+#include <stdint.h>
+
+/**
+ * @brief: 环形缓冲区初始化标志
+ */
+typedef enum {
+  ring_buffer_flag_none = 0,          /* 使用普通堆内存 */
+  ring_buffer_flag_huge_page = 1 << 0 /* 优先使用大页，失败时退化为透明大页 */
+} ring_buffer_flag;
+
+/**
+ * @brief: 环形缓冲区结构定义
+ *
+ * 读写下标只增不减，通过掩码映射到槽位。生产者和消费者各自缓存对方的下标，
+ * 只有缓存值显示满或空时才读取对方所在的缓存行。
+ */
+typedef struct {
+  /* 生产者使用的字段 */
+  uint32_t tail;       /* 下一个写入位置 */
+  uint32_t head_cache; /* 生产者缓存的消费者读取位置 */
+  CACHE_LINE_PAD(tail_pad, 2 * sizeof(uint32_t));
+
+  /* 消费者使用的字段 */
+  uint32_t head;       /* 下一个读取位置 */
+  uint32_t tail_cache; /* 消费者缓存的生产者写入位置 */
+  CACHE_LINE_PAD(head_pad, 2 * sizeof(uint32_t));
+
+  /* 初始化后只读的字段 */
+  void **buf;      /* 槽位数组 */
+  uint32_t mask;   /* 容量减一 */
+  size_t map_size; /* mmap 映射大小，为 0 表示堆内存 */
+} ring_buffer;
+
+/**
+ * @brief: 初始化环形缓冲区
+ * @param rb: 环形缓冲区指针
+ * @param capacity: 容量，向上取整为 2 的幂，不超过 2^31
+ * @param flags: ring_buffer_flag 的组合
+ * @return: 成功返回 ret_ok，参数无效或内存不足返回 ret_err
+ */
+ret_val ring_buffer_init(ring_buffer *rb, uint32_t capacity, int flags);
+
+/**
+ * @brief: 初始化环形缓冲区，槽位数组按页映射并绑定到指定 NUMA 节点
+ * @param rb: 环形缓冲区指针
+ * @param capacity: 容量，向上取整为 2 的幂，不超过 2^31
+ * @param flags: ring_buffer_flag 的组合
+ * @param node: NUMA 节点，MEM_NUMA_NODE_ANY 表示不绑定
+ * @return: 成功返回 ret_ok，参数无效或内存不足返回 ret_err
+ */
+ret_val ring_buffer_init_on_node(ring_buffer *rb, uint32_t capacity, int flags,
+                                 int node);
+
+/**
+ * @brief: 释放环形缓冲区的槽位数组
+ * @param rb: 环形缓冲区指针
+ */
+void ring_buffer_destroy(ring_buffer *rb);
+
+/**
+ * @brief: 写入一个值，只能由生产者线程调用
+ * @param rb: 环形缓冲区指针
+ * @param val: 要写入的值
+ * @return: 成功返回 ret_ok，缓冲区已满返回 ret_err
+ */
+ret_val ring_buffer_push(ring_buffer *rb, void *val);
+
+/**
+ * @brief: 读取一个值，只能由消费者线程调用
+ * @param rb: 环形缓冲区指针
+ * @param val: 保存读取的值
+ * @return: 成功返回 ret_ok，缓冲区为空返回 ret_err
+ */
+ret_val ring_buffer_pop(ring_buffer *rb, void **val);
+
+/**
+ * @brief: 批量写入，只能由生产者线程调用
+ * @param rb: 环形缓冲区指针
+ * @param vals: 要写入的值数组
+ * @param n: 值的数量
+ * @return: 返回实际写入的数量
+ */
+uint32_t ring_buffer_push_batch(ring_buffer *rb, void **vals, uint32_t n);
+
+/**
+ * @brief: 批量读取，只能由消费者线程调用
+ * @param rb: 环形缓冲区指针
+ * @param vals: 保存读取的值的数组
+ * @param max: 数组容量
+ * @return: 返回实际读取的数量
+ */
+uint32_t ring_buffer_pop_batch(ring_buffer *rb, void **vals, uint32_t max);
+
+/**
+ * @brief: 获取缓冲区中值的数量，并发读写时为近似值
+ * @param rb: 环形缓冲区指针
+ * @return: 返回值的数量
+ */
+uint32_t ring_buffer_get_length(ring_buffer *rb);
+
+/**
+ * @brief: 获取缓冲区容量
+ * @param rb: 环形缓冲区指针
+ * @return: 返回容量
+ */
+uint32_t ring_buffer_get_capacity(ring_buffer *rb);
+
+#endif // !__RING_BUFFER_H_
@@ -0,0 +1,200 @@
+/**
+ * @file ring_buffer.c
+ * @brief 单生产者单消费者环形缓冲区实现文件。
+ * @author moecly
+ */
+
+#include "../inc/ring_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief 初始化环形缓冲区。
+ * @param rb 环形缓冲区指针。
+ * @param capacity 容量，向上取整为 2 的幂，不超过 2^31。
+ * @param flags ring_buffer_flag 的组合。
+ * @return 成功返回 ret_ok，参数无效或内存不足返回 ret_err。
+ */
+ret_val ring_buffer_init(ring_buffer *rb, uint32_t capacity, int flags) {
+  return ring_buffer_init_on_node(rb, capacity, flags, MEM_NUMA_NODE_ANY);
+}
+
+/**
+ * @brief 初始化环形缓冲区，槽位数组按页映射并绑定到指定 NUMA 节点。
+ * @param rb 环形缓冲区指针。
+ * @param capacity 容量，向上取整为 2 的幂，不超过 2^31。
+ * @param flags ring_buffer_flag 的组合。
+ * @param node NUMA 节点，MEM_NUMA_NODE_ANY 表示不绑定。
+ * @return 成功返回 ret_ok，参数无效或内存不足返回 ret_err。
+ */
+ret_val ring_buffer_init_on_node(ring_buffer *rb, uint32_t capacity, int flags,
+                                 int node) {
+  uint32_t size = 1;
+  int page_flags = mem_page_flag_none;
+
+  if (!capacity || capacity > (1U << 31))
+    return ret_err;
+  while (size < capacity)
+    size <<= 1;
+
+  memset(rb, 0, sizeof(*rb));
+  rb->mask = size - 1;
+
+  /* 使用大页或绑定节点时按页映射，否则使用堆内存 */
+  if (flags & ring_buffer_flag_huge_page)
+    page_flags |= mem_page_flag_huge;
+  if (page_flags != mem_page_flag_none || node != MEM_NUMA_NODE_ANY) {
+    rb->buf = (void **)mem_pages_alloc(sizeof(void *) * size, page_flags, node,
+                                       &rb->map_size);
+    return rb->buf ? ret_ok : ret_err;
+  }
+
+  rb->buf = MALLOC_ARRAY_FUNC(void *, size);
+  if (!rb->buf)
+    return ret_err;
+  return ret_ok;
+}
+
+/**
+ * @brief 释放环形缓冲区的槽位数组。
+ * @param rb 环形缓冲区指针。
+ */
+void ring_buffer_destroy(ring_buffer *rb) {
+  if (rb->map_size)
+    mem_pages_free(rb->buf, rb->map_size);
+  else
+    FREE_FUNC(rb->buf);
+  rb->buf = NULL;
+  rb->map_size = 0;
+}
+
+/**
+ * @brief 计算生产者可写入的槽位数，必要时刷新缓存的读取位置。
+ * @param rb 环形缓冲区指针。
+ * @param want 期望写入的数量。
+ * @return 返回可写入的槽位数。
+ */
+static uint32_t ring_buffer_free_slots(ring_buffer *rb, uint32_t want) {
+  uint32_t capacity = rb->mask + 1;
+  uint32_t free_slots = capacity - (rb->tail - rb->head_cache);
+
+  if (free_slots < want) {
+    rb->head_cache = __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE);
+    free_slots = capacity - (rb->tail - rb->head_cache);
+  }
+  return free_slots;
+}
+
+/**
+ * @brief 计算消费者可读取的值的数量，必要时刷新缓存的写入位置。
+ * @param rb 环形缓冲区指针。
+ * @param want 期望读取的数量。
+ * @return 返回可读取的数量。
+ */
+static uint32_t ring_buffer_used_slots(ring_buffer *rb, uint32_t want) {
+  uint32_t used = rb->tail_cache - rb->head;
+
+  if (used < want) {
+    rb->tail_cache = __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE);
+    used = rb->tail_cache - rb->head;
+  }
+  return used;
+}
+
+/**
+ * @brief 写入一个值，只能由生产者线程调用。
+ * @param rb 环形缓冲区指针。
+ * @param val 要写入的值。
+ * @return 成功返回 ret_ok，缓冲区已满返回 ret_err。
+ */
+ret_val ring_buffer_push(ring_buffer *rb, void *val) {
+  if (!ring_buffer_free_slots(rb, 1))
+    return ret_err;
+
+  rb->buf[rb->tail & rb->mask] = val;
+  __atomic_store_n(&rb->tail, rb->tail + 1, __ATOMIC_RELEASE);
+  return ret_ok;
+}
+
+/**
+ * @brief 读取一个值，只能由消费者线程调用。
+ * @param rb 环形缓冲区指针。
+ * @param val 保存读取的值。
+ * @return 成功返回 ret_ok，缓冲区为空返回 ret_err。
+ */
+ret_val ring_buffer_pop(ring_buffer *rb, void **val) {
+  if (!ring_buffer_used_slots(rb, 1))
+    return ret_err;
+
+  *val = rb->buf[rb->head & rb->mask];
+  __atomic_store_n(&rb->head, rb->head + 1, __ATOMIC_RELEASE);
+  return ret_ok;
+}
+
+/**
+ * @brief 批量写入，只能由生产者线程调用。
+ * @param rb 环形缓冲区指针。
+ * @param vals 要写入的值数组。
+ * @param n 值的数量。
+ * @return 返回实际写入的数量。
+ */
+uint32_t ring_buffer_push_batch(ring_buffer *rb, void **vals, uint32_t n) {
+  uint32_t free_slots = ring_buffer_free_slots(rb, n);
+  uint32_t idx = rb->tail & rb->mask;
+  uint32_t first;
+
+  if (n > free_slots)
+    n = free_slots;
+
+  /* 分两段拷贝，处理回绕 */
+  first = rb->mask + 1 - idx;
+  if (first > n)
+    first = n;
+  memcpy(&rb->buf[idx], vals, sizeof(void *) * first);
+  memcpy(&rb->buf[0], vals + first, sizeof(void *) * (n - first));
+
+  __atomic_store_n(&rb->tail, rb->tail + n, __ATOMIC_RELEASE);
+  return n;
+}
+
+/**
+ * @brief 批量读取，只能由消费者线程调用。
+ * @param rb 环形缓冲区指针。
+ * @param vals 保存读取的值的数组。
+ * @param max 数组容量。
+ * @return 返回实际读取的数量。
+ */
+uint32_t ring_buffer_pop_batch(ring_buffer *rb, void **vals, uint32_t max) {
+  uint32_t used = ring_buffer_used_slots(rb, max);
+  uint32_t idx = rb->head & rb->mask;
+  uint32_t first;
+
+  if (max > used)
+    max = used;
+
+  first = rb->mask + 1 - idx;
+  if (first > max)
+    first = max;
+  memcpy(vals, &rb->buf[idx], sizeof(void *) * first);
+  memcpy(vals + first, &rb->buf[0], sizeof(void *) * (max - first));
+
+  __atomic_store_n(&rb->head, rb->head + max, __ATOMIC_RELEASE);
+  return max;
+}
+
+/**
+ * @brief 获取缓冲区中值的数量，并发读写时为近似值。
+ * @param rb 环形缓冲区指针。
+ * @return 返回值的数量。
+ */
+uint32_t ring_buffer_get_length(ring_buffer *rb) {
+  return __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE) -
+         __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief 获取缓冲区容量。
+ * @param rb 环形缓冲区指针。
+ * @return 返回容量。
+ */
+uint32_t ring_buffer_get_capacity(ring_buffer *rb) { return rb->mask + 1; }
@@ -8,6 +8,8 @@
 #define __SOCKET_OPERATOR_H_
 
 #include "../../common/inc/common.h"
+#include "../../common/inc/obj_pool.h"
+#include "../../iobuf/inc/iobuf.h"
 #include <arpa/inet.h>
 
 /**
@@ -233,4 +235,73 @@ ssize_t socket_send_block(socket_info *info, const void *buf, ssize_t len,
  */
 ssize_t socket_send_unblock(socket_info *info, const void *buf, ssize_t len);
 
+/**
+ * @brief Maximum number of iobuf segments passed to one sendmsg() call.
+ */
+#ifndef SOCKET_IOBUF_IOV_MAX
+#define SOCKET_IOBUF_IOV_MAX 64
+#endif // !SOCKET_IOBUF_IOV_MAX
+
+/**
+ * @brief Receives data from a socket into an iobuf.
+ *
+ * Received bytes are written directly into tail space of the iobuf, so no
+ * intermediate flat buffer is needed. At least len bytes of tail space are
+ * reserved and recv() may fill all of it, so more than len bytes can be
+ * received. On failure no empty segment is left behind.
+ *
+ * @param info Pointer to the socket_info structure.
+ * @param buf Pointer to the iobuf to append received data to.
+ * @param len Minimum tail space to reserve; up to all reserved space is read.
+ * @param time_s timeout second.
+ * @param time_us timeout us.
+ * @return Returns the number of bytes received on success, or -1 on failure.
+ */
+ssize_t socket_recv_iobuf_block(socket_info *info, iobuf *buf, size_t len,
+                                int time_s, int time_us);
+
+/**
+ * @brief Receives data from a socket into an iobuf (non-blocking).
+ *
+ * @param info Pointer to the socket_info structure.
+ * @param buf Pointer to the iobuf to append received data to.
+ * @param len Minimum tail space to reserve; up to all reserved space is read.
+ * @return Returns the number of bytes received on success, or -1 on failure.
+ */
+ssize_t socket_recv_iobuf_unblock(socket_info *info, iobuf *buf, size_t len);
+
+/**
+ * @brief Sends the contents of an iobuf through a socket.
+ *
+ * Segments are passed to sendmsg() as an iovec array without copying. Sent
+ * bytes are trimmed from the front of the iobuf, so a partial send can be
+ * resumed by calling again.
+ *
+ * @param info Pointer to the socket_info structure.
+ * @param buf Pointer to the iobuf to send.
+ * @param time_s timeout second.
+ * @param time_us timeout us.
+ * @return Returns the number of bytes sent on success, or -1 on failure.
+ */
+ssize_t socket_send_iobuf_block(socket_info *info, iobuf *buf, int time_s,
+                                int time_us);
+
+/**
+ * @brief Sends the contents of an iobuf through a socket (non-blocking).
+ *
+ * @param info Pointer to the socket_info structure.
+ * @param buf Pointer to the iobuf to send, sent bytes are trimmed.
+ * @return Returns the number of bytes sent on success, or -1 on failure.
+ */
+ssize_t socket_send_iobuf_unblock(socket_info *info, iobuf *buf);
+
+/**
+ * @brief Pooled socket_info objects.
+ *
+ * socket_info_pool_get() returns a zeroed socket_info with sockfd set to -1,
+ * or NULL if out of memory. socket_info_pool_put() returns it to the pool;
+ * the socket must already be closed.
+ */
+DECLARE_POOL(socket_info)
+
 #endif // !__SOCKET_OPERATOR_H_
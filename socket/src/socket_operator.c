@@ -5,10 +5,25 @@
  */
 
 #include "../inc/socket_operator.h"
+#include "../../common/inc/metrics.h"
 #include <fcntl.h>
 #include <string.h>
 #include <unistd.h>
 
+/**
+ * @brief Resets a socket_info taken from the pool.
+ *
+ * @param obj Pointer to the socket_info structure.
+ */
+static void socket_info_pool_ctor(void *obj) {
+  socket_info *info = (socket_info *)obj;
+
+  memset(info, 0, sizeof(*info));
+  info->sockfd = -1;
+}
+
+DEFINE_POOL_WITH_HOOKS(socket_info, socket_info_pool_ctor, NULL)
+
 /**
  * @brief Connects a client socket to a server.
  *
@@ -276,6 +291,52 @@ ret_val socket_server_close(socket_server_operator *opr) {
   return socket_close(&opr->server_info);
 }
 
+/**
+ * @brief Sets the send or receive timeout of a socket.
+ *
+ * @param info Pointer to the socket_info structure.
+ * @param opt SO_RCVTIMEO or SO_SNDTIMEO.
+ * @param time_s timeout second.
+ * @param time_us timeout us.
+ * @return Returns ret_ok on success, ret_err on failure.
+ */
+static ret_val socket_set_timeout(socket_info *info, int opt, int time_s,
+                                  int time_us) {
+  struct timeval timeout;
+
+  timeout.tv_usec = time_us;
+  timeout.tv_sec = time_s;
+  if (setsockopt(info->sockfd, SOL_SOCKET, opt, &timeout, sizeof(timeout)))
+    return ret_err;
+  return ret_ok;
+}
+
+/**
+ * @brief Counts the bytes of a successful recv() when USE_METRICS is defined.
+ *
+ * @param n Result of the recv call.
+ * @return Returns n unchanged.
+ */
+static inline ssize_t socket_count_recv(ssize_t n) {
+  if (n > 0)
+    METRICS_COUNT("c_utils_socket_received_bytes_total",
+                  "Bytes received through socket_operator.", (uint64_t)n);
+  return n;
+}
+
+/**
+ * @brief Counts the bytes of a successful send() when USE_METRICS is defined.
+ *
+ * @param n Result of the send call.
+ * @return Returns n unchanged.
+ */
+static inline ssize_t socket_count_send(ssize_t n) {
+  if (n > 0)
+    METRICS_COUNT("c_utils_socket_sent_bytes_total",
+                  "Bytes sent through socket_operator.", (uint64_t)n);
+  return n;
+}
+
 /**
  * @brief Receives data from a socket.
  *
@@ -291,17 +352,10 @@ ret_val socket_server_close(socket_server_operator *opr) {
  */
 ssize_t socket_recv_block(socket_info *info, void *buf, ssize_t len, int time_s,
                           int time_us) {
-  struct timeval timeout;
-  int ret;
-
-  timeout.tv_usec = time_us;
-  timeout.tv_sec = time_s;
-  ret = setsockopt(info->sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
-                   sizeof(timeout));
-  if (ret)
+  if (socket_set_timeout(info, SO_RCVTIMEO, time_s, time_us) != ret_ok)
     return -1;
 
-  return recv(info->sockfd, buf, len, 0);
+  return socket_count_recv(recv(info->sockfd, buf, len, 0));
 }
 
 /**
@@ -316,7 +370,7 @@ ssize_t socket_recv_block(socket_info *info, void *buf, ssize_t len, int time_s,
  * @return Returns the number of bytes received on success, or -1 on failure.
  */
 ssize_t socket_recv_unblock(socket_info *info, void *buf, ssize_t len) {
-  return recv(info->sockfd, buf, len, MSG_DONTWAIT);
+  return socket_count_recv(recv(info->sockfd, buf, len, MSG_DONTWAIT));
 }
 
 /**
@@ -333,17 +387,10 @@ ssize_t socket_recv_unblock(socket_info *info, void *buf, ssize_t len) {
  */
 ssize_t socket_send_block(socket_info *info, const void *buf, ssize_t len,
                           int time_s, int time_us) {
-  struct timeval timeout;
-  int ret;
-
-  timeout.tv_usec = time_us;
-  timeout.tv_sec = time_s;
-  ret = setsockopt(info->sockfd, SOL_SOCKET, SO_SNDTIMEO, &timeout,
-                   sizeof(timeout));
-  if (ret)
+  if (socket_set_timeout(info, SO_SNDTIMEO, time_s, time_us) != ret_ok)
     return -1;
 
-  return send(info->sockfd, buf, len, 0);
+  return socket_count_send(send(info->sockfd, buf, len, 0));
 }
 
 /**
@@ -357,5 +404,116 @@ ssize_t socket_send_block(socket_info *info, const void *buf, ssize_t len,
  * @return Returns the number of bytes sent on success, or -1 on failure.
  */
 ssize_t socket_send_unblock(socket_info *info, const void *buf, ssize_t len) {
-  return send(info->sockfd, buf, len, MSG_DONTWAIT);
+  return socket_count_send(send(info->sockfd, buf, len, MSG_DONTWAIT));
+}
+
+/**
+ * @brief Receives data from a socket into tail space of an iobuf.
+ *
+ * @param info Pointer to the socket_info structure.
+ * @param buf Pointer to the iobuf to append received data to.
+ * @param len Minimum tail space to reserve; up to all reserved space is read.
+ * @param flags Flags passed to recv().
+ * @return Returns the number of bytes received on success, or -1 on failure.
+ */
+static ssize_t socket_recv_iobuf(socket_info *info, iobuf *buf, size_t len,
+                                 int flags) {
+  unsigned char *dst;
+  size_t avail;
+  ssize_t n;
+
+  dst = iobuf_reserve(buf, len, &avail);
+  if (!dst)
+    return -1;
+
+  /* Fill all reserved tail space; drop the empty node on failure. */
+  n = socket_count_recv(recv(info->sockfd, dst, avail, flags));
+  if (n > 0)
+    iobuf_commit(buf, (size_t)n);
+  else
+    iobuf_unreserve(buf);
+  return n;
+}
+
+/**
+ * @brief Sends iobuf segments with sendmsg() and trims the sent bytes.
+ *
+ * @param info Pointer to the socket_info structure.
+ * @param buf Pointer to the iobuf to send.
+ * @param flags Flags passed to sendmsg().
+ * @return Returns the number of bytes sent on success, or -1 on failure.
+ */
+static ssize_t socket_send_iobuf(socket_info *info, iobuf *buf, int flags) {
+  struct iovec iov[SOCKET_IOBUF_IOV_MAX];
+  struct msghdr msg;
+  ssize_t n;
+
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = iobuf_to_iovec(buf, iov, SOCKET_IOBUF_IOV_MAX);
+  if (!msg.msg_iovlen)
+    return 0;
+
+  n = socket_count_send(sendmsg(info->sockfd, &msg, flags));
+  if (n > 0)
+    iobuf_trim_front(buf, (size_t)n);
+  return n;
+}
+
+/**
+ * @brief Receives data from a socket into an iobuf.
+ *
+ * @param info Pointer to the socket_info structure.
+ * @param buf Pointer to the iobuf to append received data to.
+ * @param len Minimum tail space to reserve; up to all reserved space is read.
+ * @param time_s timeout second.
+ * @param time_us timeout us.
+ * @return Returns the number of bytes received on success, or -1 on failure.
+ */
+ssize_t socket_recv_iobuf_block(socket_info *info, iobuf *buf, size_t len,
+                                int time_s, int time_us) {
+  if (socket_set_timeout(info, SO_RCVTIMEO, time_s, time_us) != ret_ok)
+    return -1;
+
+  return socket_recv_iobuf(info, buf, len, 0);
+}
+
+/**
+ * @brief Receives data from a socket into an iobuf (non-blocking).
+ *
+ * @param info Pointer to the socket_info structure.
+ * @param buf Pointer to the iobuf to append received data to.
+ * @param len Minimum tail space to reserve; up to all reserved space is read.
+ * @return Returns the number of bytes received on success, or -1 on failure.
+ */
+ssize_t socket_recv_iobuf_unblock(socket_info *info, iobuf *buf, size_t len) {
+  return socket_recv_iobuf(info, buf, len, MSG_DONTWAIT);
+}
+
+/**
+ * @brief Sends the contents of an iobuf through a socket.
+ *
+ * @param info Pointer to the socket_info structure.
+ * @param buf Pointer to the iobuf to send, sent bytes are trimmed.
+ * @param time_s timeout second.
+ * @param time_us timeout us.
+ * @return Returns the number of bytes sent on success, or -1 on failure.
+ */
+ssize_t socket_send_iobuf_block(socket_info *info, iobuf *buf, int time_s,
+                                int time_us) {
+  if (socket_set_timeout(info, SO_SNDTIMEO, time_s, time_us) != ret_ok)
+    return -1;
+
+  return socket_send_iobuf(info, buf, 0);
+}
+
+/**
+ * @brief Sends the contents of an iobuf through a socket (non-blocking).
+ *
+ * @param info Pointer to the socket_info structure.
+ * @param buf Pointer to the iobuf to send, sent bytes are trimmed.
+ * @return Returns the number of bytes sent on success, or -1 on failure.
+ */
+ssize_t socket_send_iobuf_unblock(socket_info *info, iobuf *buf) {
+  return socket_send_iobuf(info, buf, MSG_DONTWAIT);
 }
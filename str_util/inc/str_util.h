@@ -7,22 +7,428 @@
 #ifndef __STR_UTIL_H_
 #define __STR_UTIL_H_
 
+#include "../../common/inc/common.h"
 #include "stdio.h"
 #include "string.h"
+#include <stdint.h>
 
+/* str_fmt_i32() 需要的缓冲区字节数 */
+#define STR_FMT_INT32_SIZE 12
+
+/* str_fmt_i64()、str_fmt_u64() 需要的缓冲区字节数 */
+#define STR_FMT_INT_SIZE 21
+
+/* str_fmt_hex() 需要的缓冲区字节数 */
+#define STR_FMT_HEX_SIZE 17
+
+/* str_fmt_double() 需要的缓冲区字节数 */
+#define STR_FMT_DOUBLE_SIZE 32
+
+/**
+ * @brief: 数值解析的错误码
+ */
+typedef enum {
+  str_parse_ok = 0,   /* 解析成功 */
+  str_parse_invalid,  /* 开头不是合法的数值 */
+  str_parse_overflow, /* 数值超出目标类型的范围 */
+} str_parse_err;
+
+/**
+ * @brief: 数值解析的结果
+ */
 typedef struct {
-} str_ops;
+  const char *end;   /* 已解析部分之后的位置，str_parse_invalid 时为输入起始位置 */
+  str_parse_err err; /* 错误码 */
+} str_parse_result;
+
+/**
+ * @brief: 字符串视图，指向其他字符串的一段内容，不以 '\0' 结尾
+ */
+typedef struct {
+  const char *ptr; /* 起始位置 */
+  size_t len;      /* 长度 */
+} str_view;
 
+/**
+ * @brief: 行遍历器
+ */
 typedef struct {
-  char *val;
-  str_ops ops;
+  const char *cur; /* 下一行的起始位置 */
+  const char *end; /* 输入结束位置 */
+} str_line_iter;
+
+/**
+ * @brief: 字符串驻留表，具体结构由实现定义
+ */
+typedef struct str_intern str_intern;
+
+/**
+ * @brief: 字符串驻留表的内存使用统计
+ */
+typedef struct {
+  size_t count;       /* 驻留的字符串数 */
+  size_t str_bytes;   /* 字符串内容的总字节数 */
+  size_t arena_bytes; /* 保存字符串的 arena 内存块总字节数 */
+  size_t table_bytes; /* 槽位表占用的字节数，含扩容后保留的旧表 */
+  size_t total_bytes; /* 驻留表占用的总字节数 */
+} str_intern_stats;
+
+/* 内联存储可容纳的最大长度，不超过该长度的字符串不申请堆内存 */
+#define STR_OBJS_SSO_CAP 22
+
+/* str_ops.find() 未找到时的返回值 */
+#define STR_OBJS_NPOS ((size_t)-1)
+
+struct str_objs;
+
+/**
+ * @brief: 字符串操作函数表，所有长度均显式传入，不依赖 '\0'
+ */
+typedef struct str_ops {
+  ret_val (*append)(struct str_objs *str, const char *src,
+                    size_t len); /* 追加到末尾 */
+  ret_val (*insert)(struct str_objs *str, size_t pos, const char *src,
+                    size_t len); /* 插入到 pos 处 */
+  size_t (*find)(const struct str_objs *str, size_t from, const char *needle,
+                 size_t len); /* 从 from 开始查找子串 */
+  ret_val (*slice)(const struct str_objs *str, size_t pos, size_t len,
+                   struct str_objs *out); /* 复制子串到新的字符串对象 */
+  int (*compare)(const struct str_objs *str, const char *other,
+                 size_t len); /* 按字节比较 */
+} str_ops;
+
+/**
+ * @brief: 记录长度和容量的字符串对象
+ *
+ * 长度不超过 STR_OBJS_SSO_CAP 时存放在对象内部，超出后按容量倍增申请堆内存。
+ * 内容总以 '\0' 结尾，但可以包含 '\0'。对象持有堆内存，不能直接按值复制。
+ */
+typedef struct str_objs {
+  size_t len; /* 字符串长度 */
+  size_t cap; /* 可容纳的最大长度，不含结尾的 '\0' */
+  union {
+    char *ptr;                      /* 堆内存，cap 大于 STR_OBJS_SSO_CAP 时有效 */
+    char sso[STR_OBJS_SSO_CAP + 1]; /* 内联存储 */
+  } data;
+  mem_allocator *allocator; /* 内存分配器，为 NULL 时使用默认分配器 */
+  const str_ops *ops;       /* 操作函数表 */
 } str_objs;
 
+#ifndef STR_OBJS_DATA
+#define STR_OBJS_DATA(str)                                                     \
+  ((str)->cap > STR_OBJS_SSO_CAP ? (str)->data.ptr : (str)->data.sso)
+#endif // !STR_OBJS_DATA
+
+#ifndef STR_OBJS_LEN
+#define STR_OBJS_LEN(str) ((str)->len)
+#endif // !STR_OBJS_LEN
+
 /**
  * @brief: 将整数转换为字符串
- * @param str: 存储转换结果的字符串
+ * @param str: 存储转换结果的字符串，不少于 STR_FMT_INT32_SIZE 字节
  * @param num: 要转换的整数
  */
 void int_num_to_str(char *str, int num);
 
+/**
+ * @brief: 将有符号 32 位整数格式化为十进制字符串
+ * @param buf: 缓冲区，不少于 STR_FMT_INT32_SIZE 字节
+ * @param v: 数值
+ * @return: 返回写入的字节数，不含结尾的 '\0'
+ */
+size_t str_fmt_i32(char *buf, int32_t v);
+
+/**
+ * @brief: 将有符号 64 位整数格式化为十进制字符串
+ * @param buf: 缓冲区，不少于 STR_FMT_INT_SIZE 字节
+ * @param v: 数值
+ * @return: 返回写入的字节数，不含结尾的 '\0'
+ */
+size_t str_fmt_i64(char *buf, int64_t v);
+
+/**
+ * @brief: 将无符号 64 位整数格式化为十进制字符串
+ * @param buf: 缓冲区，不少于 STR_FMT_INT_SIZE 字节
+ * @param v: 数值
+ * @return: 返回写入的字节数，不含结尾的 '\0'
+ */
+size_t str_fmt_u64(char *buf, uint64_t v);
+
+/**
+ * @brief: 将无符号 64 位整数格式化为十六进制字符串，不含前缀和前导零
+ * @param buf: 缓冲区，不少于 STR_FMT_HEX_SIZE 字节
+ * @param v: 数值
+ * @param upper: 非 0 时使用大写字母
+ * @return: 返回写入的字节数，不含结尾的 '\0'
+ */
+size_t str_fmt_hex(char *buf, uint64_t v, int upper);
+
+/**
+ * @brief: 将双精度浮点数格式化为可还原为原值的最短十进制字符串
+ *
+ * 小数点位置在第 -5 到 21 位之间时使用定点表示，如 "0.001"、"1.5"、"100"，
+ * 否则使用科学计数法，如 "1e+21"、"1.5e-7"。非数和无穷输出 "nan"、"inf"、
+ * "-inf"。
+ *
+ * @param buf: 缓冲区，不少于 STR_FMT_DOUBLE_SIZE 字节
+ * @param v: 数值
+ * @return: 返回写入的字节数，不含结尾的 '\0'
+ */
+size_t str_fmt_double(char *buf, double v);
+
+/**
+ * @brief: 将字符串开头的十进制数解析为有符号 32 位整数
+ *
+ * 格式为可选的 '+' 或 '-' 后跟至少一位数字，不跳过空白，不受 locale 影响。
+ * 数值超出范围时 end 仍指向全部数字之后。
+ *
+ * @param s: 输入字符串，不要求以 '\0' 结尾
+ * @param len: 输入长度
+ * @param val: 解析成功时保存数值，失败时不修改
+ * @return: 返回解析结果
+ */
+str_parse_result str_parse_i32(const char *s, size_t len, int32_t *val);
+
+/**
+ * @brief: 将字符串开头的十进制数解析为有符号 64 位整数，格式同 str_parse_i32()
+ * @param s: 输入字符串，不要求以 '\0' 结尾
+ * @param len: 输入长度
+ * @param val: 解析成功时保存数值，失败时不修改
+ * @return: 返回解析结果
+ */
+str_parse_result str_parse_i64(const char *s, size_t len, int64_t *val);
+
+/**
+ * @brief: 将字符串开头的十进制数解析为无符号 64 位整数，不接受 '-'
+ * @param s: 输入字符串，不要求以 '\0' 结尾
+ * @param len: 输入长度
+ * @param val: 解析成功时保存数值，失败时不修改
+ * @return: 返回解析结果
+ */
+str_parse_result str_parse_u64(const char *s, size_t len, uint64_t *val);
+
+/**
+ * @brief: 将字符串开头的十进制数解析为双精度浮点数，结果为最接近的值
+ *
+ * 格式为可选的符号、数字及可选的小数部分、可选的 e 或 E 开头的指数，
+ * 以及不区分大小写的 "inf"、"infinity"、"nan"。不支持十六进制，不跳过
+ * 空白，小数点固定为 '.'。结果超出 double 范围时返回 str_parse_overflow，
+ * 过小时返回 0 或非规格化数。
+ *
+ * @param s: 输入字符串，不要求以 '\0' 结尾
+ * @param len: 输入长度
+ * @param val: 解析成功时保存数值，失败时不修改
+ * @return: 返回解析结果
+ */
+str_parse_result str_parse_double(const char *s, size_t len, double *val);
+
+/**
+ * @brief: 通过分配器复制字符串
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器，传入
+ * arena_get_allocator() 的返回值时随 arena 一起释放
+ * @param str: 要复制的字符串
+ * @return: 返回新字符串，失败返回 NULL
+ */
+char *str_dup(mem_allocator *allocator, const char *str);
+
+/**
+ * @brief: 通过分配器复制字符串的前 len 个字节，结果以 '\0' 结尾
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器
+ * @param str: 要复制的字符串
+ * @param len: 要复制的字节数
+ * @return: 返回新字符串，失败返回 NULL
+ */
+char *str_ndup(mem_allocator *allocator, const char *str, size_t len);
+
+/**
+ * @brief: 初始化空字符串对象
+ * @param str: 字符串对象
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器
+ */
+void str_objs_init(str_objs *str, mem_allocator *allocator);
+
+/**
+ * @brief: 以 src 的前 len 个字节初始化字符串对象
+ * @param str: 字符串对象
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器
+ * @param src: 初始内容
+ * @param len: 初始内容的字节数
+ * @return: 成功返回 ret_ok，申请内存失败返回 ret_err，此时 str 为空字符串
+ */
+ret_val str_objs_init_with(str_objs *str, mem_allocator *allocator,
+                           const char *src, size_t len);
+
+/**
+ * @brief: 释放字符串对象的堆内存，之后 str 为空字符串，可继续使用
+ * @param str: 字符串对象
+ */
+void str_objs_destroy(str_objs *str);
+
+/**
+ * @brief: 确保容量不小于 cap，已有内容不变
+ * @param str: 字符串对象
+ * @param cap: 需要的容量，不含结尾的 '\0'
+ * @return: 成功返回 ret_ok，申请内存失败返回 ret_err
+ */
+ret_val str_objs_reserve(str_objs *str, size_t cap);
+
+/**
+ * @brief: 清空内容，保留已申请的容量
+ * @param str: 字符串对象
+ */
+void str_objs_clear(str_objs *str);
+
+/**
+ * @brief: 将 src 的前 len 个字节追加到末尾，src 可指向 str 自身的内容
+ * @param str: 字符串对象
+ * @param src: 追加的内容
+ * @param len: 追加的字节数
+ * @return: 成功返回 ret_ok，申请内存失败返回 ret_err，此时内容不变
+ */
+ret_val str_objs_append(str_objs *str, const char *src, size_t len);
+
+/**
+ * @brief: 将 src 的前 len 个字节插入到 pos 处，src 可指向 str 自身的内容
+ * @param str: 字符串对象
+ * @param pos: 插入位置，不大于当前长度
+ * @param src: 插入的内容
+ * @param len: 插入的字节数
+ * @return: 成功返回 ret_ok，pos 越界或申请内存失败返回 ret_err，此时内容不变
+ */
+ret_val str_objs_insert(str_objs *str, size_t pos, const char *src, size_t len);
+
+/**
+ * @brief: 从 from 处开始查找子串
+ * @param str: 字符串对象
+ * @param from: 开始查找的位置
+ * @param needle: 子串
+ * @param len: 子串的字节数，为 0 时在 from 不越界时返回 from
+ * @return: 返回子串首次出现的位置，未找到返回 STR_OBJS_NPOS
+ */
+size_t str_objs_find(const str_objs *str, size_t from, const char *needle,
+                     size_t len);
+
+/**
+ * @brief: 将从 pos 开始的 len 个字节复制到新的字符串对象，超出末尾的部分忽略
+ * @param str: 字符串对象
+ * @param pos: 起始位置，不大于当前长度
+ * @param len: 字节数
+ * @param out: 未初始化的字符串对象，使用与 str 相同的分配器初始化
+ * @return: 成功返回 ret_ok，pos 越界或申请内存失败返回 ret_err，此时 out
+ * 为空字符串
+ */
+ret_val str_objs_slice(const str_objs *str, size_t pos, size_t len,
+                       str_objs *out);
+
+/**
+ * @brief: 按字节比较字符串对象与 other 的前 len 个字节，较短者为前缀时较短者小
+ * @param str: 字符串对象
+ * @param other: 比较的内容
+ * @param len: 比较内容的字节数
+ * @return: str 小于、等于、大于 other 时分别返回负数、0、正数
+ */
+int str_objs_compare(const str_objs *str, const char *other, size_t len);
+
+/**
+ * @brief: 查找首个属于 set 的字节，按 CPU 支持的指令集选择实现
+ * @param s: 输入
+ * @param len: 输入长度
+ * @param set: 字节集合，超过 16 个字节时使用标量实现
+ * @param nset: 集合的字节数
+ * @return: 返回首个匹配字节的位置，未找到返回 NULL
+ */
+const char *str_find_any(const char *s, size_t len, const char *set,
+                         size_t nset);
+
+/**
+ * @brief: 按 delims 中的任一字节切分输入，视图指向输入本身，不复制内容
+ *
+ * 相邻的分隔符之间以及首尾的分隔符外侧产生空字段，n 个分隔符产生 n + 1 个
+ * 字段。字段数超过 max_views 时最后一个视图包含剩余的全部内容。
+ *
+ * @param s: 输入
+ * @param len: 输入长度
+ * @param delims: 分隔字节集合
+ * @param ndelims: 分隔字节数
+ * @param views: 保存字段的视图数组
+ * @param max_views: 视图数组的长度
+ * @return: 返回写入的视图数，max_views 为 0 时返回 0
+ */
+size_t str_split(const char *s, size_t len, const char *delims,
+                 size_t ndelims, str_view *views, size_t max_views);
+
+/**
+ * @brief: 初始化行遍历器，遍历期间输入需保持有效
+ * @param it: 行遍历器
+ * @param s: 输入
+ * @param len: 输入长度
+ */
+void str_line_iter_init(str_line_iter *it, const char *s, size_t len);
+
+/**
+ * @brief: 获取下一行，结果不含行尾的 "\n" 或 "\r\n"，末尾没有换行符的内容
+ * 作为最后一行
+ * @param it: 行遍历器
+ * @param line: 保存行的视图
+ * @return: 获取到一行返回 1，已到末尾返回 0
+ */
+int str_line_next(str_line_iter *it, str_view *line);
+
+/**
+ * @brief: 去除开头和末尾的空白，空白为 ' '、'\t'、'\n'、'\v'、'\f'、'\r'
+ * @param s: 输入
+ * @param len: 输入长度
+ * @return: 返回指向输入内部的视图
+ */
+str_view str_trim(const char *s, size_t len);
+
+/**
+ * @brief: 创建字符串驻留表
+ *
+ * 相同内容只保存一份，驻留的字符串在驻留表销毁前保持有效，内容相同当且仅当
+ * 指针相同。查找不加锁，插入按分片加锁，可在多个线程中同时使用。
+ *
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器
+ * @return: 返回驻留表指针，失败返回 NULL
+ */
+str_intern *str_intern_create(mem_allocator *allocator);
+
+/**
+ * @brief: 销毁字符串驻留表，之前返回的字符串全部失效
+ * @param tbl: 驻留表指针，可为 NULL
+ */
+void str_intern_destroy(str_intern *tbl);
+
+/**
+ * @brief: 获取字符串的驻留副本，不存在时插入
+ * @param tbl: 驻留表指针
+ * @param s: 内容，不要求以 '\0' 结尾
+ * @param len: 内容长度
+ * @return: 返回以 '\0' 结尾的驻留字符串，申请内存失败返回 NULL
+ */
+const char *str_intern_get(str_intern *tbl, const char *s, size_t len);
+
+/**
+ * @brief: 查找字符串，不存在时不插入，不加锁
+ * @param tbl: 驻留表指针
+ * @param s: 内容，不要求以 '\0' 结尾
+ * @param len: 内容长度
+ * @return: 返回驻留的字符串，不存在返回 NULL
+ */
+const char *str_intern_lookup(str_intern *tbl, const char *s, size_t len);
+
+/**
+ * @brief: 获取驻留字符串的长度，不需要遍历内容
+ * @param str: str_intern_get() 或 str_intern_lookup() 返回的字符串
+ * @return: 返回长度
+ */
+size_t str_intern_len(const char *str);
+
+/**
+ * @brief: 获取内存使用统计，统计期间依次获取各分片的插入锁
+ * @param tbl: 驻留表指针
+ * @param stats: 保存统计结果
+ */
+void str_intern_get_stats(str_intern *tbl, str_intern_stats *stats);
+
 #endif // !__STR_UTIL_H_
\ No newline at end of file
@@ -0,0 +1,302 @@
+/**
+ * @brief: 字符串驻留表实现文件，相同内容的字符串只保存一份
+ * @file: str_intern.c
+ * @author: moecly
+ *
+ * 按哈希值的高位分为 STR_INTERN_SHARDS 个分片，每个分片持有一把插入锁、一个
+ * 保存字符串的 arena 和一张线性探测的槽位表。读取不加锁：槽位在条目写完后以
+ * release 语义发布，读者以 acquire 语义读取表和槽位。扩容时新表填好后再替换，
+ * 旧表可能仍有读者在访问，挂入退役链表，销毁驻留表时统一释放。
+ */
+
+#include "../inc/str_util.h"
+#include "../../common/inc/arena.h"
+#include "../../common/inc/fast_hash.h"
+#include "../../common/inc/mem_pages.h"
+#include <pthread.h>
+#include <string.h>
+
+/* 分片数，需为 2 的幂 */
+#define STR_INTERN_SHARDS 16
+#define STR_INTERN_SHARD_BITS 4
+
+/* 分片槽位表的初始槽位数 */
+#define STR_INTERN_INIT_SLOTS 64
+
+/**
+ * @brief: 驻留的字符串条目，内容紧跟在条目之后
+ */
+typedef struct {
+  uint64_t hash; /* 内容的哈希值 */
+  size_t len;    /* 内容长度 */
+  char data[];   /* 内容，以 '\0' 结尾 */
+} str_intern_entry;
+
+/**
+ * @brief: 槽位表，装载率不超过一半，探测总能遇到空槽位
+ */
+typedef struct str_intern_table {
+  struct str_intern_table *retired; /* 退役链表中的下一张旧表 */
+  size_t mask;                      /* 槽位数减一 */
+  str_intern_entry *slots[];        /* 槽位 */
+} str_intern_table;
+
+/**
+ * @brief: 分片，按缓存行对齐，避免不同分片的插入互相影响
+ */
+typedef struct {
+  pthread_mutex_t lock;    /* 插入锁 */
+  str_intern_table *table; /* 当前槽位表 */
+  arena strings;           /* 保存条目的 arena */
+  size_t count;            /* 条目数 */
+  size_t bytes;            /* 内容的总字节数，不含结尾的 '\0' */
+  size_t table_bytes;      /* 当前表与退役表占用的字节数 */
+} CACHE_LINE_ALIGNED str_intern_shard;
+
+/**
+ * @brief: 字符串驻留表
+ */
+struct str_intern {
+  str_intern_shard shards[STR_INTERN_SHARDS]; /* 分片 */
+  mem_allocator *allocator;                   /* 内存分配器 */
+};
+
+/**
+ * @brief: 申请槽位表
+ * @param allocator: 内存分配器
+ * @param slots: 槽位数，需为 2 的幂
+ * @return: 返回槽位表，失败返回 NULL
+ */
+static str_intern_table *str_intern_table_new(mem_allocator *allocator,
+                                              size_t slots) {
+  size_t size = sizeof(str_intern_table) + slots * sizeof(str_intern_entry *);
+  str_intern_table *table = (str_intern_table *)mem_alloc(allocator, size);
+
+  if (!table)
+    return NULL;
+  memset(table, 0, size);
+  table->mask = slots - 1;
+  return table;
+}
+
+/**
+ * @brief: 不加锁地在槽位表中查找
+ * @param table: 槽位表
+ * @param hash: 内容的哈希值
+ * @param s: 内容
+ * @param len: 内容长度
+ * @param slot: 未找到时保存探测结束的空槽位下标，可为 NULL
+ * @return: 返回条目，未找到返回 NULL
+ */
+static str_intern_entry *str_intern_probe(const str_intern_table *table,
+                                          uint64_t hash, const char *s,
+                                          size_t len, size_t *slot) {
+  size_t i = (size_t)hash & table->mask;
+  str_intern_entry *e;
+
+  for (;; i = (i + 1) & table->mask) {
+    e = __atomic_load_n(&table->slots[i], __ATOMIC_ACQUIRE);
+    if (!e) {
+      if (slot)
+        *slot = i;
+      return NULL;
+    }
+    if (e->hash == hash && e->len == len && !memcmp(e->data, s, len))
+      return e;
+  }
+}
+
+/**
+ * @brief: 将槽位表扩大一倍，调用者需持有分片的插入锁
+ * @param tbl: 驻留表
+ * @param shard: 分片
+ * @return: 成功返回 ret_ok，申请内存失败返回 ret_err
+ */
+static ret_val str_intern_grow(str_intern *tbl, str_intern_shard *shard) {
+  str_intern_table *old = shard->table;
+  str_intern_table *table = str_intern_table_new(tbl->allocator,
+                                                 (old->mask + 1) * 2);
+  str_intern_entry *e;
+  size_t i, j;
+
+  if (!table)
+    return ret_err;
+
+  for (i = 0; i <= old->mask; i++) {
+    e = old->slots[i];
+    if (!e)
+      continue;
+    for (j = (size_t)e->hash & table->mask; table->slots[j];
+         j = (j + 1) & table->mask)
+      ;
+    table->slots[j] = e;
+  }
+
+  /* 读者可能仍在访问旧表，销毁时再释放 */
+  table->retired = old;
+  shard->table_bytes +=
+      sizeof(str_intern_table) + (table->mask + 1) * sizeof(str_intern_entry *);
+  __atomic_store_n(&shard->table, table, __ATOMIC_RELEASE);
+  return ret_ok;
+}
+
+/**
+ * @brief: 创建字符串驻留表
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器
+ * @return: 返回驻留表指针，失败返回 NULL
+ */
+str_intern *str_intern_create(mem_allocator *allocator) {
+  str_intern *tbl;
+  str_intern_shard *shard;
+  int i;
+
+  tbl = (str_intern *)mem_cache_aligned_alloc(allocator, sizeof(str_intern));
+  if (!tbl)
+    return NULL;
+  memset(tbl, 0, sizeof(*tbl));
+  tbl->allocator = allocator;
+
+  for (i = 0; i < STR_INTERN_SHARDS; i++) {
+    shard = &tbl->shards[i];
+    shard->table = str_intern_table_new(allocator, STR_INTERN_INIT_SLOTS);
+    if (!shard->table) {
+      str_intern_destroy(tbl);
+      return NULL;
+    }
+    shard->table_bytes = sizeof(str_intern_table) +
+                         STR_INTERN_INIT_SLOTS * sizeof(str_intern_entry *);
+    pthread_mutex_init(&shard->lock, NULL);
+    arena_init(&shard->strings, 0, allocator);
+  }
+  return tbl;
+}
+
+/**
+ * @brief: 销毁字符串驻留表，之前返回的字符串全部失效
+ * @param tbl: 驻留表指针，可为 NULL
+ */
+void str_intern_destroy(str_intern *tbl) {
+  str_intern_shard *shard;
+  str_intern_table *table;
+  str_intern_table *next;
+  int i;
+
+  if (!tbl)
+    return;
+
+  for (i = 0; i < STR_INTERN_SHARDS; i++) {
+    shard = &tbl->shards[i];
+    /* 创建中途失败时之后的分片尚未初始化 */
+    if (!shard->table)
+      break;
+    for (table = shard->table; table; table = next) {
+      next = table->retired;
+      mem_free(tbl->allocator, table);
+    }
+    arena_destroy(&shard->strings);
+    pthread_mutex_destroy(&shard->lock);
+  }
+  mem_free(tbl->allocator, tbl);
+}
+
+/**
+ * @brief: 查找字符串，不存在时不插入，不加锁
+ * @param tbl: 驻留表指针
+ * @param s: 内容，不要求以 '\0' 结尾
+ * @param len: 内容长度
+ * @return: 返回驻留的字符串，不存在返回 NULL
+ */
+const char *str_intern_lookup(str_intern *tbl, const char *s, size_t len) {
+  uint64_t hash = fast_hash64(s, len);
+  str_intern_shard *shard =
+      &tbl->shards[hash >> (64 - STR_INTERN_SHARD_BITS)];
+  str_intern_entry *e = str_intern_probe(
+      __atomic_load_n(&shard->table, __ATOMIC_ACQUIRE), hash, s, len, NULL);
+
+  return e ? e->data : NULL;
+}
+
+/**
+ * @brief: 获取字符串的驻留副本，不存在时插入
+ * @param tbl: 驻留表指针
+ * @param s: 内容，不要求以 '\0' 结尾
+ * @param len: 内容长度
+ * @return: 返回驻留的字符串，申请内存失败返回 NULL
+ */
+const char *str_intern_get(str_intern *tbl, const char *s, size_t len) {
+  uint64_t hash = fast_hash64(s, len);
+  str_intern_shard *shard =
+      &tbl->shards[hash >> (64 - STR_INTERN_SHARD_BITS)];
+  str_intern_entry *e;
+  size_t slot;
+
+  /* 已驻留的字符串不加锁即可返回 */
+  e = str_intern_probe(__atomic_load_n(&shard->table, __ATOMIC_ACQUIRE), hash,
+                       s, len, NULL);
+  if (e)
+    return e->data;
+
+  pthread_mutex_lock(&shard->lock);
+  e = str_intern_probe(shard->table, hash, s, len, &slot);
+  if (e)
+    goto out;
+
+  if ((shard->count + 1) * 2 > shard->table->mask + 1) {
+    if (str_intern_grow(tbl, shard) != ret_ok)
+      goto out;
+    str_intern_probe(shard->table, hash, s, len, &slot);
+  }
+
+  e = (str_intern_entry *)arena_aligned_alloc(
+      &shard->strings, _Alignof(str_intern_entry),
+      sizeof(str_intern_entry) + len + 1);
+  if (!e)
+    goto out;
+  e->hash = hash;
+  e->len = len;
+  memcpy(e->data, s, len);
+  e->data[len] = '\0';
+
+  shard->count++;
+  shard->bytes += len;
+  __atomic_store_n(&shard->table->slots[slot], e, __ATOMIC_RELEASE);
+
+out:
+  pthread_mutex_unlock(&shard->lock);
+  return e ? e->data : NULL;
+}
+
+/**
+ * @brief: 获取驻留字符串的长度
+ * @param str: str_intern_get() 或 str_intern_lookup() 返回的字符串
+ * @return: 返回长度
+ */
+size_t str_intern_len(const char *str) {
+  return ((const str_intern_entry *)(str - offsetof(str_intern_entry, data)))
+      ->len;
+}
+
+/**
+ * @brief: 获取内存使用统计
+ * @param tbl: 驻留表指针
+ * @param stats: 保存统计结果
+ */
+void str_intern_get_stats(str_intern *tbl, str_intern_stats *stats) {
+  str_intern_shard *shard;
+  arena_chunk *chunk;
+  int i;
+
+  memset(stats, 0, sizeof(*stats));
+  stats->total_bytes = sizeof(str_intern);
+  for (i = 0; i < STR_INTERN_SHARDS; i++) {
+    shard = &tbl->shards[i];
+    pthread_mutex_lock(&shard->lock);
+    stats->count += shard->count;
+    stats->str_bytes += shard->bytes;
+    stats->table_bytes += shard->table_bytes;
+    for (chunk = shard->strings.first; chunk; chunk = chunk->next)
+      stats->arena_bytes += sizeof(arena_chunk) + chunk->size;
+    pthread_mutex_unlock(&shard->lock);
+  }
+  stats->total_bytes += stats->table_bytes + stats->arena_bytes;
+}
@@ -0,0 +1,220 @@
+/**
+ * @brief: 字符串对象实现文件，短字符串内联存储，长字符串按容量倍增申请堆内存
+ * @file: str_objs.c
+ * @author: moecly
+ */
+
+#define _GNU_SOURCE
+
+#include "../inc/str_util.h"
+#include <stdint.h>
+#include <string.h>
+
+static const str_ops str_objs_default_ops = {
+    .append = str_objs_append,
+    .insert = str_objs_insert,
+    .find = str_objs_find,
+    .slice = str_objs_slice,
+    .compare = str_objs_compare,
+};
+
+/**
+ * @brief: 初始化空字符串对象
+ * @param str: 字符串对象
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器
+ */
+void str_objs_init(str_objs *str, mem_allocator *allocator) {
+  str->len = 0;
+  str->cap = STR_OBJS_SSO_CAP;
+  str->data.sso[0] = '\0';
+  str->allocator = allocator;
+  str->ops = &str_objs_default_ops;
+}
+
+/**
+ * @brief: 以 src 的前 len 个字节初始化字符串对象
+ * @param str: 字符串对象
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器
+ * @param src: 初始内容
+ * @param len: 初始内容的字节数
+ * @return: 成功返回 ret_ok，申请内存失败返回 ret_err，此时 str 为空字符串
+ */
+ret_val str_objs_init_with(str_objs *str, mem_allocator *allocator,
+                           const char *src, size_t len) {
+  str_objs_init(str, allocator);
+  return str_objs_append(str, src, len);
+}
+
+/**
+ * @brief: 释放字符串对象的堆内存，之后 str 为空字符串，可继续使用
+ * @param str: 字符串对象
+ */
+void str_objs_destroy(str_objs *str) {
+  if (str->cap > STR_OBJS_SSO_CAP)
+    mem_free(str->allocator, str->data.ptr);
+  str_objs_init(str, str->allocator);
+}
+
+/**
+ * @brief: 确保容量不小于 cap，已有内容不变
+ * @param str: 字符串对象
+ * @param cap: 需要的容量，不含结尾的 '\0'
+ * @return: 成功返回 ret_ok，申请内存失败返回 ret_err
+ */
+ret_val str_objs_reserve(str_objs *str, size_t cap) {
+  size_t new_cap;
+  char *buf;
+
+  if (cap <= str->cap)
+    return ret_ok;
+  if (cap >= SIZE_MAX / 2)
+    return ret_err;
+
+  /* 按倍数增长，连续追加的均摊复杂度为 O(1) */
+  new_cap = str->cap * 2;
+  if (new_cap < cap)
+    new_cap = cap;
+
+  if (str->cap > STR_OBJS_SSO_CAP) {
+    buf = (char *)mem_realloc(str->allocator, str->data.ptr, new_cap + 1);
+    if (!buf)
+      return ret_err;
+  } else {
+    buf = (char *)mem_alloc(str->allocator, new_cap + 1);
+    if (!buf)
+      return ret_err;
+    memcpy(buf, str->data.sso, str->len + 1);
+  }
+  str->data.ptr = buf;
+  str->cap = new_cap;
+  return ret_ok;
+}
+
+/**
+ * @brief: 清空内容，保留已申请的容量
+ * @param str: 字符串对象
+ */
+void str_objs_clear(str_objs *str) {
+  str->len = 0;
+  STR_OBJS_DATA(str)[0] = '\0';
+}
+
+/**
+ * @brief: 将 src 的前 len 个字节追加到末尾，src 可指向 str 自身的内容
+ * @param str: 字符串对象
+ * @param src: 追加的内容
+ * @param len: 追加的字节数
+ * @return: 成功返回 ret_ok，申请内存失败返回 ret_err，此时内容不变
+ */
+ret_val str_objs_append(str_objs *str, const char *src, size_t len) {
+  return str_objs_insert(str, str->len, src, len);
+}
+
+/**
+ * @brief: 将 src 的前 len 个字节插入到 pos 处，src 可指向 str 自身的内容
+ * @param str: 字符串对象
+ * @param pos: 插入位置，不大于当前长度
+ * @param src: 插入的内容
+ * @param len: 插入的字节数
+ * @return: 成功返回 ret_ok，pos 越界或申请内存失败返回 ret_err，此时内容不变
+ */
+ret_val str_objs_insert(str_objs *str, size_t pos, const char *src,
+                        size_t len) {
+  const char *old = STR_OBJS_DATA(str);
+  size_t off = 0;
+  int self = 0;
+  char *buf;
+  size_t head;
+
+  if (pos > str->len || len > SIZE_MAX / 2 - str->len)
+    return ret_err;
+  if (!len)
+    return ret_ok;
+
+  /* 扩容可能移动内容，自身内容先记录偏移 */
+  if (src >= old && src < old + str->len) {
+    self = 1;
+    off = (size_t)(src - old);
+  }
+  if (str_objs_reserve(str, str->len + len) != ret_ok)
+    return ret_err;
+
+  buf = STR_OBJS_DATA(str);
+  memmove(buf + pos + len, buf + pos, str->len - pos + 1);
+
+  if (!self) {
+    memcpy(buf + pos, src, len);
+  } else if (off + len <= pos) {
+    memcpy(buf + pos, buf + off, len);
+  } else if (off >= pos) {
+    /* 源内容整体位于插入点之后，已随之后移 len 个字节 */
+    memcpy(buf + pos, buf + off + len, len);
+  } else {
+    /* 源内容跨越插入点，前半段未移动，后半段已后移 */
+    head = pos - off;
+    memcpy(buf + pos, buf + off, head);
+    memcpy(buf + pos + head, buf + pos + len, len - head);
+  }
+  str->len += len;
+  return ret_ok;
+}
+
+/**
+ * @brief: 从 from 处开始查找子串
+ * @param str: 字符串对象
+ * @param from: 开始查找的位置
+ * @param needle: 子串
+ * @param len: 子串的字节数，为 0 时在 from 不越界时返回 from
+ * @return: 返回子串首次出现的位置，未找到返回 STR_OBJS_NPOS
+ */
+size_t str_objs_find(const str_objs *str, size_t from, const char *needle,
+                     size_t len) {
+  const char *buf = STR_OBJS_DATA(str);
+  const char *hit;
+
+  if (from > str->len || len > str->len - from)
+    return STR_OBJS_NPOS;
+  if (!len)
+    return from;
+
+  if (len == 1)
+    hit = (const char *)memchr(buf + from, *needle, str->len - from);
+  else
+    hit = (const char *)memmem(buf + from, str->len - from, needle, len);
+  return hit ? (size_t)(hit - buf) : STR_OBJS_NPOS;
+}
+
+/**
+ * @brief: 将从 pos 开始的 len 个字节复制到新的字符串对象，超出末尾的部分忽略
+ * @param str: 字符串对象
+ * @param pos: 起始位置，不大于当前长度
+ * @param len: 字节数
+ * @param out: 未初始化的字符串对象，使用与 str 相同的分配器初始化
+ * @return: 成功返回 ret_ok，pos 越界或申请内存失败返回 ret_err，此时 out
+ * 为空字符串
+ */
+ret_val str_objs_slice(const str_objs *str, size_t pos, size_t len,
+                       str_objs *out) {
+  str_objs_init(out, str->allocator);
+  if (pos > str->len)
+    return ret_err;
+  if (len > str->len - pos)
+    len = str->len - pos;
+  return str_objs_append(out, STR_OBJS_DATA(str) + pos, len);
+}
+
+/**
+ * @brief: 按字节比较字符串对象与 other 的前 len 个字节，较短者为前缀时较短者小
+ * @param str: 字符串对象
+ * @param other: 比较的内容
+ * @param len: 比较内容的字节数
+ * @return: str 小于、等于、大于 other 时分别返回负数、0、正数
+ */
+int str_objs_compare(const str_objs *str, const char *other, size_t len) {
+  size_t n = str->len < len ? str->len : len;
+  int ret = n ? memcmp(STR_OBJS_DATA(str), other, n) : 0;
+
+  if (ret)
+    return ret;
+  return (str->len > len) - (str->len < len);
+}
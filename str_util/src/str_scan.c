@@ -0,0 +1,467 @@
+/**
+ * @brief: 字符串扫描实现文件，提供多字节查找、切分、按行遍历和去除空白
+ * @file: str_scan.c
+ * @author: moecly
+ *
+ * 查找和跳过空白的内核按 CPU 支持的指令集分派：x86 依次选择 AVX2、SSE4.2，
+ * aarch64 使用 NEON，均不支持时使用标量实现。各内核只处理完整的向量块，
+ * 剩余不足一块的部分交给标量实现，不会读取输入范围之外的内存。
+ */
+
+#include "../inc/str_util.h"
+#include "../../common/inc/cpu_features.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STR_SCAN_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define STR_SCAN_NEON
+#endif
+
+/* 向量内核支持的最大字节集合大小，更大的集合使用标量实现 */
+#define STR_SCAN_SET_MAX 16
+
+/**
+ * @brief: 查找用的字节集合，同时保存字节列表和 256 位的位图
+ */
+typedef struct {
+  char bytes[STR_SCAN_SET_MAX]; /* 字节列表，向量内核使用 */
+  size_t n;                     /* 字节数，超过 STR_SCAN_SET_MAX 时只用位图 */
+  uint64_t bitmap[4];           /* 位图，标量实现使用 */
+} str_scan_set;
+
+/**
+ * @brief: 按指令集实现的扫描内核
+ */
+typedef struct {
+  const char *(*find_any)(const char *p, const char *end,
+                          const str_scan_set *set); /* 查找集合中的字节 */
+  const char *(*skip_space)(const char *p,
+                            const char *end); /* 跳过开头的空白 */
+  const char *(*rskip_space)(const char *begin,
+                             const char *p); /* 跳过末尾的空白 */
+} str_scan_kernels;
+
+/**
+ * @brief: 初始化字节集合
+ * @param set: 字节集合
+ * @param bytes: 字节列表
+ * @param n: 字节数
+ */
+static void str_scan_set_init(str_scan_set *set, const char *bytes, size_t n) {
+  size_t i;
+  unsigned char c;
+
+  memset(set, 0, sizeof(*set));
+  set->n = n;
+  for (i = 0; i < n; i++) {
+    c = (unsigned char)bytes[i];
+    set->bitmap[c >> 6] |= 1ULL << (c & 63);
+    if (i < STR_SCAN_SET_MAX)
+      set->bytes[i] = bytes[i];
+  }
+}
+
+/**
+ * @brief: 判断字节是否属于集合
+ */
+static inline int str_scan_set_has(const str_scan_set *set, char c) {
+  unsigned char u = (unsigned char)c;
+
+  return (int)((set->bitmap[u >> 6] >> (u & 63)) & 1);
+}
+
+/**
+ * @brief: 判断字节是否为空白，空白为 ' '、'\t'、'\n'、'\v'、'\f'、'\r'
+ */
+static inline int str_scan_is_space(char c) {
+  return c == ' ' || (unsigned char)(c - '\t') < 5;
+}
+
+/**
+ * @brief: 标量查找实现
+ */
+static const char *str_scan_find_any_scalar(const char *p, const char *end,
+                                            const str_scan_set *set) {
+  for (; p < end; p++) {
+    if (str_scan_set_has(set, *p))
+      return p;
+  }
+  return NULL;
+}
+
+/**
+ * @brief: 标量跳过开头空白实现
+ */
+static const char *str_scan_skip_space_scalar(const char *p, const char *end) {
+  while (p < end && str_scan_is_space(*p))
+    p++;
+  return p;
+}
+
+/**
+ * @brief: 标量跳过末尾空白实现
+ */
+static const char *str_scan_rskip_space_scalar(const char *begin,
+                                               const char *p) {
+  while (p > begin && str_scan_is_space(p[-1]))
+    p--;
+  return p;
+}
+
+#ifdef STR_SCAN_X86
+/* pcmpestri 使用的空白字节 */
+static const char str_scan_spaces[16] = " \t\n\v\f\r";
+
+/**
+ * @brief: SSE4.2 查找实现，每块 16 字节由一条 pcmpestri 完成比较和定位
+ */
+__attribute__((target("sse4.2"))) static const char *
+str_scan_find_any_sse42(const char *p, const char *end,
+                        const str_scan_set *set) {
+  const __m128i needles = _mm_loadu_si128((const __m128i *)set->bytes);
+  int idx;
+
+  for (; end - p >= 16; p += 16) {
+    idx = _mm_cmpestri(needles, (int)set->n,
+                       _mm_loadu_si128((const __m128i *)p), 16,
+                       _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY |
+                           _SIDD_LEAST_SIGNIFICANT);
+    if (idx < 16)
+      return p + idx;
+  }
+  return str_scan_find_any_scalar(p, end, set);
+}
+
+/**
+ * @brief: SSE4.2 跳过开头空白实现，取反极性后定位首个非空白字节
+ */
+__attribute__((target("sse4.2"))) static const char *
+str_scan_skip_space_sse42(const char *p, const char *end) {
+  const __m128i spaces = _mm_loadu_si128((const __m128i *)str_scan_spaces);
+  int idx;
+
+  for (; end - p >= 16; p += 16) {
+    idx = _mm_cmpestri(spaces, 6, _mm_loadu_si128((const __m128i *)p), 16,
+                       _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY |
+                           _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT);
+    if (idx < 16)
+      return p + idx;
+  }
+  return str_scan_skip_space_scalar(p, end);
+}
+
+/**
+ * @brief: SSE4.2 跳过末尾空白实现，从末尾向前定位最后一个非空白字节
+ */
+__attribute__((target("sse4.2"))) static const char *
+str_scan_rskip_space_sse42(const char *begin, const char *p) {
+  const __m128i spaces = _mm_loadu_si128((const __m128i *)str_scan_spaces);
+  int idx;
+
+  for (; p - begin >= 16; p -= 16) {
+    idx = _mm_cmpestri(spaces, 6, _mm_loadu_si128((const __m128i *)(p - 16)),
+                       16,
+                       _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY |
+                           _SIDD_NEGATIVE_POLARITY | _SIDD_MOST_SIGNIFICANT);
+    if (idx < 16)
+      return p - 16 + idx + 1;
+  }
+  return str_scan_rskip_space_scalar(begin, p);
+}
+
+/**
+ * @brief: AVX2 空白判断，返回 32 个字节中空白字节的位掩码
+ */
+__attribute__((target("avx2"))) static inline uint32_t
+str_scan_space_mask_avx2(__m256i v) {
+  __m256i ctrl = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+  __m256i ws = _mm256_or_si256(
+      _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+      _mm256_cmpeq_epi8(_mm256_min_epu8(ctrl, _mm256_set1_epi8(4)), ctrl));
+
+  return (uint32_t)_mm256_movemask_epi8(ws);
+}
+
+/**
+ * @brief: AVX2 查找实现，每块 32 字节与集合中的每个字节比较后合并
+ */
+__attribute__((target("avx2"))) static const char *
+str_scan_find_any_avx2(const char *p, const char *end,
+                       const str_scan_set *set) {
+  __m256i needles[STR_SCAN_SET_MAX];
+  __m256i chunk;
+  __m256i hit;
+  uint32_t mask;
+  size_t i;
+
+  for (i = 0; i < set->n; i++)
+    needles[i] = _mm256_set1_epi8(set->bytes[i]);
+
+  for (; end - p >= 32; p += 32) {
+    chunk = _mm256_loadu_si256((const __m256i *)p);
+    hit = _mm256_cmpeq_epi8(chunk, needles[0]);
+    for (i = 1; i < set->n; i++)
+      hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(chunk, needles[i]));
+    mask = (uint32_t)_mm256_movemask_epi8(hit);
+    if (mask)
+      return p + __builtin_ctz(mask);
+  }
+  return str_scan_find_any_scalar(p, end, set);
+}
+
+/**
+ * @brief: AVX2 跳过开头空白实现
+ */
+__attribute__((target("avx2"))) static const char *
+str_scan_skip_space_avx2(const char *p, const char *end) {
+  uint32_t mask;
+
+  for (; end - p >= 32; p += 32) {
+    mask = ~str_scan_space_mask_avx2(_mm256_loadu_si256((const __m256i *)p));
+    if (mask)
+      return p + __builtin_ctz(mask);
+  }
+  return str_scan_skip_space_scalar(p, end);
+}
+
+/**
+ * @brief: AVX2 跳过末尾空白实现
+ */
+__attribute__((target("avx2"))) static const char *
+str_scan_rskip_space_avx2(const char *begin, const char *p) {
+  uint32_t mask;
+
+  for (; p - begin >= 32; p -= 32) {
+    mask = ~str_scan_space_mask_avx2(
+        _mm256_loadu_si256((const __m256i *)(p - 32)));
+    if (mask)
+      return p - __builtin_clz(mask);
+  }
+  return str_scan_rskip_space_scalar(begin, p);
+}
+#endif // STR_SCAN_X86
+
+#ifdef STR_SCAN_NEON
+/**
+ * @brief: NEON 空白判断，空白字节对应的通道为 0xFF
+ */
+static inline uint8x16_t str_scan_space_neon(uint8x16_t v) {
+  return vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')),
+                  vcltq_u8(vsubq_u8(v, vdupq_n_u8('\t')), vdupq_n_u8(5)));
+}
+
+/**
+ * @brief: NEON 查找实现，块内有匹配时再逐字节定位
+ */
+static const char *str_scan_find_any_neon(const char *p, const char *end,
+                                          const str_scan_set *set) {
+  uint8x16_t chunk;
+  uint8x16_t hit;
+  size_t i;
+
+  for (; end - p >= 16; p += 16) {
+    chunk = vld1q_u8((const uint8_t *)p);
+    hit = vceqq_u8(chunk, vdupq_n_u8((uint8_t)set->bytes[0]));
+    for (i = 1; i < set->n; i++)
+      hit = vorrq_u8(hit, vceqq_u8(chunk, vdupq_n_u8((uint8_t)set->bytes[i])));
+    if (vmaxvq_u8(hit))
+      return str_scan_find_any_scalar(p, p + 16, set);
+  }
+  return str_scan_find_any_scalar(p, end, set);
+}
+
+/**
+ * @brief: NEON 跳过开头空白实现
+ */
+static const char *str_scan_skip_space_neon(const char *p, const char *end) {
+  for (; end - p >= 16; p += 16) {
+    if (vminvq_u8(str_scan_space_neon(vld1q_u8((const uint8_t *)p))) == 0)
+      return str_scan_skip_space_scalar(p, p + 16);
+  }
+  return str_scan_skip_space_scalar(p, end);
+}
+
+/**
+ * @brief: NEON 跳过末尾空白实现
+ */
+static const char *str_scan_rskip_space_neon(const char *begin,
+                                             const char *p) {
+  for (; p - begin >= 16; p -= 16) {
+    if (vminvq_u8(str_scan_space_neon(vld1q_u8((const uint8_t *)(p - 16)))) ==
+        0)
+      return str_scan_rskip_space_scalar(p - 16, p);
+  }
+  return str_scan_rskip_space_scalar(begin, p);
+}
+#endif // STR_SCAN_NEON
+
+static const str_scan_kernels str_scan_kernels_scalar = {
+    str_scan_find_any_scalar, str_scan_skip_space_scalar,
+    str_scan_rskip_space_scalar};
+
+#ifdef STR_SCAN_X86
+static const str_scan_kernels str_scan_kernels_sse42 = {
+    str_scan_find_any_sse42, str_scan_skip_space_sse42,
+    str_scan_rskip_space_sse42};
+static const str_scan_kernels str_scan_kernels_avx2 = {
+    str_scan_find_any_avx2, str_scan_skip_space_avx2,
+    str_scan_rskip_space_avx2};
+#endif // STR_SCAN_X86
+
+#ifdef STR_SCAN_NEON
+static const str_scan_kernels str_scan_kernels_neon = {
+    str_scan_find_any_neon, str_scan_skip_space_neon,
+    str_scan_rskip_space_neon};
+#endif // STR_SCAN_NEON
+
+/* 按优先级排列的扫描内核 */
+static const cpu_dispatch_entry str_scan_dispatch[] = {
+#ifdef STR_SCAN_X86
+    {CPU_FEATURE_AVX2, &str_scan_kernels_avx2},
+    {CPU_FEATURE_SSE42, &str_scan_kernels_sse42},
+#endif
+#ifdef STR_SCAN_NEON
+    {CPU_FEATURE_NEON, &str_scan_kernels_neon},
+#endif
+    {0, &str_scan_kernels_scalar},
+};
+
+static const str_scan_kernels *kernels = NULL;
+
+/**
+ * @brief: 按 CPU 支持的指令集选择扫描内核，首次调用时确定
+ * @return: 返回内核函数表指针
+ */
+static inline const str_scan_kernels *str_scan_get_kernels(void) {
+  return CPU_DISPATCH(kernels, str_scan_dispatch);
+}
+
+/**
+ * @brief: 在字节集合中查找，单个字节时使用 memchr()
+ * @param p: 起始位置
+ * @param end: 结束位置
+ * @param set: 字节集合
+ * @return: 返回首个匹配的位置，未找到返回 NULL
+ */
+static inline const char *str_scan_find(const char *p, const char *end,
+                                        const str_scan_set *set) {
+  if (set->n == 1)
+    return (const char *)memchr(p, set->bytes[0], (size_t)(end - p));
+  if (set->n > STR_SCAN_SET_MAX)
+    return str_scan_find_any_scalar(p, end, set);
+  return str_scan_get_kernels()->find_any(p, end, set);
+}
+
+/**
+ * @brief: 查找首个属于 set 的字节
+ * @param s: 输入
+ * @param len: 输入长度
+ * @param set: 字节集合
+ * @param nset: 集合的字节数
+ * @return: 返回首个匹配字节的位置，未找到返回 NULL
+ */
+const char *str_find_any(const char *s, size_t len, const char *set,
+                         size_t nset) {
+  str_scan_set scan;
+
+  if (!len || !nset)
+    return NULL;
+  str_scan_set_init(&scan, set, nset);
+  return str_scan_find(s, s + len, &scan);
+}
+
+/**
+ * @brief: 按 delims 中的任一字节切分输入，视图指向输入本身，不复制内容
+ * @param s: 输入
+ * @param len: 输入长度
+ * @param delims: 分隔字节集合
+ * @param ndelims: 分隔字节数
+ * @param views: 保存字段的视图数组
+ * @param max_views: 视图数组的长度
+ * @return: 返回写入的视图数
+ */
+size_t str_split(const char *s, size_t len, const char *delims,
+                 size_t ndelims, str_view *views, size_t max_views) {
+  const char *end = s + len;
+  const char *hit;
+  str_scan_set scan;
+  size_t n = 0;
+
+  if (!max_views)
+    return 0;
+  str_scan_set_init(&scan, delims, ndelims);
+
+  while (n + 1 < max_views && ndelims &&
+         (hit = str_scan_find(s, end, &scan)) != NULL) {
+    views[n].ptr = s;
+    views[n].len = (size_t)(hit - s);
+    n++;
+    s = hit + 1;
+  }
+
+  /* 最后一个字段，视图数组已满时包含剩余的全部内容 */
+  views[n].ptr = s;
+  views[n].len = (size_t)(end - s);
+  return n + 1;
+}
+
+/**
+ * @brief: 初始化行遍历器
+ * @param it: 行遍历器
+ * @param s: 输入
+ * @param len: 输入长度
+ */
+void str_line_iter_init(str_line_iter *it, const char *s, size_t len) {
+  it->cur = s;
+  it->end = s + len;
+}
+
+/**
+ * @brief: 获取下一行，结果不含行尾的 "\n" 或 "\r\n"
+ * @param it: 行遍历器
+ * @param line: 保存行的视图
+ * @return: 获取到一行返回 1，已到末尾返回 0
+ */
+int str_line_next(str_line_iter *it, str_view *line) {
+  const char *p = it->cur;
+  const char *nl;
+
+  if (p >= it->end)
+    return 0;
+
+  line->ptr = p;
+  nl = (const char *)memchr(p, '\n', (size_t)(it->end - p));
+  if (!nl) {
+    /* 最后一行没有换行符 */
+    line->len = (size_t)(it->end - p);
+    it->cur = it->end;
+    return 1;
+  }
+
+  it->cur = nl + 1;
+  if (nl > p && nl[-1] == '\r')
+    nl--;
+  line->len = (size_t)(nl - p);
+  return 1;
+}
+
+/**
+ * @brief: 去除开头和末尾的空白，空白为 ' '、'\t'、'\n'、'\v'、'\f'、'\r'
+ * @param s: 输入
+ * @param len: 输入长度
+ * @return: 返回去除空白后的视图
+ */
+str_view str_trim(const char *s, size_t len) {
+  const str_scan_kernels *k = str_scan_get_kernels();
+  const char *end = s + len;
+  str_view ret;
+
+  s = k->skip_space(s, end);
+  end = k->rskip_space(s, end);
+  ret.ptr = s;
+  ret.len = (size_t)(end - s);
+  return ret;
+}
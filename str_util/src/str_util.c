@@ -11,6 +11,31 @@
  * @param str: 存储转换结果的字符串
  * @param num: 要转换的整数
  */
-void int_num_to_str(char *str, int num) {
-  sprintf(str, "%d", num); /* 将数字转换为字符串 */
+void int_num_to_str(char *str, int num) { str_fmt_i32(str, num); }
+
+/**
+ * @brief: 通过分配器复制字符串
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器
+ * @param str: 要复制的字符串
+ * @return: 返回新字符串，失败返回 NULL
+ */
+char *str_dup(mem_allocator *allocator, const char *str) {
+  return str_ndup(allocator, str, strlen(str));
+}
+
+/**
+ * @brief: 通过分配器复制字符串的前 len 个字节，结果以 '\0' 结尾
+ * @param allocator: 内存分配器指针，为 NULL 时使用默认分配器
+ * @param str: 要复制的字符串
+ * @param len: 要复制的字节数
+ * @return: 返回新字符串，失败返回 NULL
+ */
+char *str_ndup(mem_allocator *allocator, const char *str, size_t len) {
+  char *ret = (char *)mem_alloc(allocator, len + 1);
+  if (!ret)
+    return NULL;
+
+  memcpy(ret, str, len);
+  ret[len] = '\0';
+  return ret;
 }
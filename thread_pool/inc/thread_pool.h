@@ -0,0 +1,143 @@
+/**
+ * @file thread_pool.h
+ * @brief 线程池头文件，每个工作线程持有一个 Chase-Lev 工作窃取双端队列
+ * @author moecly
+ */
+
+#ifndef __THREAD_POOL_H_
+#define __THREAD_POOL_H_
+
+#include "../../common/inc/common.h"
+#include "../../list/inc/ilist.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef LINUX_OS
+#define LINUX_OS
+#endif // !LINUX_OS
+
+/**
+ * @brief 任务函数
+ */
+typedef void (*thread_task_func)(void *arg);
+
+/**
+ * @brief 区间任务函数，处理 [begin, end) 范围内的下标
+ */
+typedef void (*thread_range_func)(void *arg, size_t begin, size_t end);
+
+/**
+ * @brief 任务结构体，由调用者持有，在 join 返回前必须保持有效
+ */
+typedef struct thread_task {
+  thread_task_func func; /**< 任务函数 */
+  void *arg;             /**< 任务参数 */
+  int done;              /**< 任务是否已完成 */
+  ilist_node link;       /**< 挂入线程池全局队列的节点 */
+} thread_task;
+
+/**
+ * @brief 线程池，具体结构由平台实现定义
+ */
+typedef struct thread_pool thread_pool;
+
+/**
+ * @brief 线程池操作函数指针结构体
+ */
+typedef struct thread_pool_operations {
+  ret_val (*create)(thread_pool **pool, uint32_t workers); /**< 创建线程池 */
+  ret_val (*submit)(thread_pool *pool, thread_task *task); /**< 提交任务 */
+  ret_val (*join)(thread_pool *pool, thread_task *task);   /**< 等待任务完成 */
+  ret_val (*destroy)(thread_pool *pool);                   /**< 销毁线程池 */
+  uint32_t (*get_workers)(thread_pool *pool); /**< 获取工作线程数 */
+} thread_pool_operations;
+
+/**
+ * @brief 初始化线程池操作
+ *
+ * @return 初始化结果
+ */
+ret_val thread_pool_ops_init(void);
+
+/**
+ * @brief 重置线程池操作
+ *
+ * @return 重置结果
+ */
+ret_val thread_pool_ops_reset(void);
+
+/**
+ * @brief 初始化任务
+ *
+ * @param task 任务结构体指针
+ * @param func 任务函数
+ * @param arg 任务参数
+ */
+void thread_task_init(thread_task *task, thread_task_func func, void *arg);
+
+/**
+ * @brief 判断任务是否已完成
+ *
+ * @param task 任务结构体指针
+ * @return 已完成返回 1，否则返回 0
+ */
+int thread_task_done(thread_task *task);
+
+/**
+ * @brief 创建线程池
+ *
+ * @param workers 工作线程数，为 0 时使用在线 CPU 数
+ * @return 线程池指针，失败返回 NULL
+ */
+thread_pool *thread_pool_create(uint32_t workers);
+
+/**
+ * @brief 提交任务，工作线程内提交的任务进入本线程的双端队列
+ *
+ * @param pool 线程池指针
+ * @param task 任务结构体指针
+ * @return 提交结果
+ */
+ret_val thread_pool_submit(thread_pool *pool, thread_task *task);
+
+/**
+ * @brief 等待任务完成，等待期间当前线程会执行或窃取其他任务
+ *
+ * @param pool 线程池指针
+ * @param task 任务结构体指针
+ * @return 等待结果
+ */
+ret_val thread_pool_join(thread_pool *pool, thread_task *task);
+
+/**
+ * @brief 并行处理 [begin, end) 范围，区间不断二分直到不超过 grain
+ *
+ * @param pool 线程池指针
+ * @param begin 起始下标
+ * @param end 结束下标（不包含）
+ * @param grain 单个任务处理的最大区间长度，为 0 时按 1 处理
+ * @param func 区间任务函数
+ * @param arg 区间任务参数
+ * @return 执行结果
+ */
+ret_val thread_pool_parallel_for(thread_pool *pool, size_t begin, size_t end,
+                                 size_t grain, thread_range_func func,
+                                 void *arg);
+
+/**
+ * @brief 获取线程池的工作线程数
+ *
+ * @param pool 线程池指针
+ * @return 工作线程数
+ */
+uint32_t thread_pool_get_workers(thread_pool *pool);
+
+/**
+ * @brief 销毁线程池，调用前应等待所有已提交的任务完成
+ *
+ * @param pool 线程池指针
+ * @return 销毁结果
+ */
+ret_val thread_pool_destroy(thread_pool *pool);
+
+#endif // !__THREAD_POOL_H_
@@ -0,0 +1,20 @@
+/**
+ * @file linux_thread_pool.h
+ * @brief Linux线程池头文件
+ * @author moecly
+ */
+
+#ifndef __LINUX_THREAD_POOL_H_
+#define __LINUX_THREAD_POOL_H_
+
+#include "../../inc/thread_pool.h"
+
+/**
+ * @brief 初始化Linux线程池操作
+ *
+ * @param ops 用于存储Linux线程池操作函数指针的结构体指针
+ * @return 初始化结果
+ */
+ret_val linux_thread_pool_ops_init(thread_pool_operations **ops);
+
+#endif // !__LINUX_THREAD_POOL_H_
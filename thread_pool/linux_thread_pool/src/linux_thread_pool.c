@@ -0,0 +1,439 @@
+/**
+ * @file linux_thread_pool.c
+ * @brief Linux线程池实现文件，基于 pthread 和 Chase-Lev 工作窃取双端队列
+ * @author moecly
+ */
+
+#include "../inc/linux_thread_pool.h"
+#include "c-utils/common/inc/common.h"
+#include "stdlib.h"
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+/* 每个工作线程双端队列的容量，需为 2 的幂 */
+#ifndef THREAD_POOL_DEQUE_SIZE
+#define THREAD_POOL_DEQUE_SIZE 1024
+#endif // !THREAD_POOL_DEQUE_SIZE
+
+/* 缓存行大小，用于隔离双端队列的 top 和 bottom */
+#ifndef THREAD_POOL_CACHE_LINE
+#define THREAD_POOL_CACHE_LINE 64
+#endif // !THREAD_POOL_CACHE_LINE
+
+/**
+ * @brief Chase-Lev 工作窃取双端队列
+ *
+ * 所属线程在 bottom 端压入和取出，其他线程在 top 端窃取。
+ */
+typedef struct {
+  int64_t top; /**< 窃取端 */
+  char top_pad[THREAD_POOL_CACHE_LINE - sizeof(int64_t)];
+  int64_t bottom; /**< 所属线程端 */
+  char bottom_pad[THREAD_POOL_CACHE_LINE - sizeof(int64_t)];
+  thread_task *buf[THREAD_POOL_DEQUE_SIZE]; /**< 任务槽位 */
+} ws_deque;
+
+/**
+ * @brief 工作线程
+ */
+typedef struct {
+  ws_deque deque;           /**< 本线程的双端队列 */
+  struct thread_pool *pool; /**< 所属线程池 */
+  pthread_t tid;            /**< 线程ID */
+  uint32_t seed;            /**< 选择窃取对象的随机种子 */
+} thread_worker;
+
+/**
+ * @brief Linux线程池
+ */
+struct thread_pool {
+  thread_worker *workers; /**< 工作线程数组 */
+  uint32_t nworkers;      /**< 工作线程数 */
+  pthread_mutex_t lock;   /**< 保护全局队列和休眠等待 */
+  pthread_cond_t cond;    /**< 唤醒休眠的工作线程 */
+  pthread_cond_t done;    /**< 唤醒等待任务完成的非工作线程 */
+  ilist inject;           /**< 非工作线程提交任务的全局队列 */
+  uint32_t inject_len;    /**< 全局队列长度 */
+  int32_t pending;        /**< 已提交但尚未开始执行的任务数 */
+  uint32_t sleepers;      /**< 正在休眠的工作线程数 */
+  uint32_t joiners;       /**< 正在阻塞等待任务完成的线程数 */
+  int stop;               /**< 是否停止工作线程 */
+};
+
+/* 当前线程对应的工作线程，非工作线程为 NULL */
+static __thread thread_worker *current_worker = NULL;
+
+/**
+ * @brief 所属线程将任务压入双端队列底部
+ *
+ * @param dq 双端队列指针
+ * @param task 任务结构体指针
+ * @return 成功返回 ret_ok，队列已满返回 ret_err
+ */
+static ret_val ws_deque_push(ws_deque *dq, thread_task *task) {
+  int64_t b = __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED);
+  int64_t t = __atomic_load_n(&dq->top, __ATOMIC_ACQUIRE);
+
+  if (b - t >= THREAD_POOL_DEQUE_SIZE)
+    return ret_err;
+
+  __atomic_store_n(&dq->buf[b & (THREAD_POOL_DEQUE_SIZE - 1)], task,
+                   __ATOMIC_RELAXED);
+  __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELEASE);
+  return ret_ok;
+}
+
+/**
+ * @brief 所属线程从双端队列底部取出任务
+ *
+ * @param dq 双端队列指针
+ * @return 任务结构体指针，队列为空返回 NULL
+ */
+static thread_task *ws_deque_take(ws_deque *dq) {
+  int64_t b = __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED) - 1;
+  int64_t t;
+  thread_task *task = NULL;
+
+  /* bottom 的写入必须先于 top 的读取对窃取者可见 */
+  __atomic_store_n(&dq->bottom, b, __ATOMIC_SEQ_CST);
+  t = __atomic_load_n(&dq->top, __ATOMIC_SEQ_CST);
+
+  if (t > b) {
+    __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELAXED);
+    return NULL;
+  }
+
+  task = __atomic_load_n(&dq->buf[b & (THREAD_POOL_DEQUE_SIZE - 1)],
+                         __ATOMIC_RELAXED);
+  if (t == b) {
+    /* 只剩最后一个任务，与窃取者竞争 */
+    if (!__atomic_compare_exchange_n(&dq->top, &t, t + 1, 0, __ATOMIC_SEQ_CST,
+                                     __ATOMIC_RELAXED))
+      task = NULL;
+    __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELAXED);
+  }
+  return task;
+}
+
+/**
+ * @brief 其他线程从双端队列顶部窃取任务
+ *
+ * @param dq 双端队列指针
+ * @return 任务结构体指针，队列为空或竞争失败返回 NULL
+ */
+static thread_task *ws_deque_steal(ws_deque *dq) {
+  int64_t t = __atomic_load_n(&dq->top, __ATOMIC_SEQ_CST);
+  int64_t b = __atomic_load_n(&dq->bottom, __ATOMIC_SEQ_CST);
+  thread_task *task;
+
+  if (t >= b)
+    return NULL;
+
+  task = __atomic_load_n(&dq->buf[t & (THREAD_POOL_DEQUE_SIZE - 1)],
+                         __ATOMIC_RELAXED);
+  if (!__atomic_compare_exchange_n(&dq->top, &t, t + 1, 0, __ATOMIC_SEQ_CST,
+                                   __ATOMIC_RELAXED))
+    return NULL;
+  return task;
+}
+
+/**
+ * @brief 查找一个可执行的任务：本线程队列、全局队列、其他线程队列
+ *
+ * @param pool 线程池指针
+ * @param self 当前工作线程，非工作线程为 NULL
+ * @return 任务结构体指针，没有可执行任务返回 NULL
+ */
+static thread_task *thread_pool_find_task(struct thread_pool *pool,
+                                          thread_worker *self) {
+  thread_task *task;
+  ilist_node *nd = NULL;
+  uint32_t start;
+  uint32_t i;
+
+  if (self) {
+    task = ws_deque_take(&self->deque);
+    if (task)
+      return task;
+  }
+
+  if (__atomic_load_n(&pool->inject_len, __ATOMIC_ACQUIRE)) {
+    pthread_mutex_lock(&pool->lock);
+    nd = ilist_pop_from_head(&pool->inject);
+    if (nd)
+      __atomic_fetch_sub(&pool->inject_len, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&pool->lock);
+    if (nd)
+      return ILIST_ENTRY(nd, thread_task, link);
+  }
+
+  /* 从随机位置开始依次尝试窃取 */
+  start = 0;
+  if (self) {
+    self->seed = self->seed * 1664525u + 1013904223u;
+    start = self->seed >> 16;
+  }
+  for (i = 0; i < pool->nworkers; i++) {
+    thread_worker *victim = &pool->workers[(start + i) % pool->nworkers];
+    if (victim == self)
+      continue;
+    task = ws_deque_steal(&victim->deque);
+    if (task)
+      return task;
+  }
+  return NULL;
+}
+
+/**
+ * @brief 执行任务并标记完成
+ *
+ * @param pool 线程池指针
+ * @param task 任务结构体指针
+ */
+static void thread_pool_run_task(struct thread_pool *pool, thread_task *task) {
+  __atomic_fetch_sub(&pool->pending, 1, __ATOMIC_RELAXED);
+  task->func(task->arg);
+
+  /* 标记完成后任务可能已被释放，之后只访问线程池。先写完成标志再检查等待
+   * 者数，与等待者的检查顺序相反，不会丢失唤醒 */
+  __atomic_store_n(&task->done, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&pool->joiners, __ATOMIC_SEQ_CST)) {
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_broadcast(&pool->done);
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
+
+/**
+ * @brief 工作线程入口
+ *
+ * @param arg 工作线程指针
+ * @return NULL
+ */
+static void *thread_pool_worker_main(void *arg) {
+  thread_worker *self = (thread_worker *)arg;
+  struct thread_pool *pool = self->pool;
+  thread_task *task;
+
+  current_worker = self;
+  while (!__atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE)) {
+    task = thread_pool_find_task(pool, self);
+    if (task) {
+      thread_pool_run_task(pool, task);
+      continue;
+    }
+
+    /* 先登记休眠再检查任务数，与提交者的检查顺序相反，不会丢失唤醒 */
+    pthread_mutex_lock(&pool->lock);
+    __atomic_fetch_add(&pool->sleepers, 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&pool->pending, __ATOMIC_SEQ_CST) <= 0 &&
+           !__atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE))
+      pthread_cond_wait(&pool->cond, &pool->lock);
+    __atomic_fetch_sub(&pool->sleepers, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&pool->lock);
+  }
+  return NULL;
+}
+
+/**
+ * @brief 创建线程池
+ *
+ * @param pool 用于存储线程池指针
+ * @param workers 工作线程数，为 0 时使用在线 CPU 数
+ * @return 创建结果
+ */
+static ret_val thread_pool_create_handler(struct thread_pool **pool,
+                                          uint32_t workers) {
+  struct thread_pool *p;
+  long cpus;
+  uint32_t i;
+
+  if (!workers) {
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    workers = cpus > 0 ? (uint32_t)cpus : 1;
+  }
+
+  p = MALLOC_FUNC(struct thread_pool);
+  if (!p)
+    return ret_err;
+
+  p->workers = MALLOC_ARRAY_FUNC(thread_worker, workers);
+  if (!p->workers) {
+    FREE_FUNC(p);
+    return ret_err;
+  }
+
+  pthread_mutex_init(&p->lock, NULL);
+  pthread_cond_init(&p->cond, NULL);
+  pthread_cond_init(&p->done, NULL);
+  ilist_init(&p->inject);
+  p->inject_len = 0;
+  p->pending = 0;
+  p->sleepers = 0;
+  p->joiners = 0;
+  p->stop = 0;
+  p->nworkers = workers;
+
+  for (i = 0; i < workers; i++) {
+    thread_worker *w = &p->workers[i];
+    w->deque.top = 0;
+    w->deque.bottom = 0;
+    w->pool = p;
+    w->seed = i + 1;
+  }
+
+  for (i = 0; i < workers; i++) {
+    if (pthread_create(&p->workers[i].tid, NULL, thread_pool_worker_main,
+                       &p->workers[i]))
+      goto err_create;
+  }
+
+  *pool = p;
+  return ret_ok;
+
+err_create:
+  /* 停止已创建的线程 */
+  pthread_mutex_lock(&p->lock);
+  __atomic_store_n(&p->stop, 1, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&p->cond);
+  pthread_mutex_unlock(&p->lock);
+  while (i--)
+    pthread_join(p->workers[i].tid, NULL);
+
+  pthread_mutex_destroy(&p->lock);
+  pthread_cond_destroy(&p->cond);
+  pthread_cond_destroy(&p->done);
+  FREE_FUNC(p->workers);
+  FREE_FUNC(p);
+  return ret_err;
+}
+
+/**
+ * @brief 提交任务
+ *
+ * @param pool 线程池指针
+ * @param task 任务结构体指针
+ * @return 提交结果
+ */
+static ret_val thread_pool_submit_handler(struct thread_pool *pool,
+                                          thread_task *task) {
+  thread_worker *self = current_worker;
+
+  __atomic_store_n(&task->done, 0, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&pool->pending, 1, __ATOMIC_SEQ_CST);
+
+  /* 本池工作线程优先压入自己的双端队列，满了再放入全局队列 */
+  if (!self || self->pool != pool || ws_deque_push(&self->deque, task)) {
+    pthread_mutex_lock(&pool->lock);
+    ilist_push_to_tail(&pool->inject, &task->link);
+    __atomic_fetch_add(&pool->inject_len, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&pool->lock);
+  }
+
+  if (__atomic_load_n(&pool->sleepers, __ATOMIC_SEQ_CST)) {
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+  }
+  return ret_ok;
+}
+
+/**
+ * @brief 等待任务完成，等待期间执行或窃取其他任务
+ *
+ * 本池工作线程找不到任务时让出 CPU 后继续窃取，其他线程则阻塞到有任务
+ * 完成时再检查，避免长任务期间空转。
+ *
+ * @param pool 线程池指针
+ * @param task 任务结构体指针
+ * @return 等待结果
+ */
+static ret_val thread_pool_join_handler(struct thread_pool *pool,
+                                        thread_task *task) {
+  thread_worker *self = current_worker;
+  thread_task *other;
+
+  if (self && self->pool != pool)
+    self = NULL;
+
+  while (!__atomic_load_n(&task->done, __ATOMIC_ACQUIRE)) {
+    other = thread_pool_find_task(pool, self);
+    if (other) {
+      thread_pool_run_task(pool, other);
+      continue;
+    }
+    if (self) {
+      sched_yield();
+      continue;
+    }
+
+    /* 先登记等待再检查完成标志，与完成者的顺序相反，不会丢失唤醒 */
+    pthread_mutex_lock(&pool->lock);
+    __atomic_fetch_add(&pool->joiners, 1, __ATOMIC_SEQ_CST);
+    while (!__atomic_load_n(&task->done, __ATOMIC_SEQ_CST))
+      pthread_cond_wait(&pool->done, &pool->lock);
+    __atomic_fetch_sub(&pool->joiners, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&pool->lock);
+  }
+  return ret_ok;
+}
+
+/**
+ * @brief 获取线程池的工作线程数
+ *
+ * @param pool 线程池指针
+ * @return 工作线程数
+ */
+static uint32_t thread_pool_get_workers_handler(struct thread_pool *pool) {
+  return pool->nworkers;
+}
+
+/**
+ * @brief 销毁线程池
+ *
+ * @param pool 线程池指针
+ * @return 销毁结果
+ */
+static ret_val thread_pool_destroy_handler(struct thread_pool *pool) {
+  uint32_t i;
+
+  pthread_mutex_lock(&pool->lock);
+  __atomic_store_n(&pool->stop, 1, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&pool->cond);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (i = 0; i < pool->nworkers; i++)
+    pthread_join(pool->workers[i].tid, NULL);
+
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->cond);
+  pthread_cond_destroy(&pool->done);
+  FREE_FUNC(pool->workers);
+  FREE_FUNC(pool);
+  return ret_ok;
+}
+
+/**
+ * @brief 初始化Linux线程池操作
+ *
+ * @param ops 用于存储Linux线程池操作函数指针的结构体指针
+ * @return 初始化结果
+ */
+ret_val linux_thread_pool_ops_init(thread_pool_operations **ops) {
+  ret_val ret = ret_err;
+  if (*ops != NULL)
+    return ret_ok;
+
+  *ops = MALLOC_FUNC(thread_pool_operations);
+  ret = validate_pointer(*ops);
+  if (ret != ret_ok)
+    return ret;
+
+  (*ops)->create = thread_pool_create_handler;
+  (*ops)->submit = thread_pool_submit_handler;
+  (*ops)->join = thread_pool_join_handler;
+  (*ops)->destroy = thread_pool_destroy_handler;
+  (*ops)->get_workers = thread_pool_get_workers_handler;
+  return ret;
+}
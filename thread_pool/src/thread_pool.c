@@ -0,0 +1,200 @@
+/**
+ * @file thread_pool.c
+ * @brief 线程池实现文件
+ * @author moecly
+ */
+
+#include "../inc/thread_pool.h"
+#include "c-utils/common/inc/common.h"
+#include "stdlib.h"
+
+static thread_pool_operations *ops = NULL;
+
+/**
+ * @brief 并行区间任务的上下文
+ */
+typedef struct {
+  thread_pool *pool;      /**< 线程池指针 */
+  thread_range_func func; /**< 区间任务函数 */
+  void *arg;              /**< 区间任务参数 */
+  size_t begin;           /**< 起始下标 */
+  size_t end;             /**< 结束下标（不包含） */
+  size_t grain;           /**< 单个任务处理的最大区间长度 */
+} thread_range_ctx;
+
+/**
+ * @brief 初始化任务
+ *
+ * @param task 任务结构体指针
+ * @param func 任务函数
+ * @param arg 任务参数
+ */
+void thread_task_init(thread_task *task, thread_task_func func, void *arg) {
+  task->func = func;
+  task->arg = arg;
+  task->done = 0;
+  task->link.prev = NULL;
+  task->link.next = NULL;
+}
+
+/**
+ * @brief 判断任务是否已完成
+ *
+ * @param task 任务结构体指针
+ * @return 已完成返回 1，否则返回 0
+ */
+int thread_task_done(thread_task *task) {
+  return __atomic_load_n(&task->done, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief 创建线程池
+ *
+ * @param workers 工作线程数，为 0 时使用在线 CPU 数
+ * @return 线程池指针，失败返回 NULL
+ */
+thread_pool *thread_pool_create(uint32_t workers) {
+  thread_pool *pool = NULL;
+
+  if (ops->create(&pool, workers) != ret_ok)
+    return NULL;
+  return pool;
+}
+
+/**
+ * @brief 提交任务，工作线程内提交的任务进入本线程的双端队列
+ *
+ * @param pool 线程池指针
+ * @param task 任务结构体指针
+ * @return 提交结果
+ */
+ret_val thread_pool_submit(thread_pool *pool, thread_task *task) {
+  return ops->submit(pool, task);
+}
+
+/**
+ * @brief 等待任务完成，等待期间当前线程会执行或窃取其他任务
+ *
+ * @param pool 线程池指针
+ * @param task 任务结构体指针
+ * @return 等待结果
+ */
+ret_val thread_pool_join(thread_pool *pool, thread_task *task) {
+  return ops->join(pool, task);
+}
+
+/**
+ * @brief 递归二分区间，右半部分作为子任务提交，左半部分在当前线程执行
+ *
+ * @param arg 并行区间任务的上下文
+ */
+static void thread_pool_range_task(void *arg) {
+  thread_range_ctx *ctx = (thread_range_ctx *)arg;
+  thread_range_ctx right;
+  thread_range_ctx left;
+  thread_task task;
+  size_t mid;
+
+  if (ctx->end - ctx->begin <= ctx->grain) {
+    ctx->func(ctx->arg, ctx->begin, ctx->end);
+    return;
+  }
+
+  mid = ctx->begin + (ctx->end - ctx->begin) / 2;
+  right = *ctx;
+  right.begin = mid;
+  left = *ctx;
+  left.end = mid;
+
+  thread_task_init(&task, thread_pool_range_task, &right);
+  if (thread_pool_submit(ctx->pool, &task) != ret_ok) {
+    thread_pool_range_task(&left);
+    thread_pool_range_task(&right);
+    return;
+  }
+
+  thread_pool_range_task(&left);
+  thread_pool_join(ctx->pool, &task);
+}
+
+/**
+ * @brief 并行处理 [begin, end) 范围，区间不断二分直到不超过 grain
+ *
+ * @param pool 线程池指针
+ * @param begin 起始下标
+ * @param end 结束下标（不包含）
+ * @param grain 单个任务处理的最大区间长度，为 0 时按 1 处理
+ * @param func 区间任务函数
+ * @param arg 区间任务参数
+ * @return 执行结果
+ */
+ret_val thread_pool_parallel_for(thread_pool *pool, size_t begin, size_t end,
+                                 size_t grain, thread_range_func func,
+                                 void *arg) {
+  thread_range_ctx ctx;
+
+  if (begin >= end)
+    return ret_ok;
+
+  ctx.pool = pool;
+  ctx.func = func;
+  ctx.arg = arg;
+  ctx.begin = begin;
+  ctx.end = end;
+  ctx.grain = grain ? grain : 1;
+  thread_pool_range_task(&ctx);
+  return ret_ok;
+}
+
+/**
+ * @brief 获取线程池的工作线程数
+ *
+ * @param pool 线程池指针
+ * @return 工作线程数
+ */
+uint32_t thread_pool_get_workers(thread_pool *pool) {
+  return ops->get_workers(pool);
+}
+
+/**
+ * @brief 销毁线程池，调用前应等待所有已提交的任务完成
+ *
+ * @param pool 线程池指针
+ * @return 销毁结果
+ */
+ret_val thread_pool_destroy(thread_pool *pool) { return ops->destroy(pool); }
+
+/**
+ * @brief 初始化线程池操作
+ *
+ * @return 初始化结果
+ */
+ret_val thread_pool_ops_init(void) {
+  ret_val ret;
+
+  ret = validate_pointer(ops);
+  if (ret == ret_ok)
+    return ret;
+
+#ifdef LINUX_OS
+  extern ret_val linux_thread_pool_ops_init(thread_pool_operations * *ops);
+  ret = linux_thread_pool_ops_init(&ops);
+#endif
+
+  return ret;
+}
+
+/**
+ * @brief 重置线程池操作
+ *
+ * @return 重置结果
+ */
+ret_val thread_pool_ops_reset(void) {
+  ret_val ret;
+  ret = validate_pointer(ops);
+  if (ret == ret_ok) {
+    FREE_FUNC(ops);
+    ops = NULL;
+  }
+  return ret;
+}
@@ -0,0 +1,110 @@
+/**
+ * @brief: 展开链表头文件，每个链表节点保存一组按缓存行对齐的值
+ * @file: unrolled_list.h
+ * @author: moecly
+ */
+
+#ifndef __UNROLLED_LIST_H_
+#define __UNROLLED_LIST_H_
+
+#include "../../common/inc/common.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+/* 缓存行大小 */
+#ifndef ULIST_CACHE_LINE
+#define ULIST_CACHE_LINE 64
+#endif // !ULIST_CACHE_LINE
+
+/* 每个块占用的字节数，需为缓存行大小的整数倍 */
+#ifndef ULIST_CHUNK_BYTES
+#define ULIST_CHUNK_BYTES (ULIST_CACHE_LINE * 2)
+#endif // !ULIST_CHUNK_BYTES
+
+/* 每个块可保存的值的数量，块头占用两个指针和一个长度 */
+#define ULIST_CHUNK_VALS                                                       \
+  ((ULIST_CHUNK_BYTES - 2 * sizeof(void *) - sizeof(uint64_t)) /              \
+   sizeof(void *))
+
+/**
+ * @brief: 展开链表块结构定义，大小为 ULIST_CHUNK_BYTES
+ */
+typedef struct ulist_chunk {
+  struct ulist_chunk *prev;     /* 指向前一个块 */
+  struct ulist_chunk *next;     /* 指向后一个块 */
+  uint64_t count;               /* 块中保存的值的数量 */
+  void *vals[ULIST_CHUNK_VALS]; /* 块中保存的值 */
+} ulist_chunk;
+
+/**
+ * @brief: 展开链表结构定义
+ */
+typedef struct {
+  ulist_chunk *head; /* 链表头块 */
+  ulist_chunk *tail; /* 链表尾块 */
+  uint32_t len;      /* 链表中值的总数 */
+} ulist;
+
+/* 定义一个宏，用于遍历展开链表中的值，块非空，按块和块内下标单层循环 */
+#define each_val_for_ulist(val, chunk, i, list)                                \
+  for (chunk = (list)->head, i = 0; chunk && ((val = chunk->vals[i]), 1);      \
+       (void)(++i < chunk->count || (chunk = chunk->next, i = 0)))
+
+/**
+ * @brief: 创建一个新的展开链表
+ * @return: 返回一个指向新链表的指针，失败返回 NULL
+ */
+ulist *ulist_new(void);
+
+/**
+ * @brief: 释放展开链表及其全部块
+ * @param list: 链表指针
+ */
+void ulist_free(ulist *list);
+
+/**
+ * @brief: 在链表头部插入值
+ * @param list: 链表指针
+ * @param val: 要插入的值
+ * @return: 成功返回 ret_ok，内存不足返回 ret_err
+ */
+ret_val ulist_push_to_head(ulist *list, void *val);
+
+/**
+ * @brief: 在链表尾部插入值
+ * @param list: 链表指针
+ * @param val: 要插入的值
+ * @return: 成功返回 ret_ok，内存不足返回 ret_err
+ */
+ret_val ulist_push_to_tail(ulist *list, void *val);
+
+/**
+ * @brief: 从链表头部弹出值
+ * @param list: 链表指针
+ * @return: 返回头部的值，链表为空返回 NULL
+ */
+void *ulist_pop_from_head(ulist *list);
+
+/**
+ * @brief: 从链表尾部弹出值
+ * @param list: 链表指针
+ * @return: 返回尾部的值，链表为空返回 NULL
+ */
+void *ulist_pop_from_tail(ulist *list);
+
+/**
+ * @brief: 从索引获取值，按块跳过不包含该索引的部分
+ * @param list: 链表指针
+ * @param idx: 要获取的值的索引
+ * @return: 返回对应的值，如果索引无效返回 NULL
+ */
+void *ulist_get_val_from_index(ulist *list, uint32_t idx);
+
+/**
+ * @brief: 获取链表长度
+ * @param list: 链表指针
+ * @return: 返回链表中值的总数
+ */
+uint32_t ulist_get_length(ulist *list);
+
+#endif // !__UNROLLED_LIST_H_
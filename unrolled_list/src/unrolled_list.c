@@ -0,0 +1,215 @@
+/**
+ * @file unrolled_list.c
+ * @brief 展开链表实现文件，值连续存放在缓存行对齐的块中。
+ * @author moecly
+ */
+
+#include "../inc/unrolled_list.h"
+#include <string.h>
+
+/**
+ * @brief 申请一个按缓存行对齐的空块。
+ * @return 返回块指针，失败返回 NULL。
+ */
+static ulist_chunk *ulist_chunk_new(void) {
+  ulist_chunk *chunk;
+
+  chunk = (ulist_chunk *)mem_aligned_alloc(NULL, ULIST_CACHE_LINE,
+                                           sizeof(ulist_chunk));
+  if (!chunk)
+    return NULL;
+
+  chunk->prev = NULL;
+  chunk->next = NULL;
+  chunk->count = 0;
+  return chunk;
+}
+
+/**
+ * @brief 将空块从链表中摘除并释放。
+ * @param list 链表指针。
+ * @param chunk 要释放的块。
+ */
+static void ulist_chunk_release(ulist *list, ulist_chunk *chunk) {
+  if (chunk->prev)
+    chunk->prev->next = chunk->next;
+  else
+    list->head = chunk->next;
+
+  if (chunk->next)
+    chunk->next->prev = chunk->prev;
+  else
+    list->tail = chunk->prev;
+
+  mem_free(NULL, chunk);
+}
+
+/**
+ * @brief 创建一个新的展开链表。
+ * @return 返回一个指向新链表的指针，失败返回 NULL。
+ */
+ulist *ulist_new(void) {
+  ulist *list = MALLOC_FUNC(ulist);
+  if (!list)
+    return NULL;
+
+  list->head = NULL;
+  list->tail = NULL;
+  list->len = 0;
+  return list;
+}
+
+/**
+ * @brief 释放展开链表及其全部块。
+ * @param list 链表指针。
+ */
+void ulist_free(ulist *list) {
+  ulist_chunk *chunk = list->head;
+  ulist_chunk *tmp;
+
+  while (chunk) {
+    tmp = chunk->next;
+    mem_free(NULL, chunk);
+    chunk = tmp;
+  }
+  FREE_FUNC(list);
+}
+
+/**
+ * @brief 在链表头部插入值。
+ * @param list 链表指针。
+ * @param val 要插入的值。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err。
+ */
+ret_val ulist_push_to_head(ulist *list, void *val) {
+  ulist_chunk *chunk = list->head;
+
+  /* 头块已满时在前面新建一个块 */
+  if (!chunk || chunk->count == ULIST_CHUNK_VALS) {
+    chunk = ulist_chunk_new();
+    if (!chunk)
+      return ret_err;
+
+    chunk->next = list->head;
+    if (list->head)
+      list->head->prev = chunk;
+    else
+      list->tail = chunk;
+    list->head = chunk;
+  }
+
+  memmove(&chunk->vals[1], &chunk->vals[0], chunk->count * sizeof(void *));
+  chunk->vals[0] = val;
+  chunk->count++;
+  list->len++;
+  return ret_ok;
+}
+
+/**
+ * @brief 在链表尾部插入值。
+ * @param list 链表指针。
+ * @param val 要插入的值。
+ * @return 成功返回 ret_ok，内存不足返回 ret_err。
+ */
+ret_val ulist_push_to_tail(ulist *list, void *val) {
+  ulist_chunk *chunk = list->tail;
+
+  /* 尾块已满时在后面新建一个块 */
+  if (!chunk || chunk->count == ULIST_CHUNK_VALS) {
+    chunk = ulist_chunk_new();
+    if (!chunk)
+      return ret_err;
+
+    chunk->prev = list->tail;
+    if (list->tail)
+      list->tail->next = chunk;
+    else
+      list->head = chunk;
+    list->tail = chunk;
+  }
+
+  chunk->vals[chunk->count++] = val;
+  list->len++;
+  return ret_ok;
+}
+
+/**
+ * @brief 从链表头部弹出值。
+ * @param list 链表指针。
+ * @return 返回头部的值，链表为空返回 NULL。
+ */
+void *ulist_pop_from_head(ulist *list) {
+  ulist_chunk *chunk = list->head;
+  void *val;
+
+  if (!chunk)
+    return NULL;
+
+  val = chunk->vals[0];
+  chunk->count--;
+  memmove(&chunk->vals[0], &chunk->vals[1], chunk->count * sizeof(void *));
+  list->len--;
+
+  if (!chunk->count)
+    ulist_chunk_release(list, chunk);
+  return val;
+}
+
+/**
+ * @brief 从链表尾部弹出值。
+ * @param list 链表指针。
+ * @return 返回尾部的值，链表为空返回 NULL。
+ */
+void *ulist_pop_from_tail(ulist *list) {
+  ulist_chunk *chunk = list->tail;
+  void *val;
+
+  if (!chunk)
+    return NULL;
+
+  val = chunk->vals[--chunk->count];
+  list->len--;
+
+  if (!chunk->count)
+    ulist_chunk_release(list, chunk);
+  return val;
+}
+
+/**
+ * @brief 从索引获取值，按块跳过不包含该索引的部分。
+ * @param list 链表指针。
+ * @param idx 要获取的值的索引。
+ * @return 返回对应的值，如果索引无效返回 NULL。
+ */
+void *ulist_get_val_from_index(ulist *list, uint32_t idx) {
+  ulist_chunk *chunk;
+  uint32_t remain;
+
+  if (idx >= list->len)
+    return NULL;
+
+  /* 索引位于前半段时从头部按块跳过，否则从尾部向前跳过 */
+  if (idx < list->len / 2) {
+    chunk = list->head;
+    while (idx >= chunk->count) {
+      idx -= chunk->count;
+      chunk = chunk->next;
+    }
+    return chunk->vals[idx];
+  }
+
+  remain = list->len - 1 - idx;
+  chunk = list->tail;
+  while (remain >= chunk->count) {
+    remain -= chunk->count;
+    chunk = chunk->prev;
+  }
+  return chunk->vals[chunk->count - 1 - remain];
+}
+
+/**
+ * @brief 获取链表长度。
+ * @param list 链表指针。
+ * @return 返回链表中值的总数。
+ */
+uint32_t ulist_get_length(ulist *list) { return list->len; }